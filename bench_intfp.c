@@ -0,0 +1,980 @@
+/**
+ * intfp Library Micro-Benchmark Tool
+ *
+ * Measures every encode/decode/corr/corr_n/EWMA/log mul/muldiv/div/root/pow/
+ * log add/slog/radix function, the '_array' batch conversions and 8-bit decode
+ * tables on each available instruction set, and the power-law tables and the
+ * multithreaded ('_mt') conversions on a 4K plane, and access to a columnar
+ * container, and prints the results as JSON so that runs of different
+ * library versions can be compared mechanically.
+ *
+ * Two numbers are reported per scalar function, both per call:
+ * - latency:    each input depends on the previous output (dependent chain)
+ * - throughput: independent inputs, results stored to an array
+ * The cost of the measuring loop itself (load, chain XOR, store) is measured
+ * with an identity function and subtracted.
+ *
+ * Timing uses the TSC: lfence-serialized rdtsc at the start, rdtscp + lfence
+ * at the end. TSC ticks equal core cycles only at the nominal frequency, so
+ * compare runs made on the same host with frequency scaling pinned. Each
+ * figure is the median of N repetitions after a warmup, with the process
+ * pinned to one CPU.
+ *
+ * With -p, hardware counters are read around every throughput pass via
+ * perf_event_open (Linux): IPC, instructions, branch misses and L1D read
+ * misses per element, to show why a conversion is slow rather than only how
+ * slow. -d selects the input distribution (uniform, log-normal, Zipf), since
+ * the special-case branches of the encoders are data dependent. The default
+ * pass of 1024 elements is short enough for the branch predictor to learn
+ * it over the repetitions; -n 65536 shows the cost of mispredictions, which
+ * is what the branch-free (_bf) variants avoid.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <sched.h>
+#include <time.h>
+#include <math.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// Type aliases used by intfp.h
+typedef uint8_t   u8;
+typedef uint16_t  u16;
+typedef uint32_t  u32;
+typedef uint64_t  u64;
+typedef int8_t    s8;
+typedef int16_t   s16;
+typedef int32_t   s32;
+typedef int64_t   s64;
+
+#include "intfp_mt.h"
+#include "intfp_col.h"
+#include "intfp_rans.h"
+#include "intfp_ts.h"
+#include "intfp_packed.h"
+#include "intfp_bfp.h"
+#include "intfp_res.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "tsc"
+static inline u64 bench_start(void) {
+    _mm_lfence();
+    u64 t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+static inline u64 bench_stop(void) {
+    unsigned int aux;
+    u64 t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+}
+#else
+#define BENCH_UNIT "ns"
+static inline u64 bench_start(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#define bench_stop bench_start
+#endif
+
+#define BENCH_MAX_N    65536
+#define BENCH_MAX_REPS 1001
+
+// Benchmark settings
+static int bench_n = 1024;  /* Elements per timed pass; fits in L1D */
+static int bench_reps = 31;
+static int bench_warmup = 3;
+static int bench_threads = 0;  /* Threads of the _mt benchmarks; 0 for all CPUs */
+static const char *bench_filter = NULL;
+static FILE *bench_out;
+static bool perf_on = false;
+
+// Input distributions
+enum bench_dist {
+    DIST_BITLEN,     /* Uniformly distributed bit length */
+    DIST_UNIFORM,    /* Uniform over the whole range */
+    DIST_LOGNORMAL,  /* Log-normal, median at half the bit width */
+    DIST_ZIPF,       /* Zipf-like (s = 1.2): mostly tiny values, heavy tail */
+    DIST_COUNT
+};
+static const char *const dist_names[DIST_COUNT] = {
+    "bitlen", "uniform", "lognormal", "zipf"
+};
+static enum bench_dist bench_dist = DIST_BITLEN;
+
+// Shared buffers: sources of every element width, and the output sink
+static u64 src_u64[BENCH_MAX_N];
+static u32 src_u32[BENCH_MAX_N];
+static u16 src_u16[BENCH_MAX_N];
+static u8  src_u8[BENCH_MAX_N];
+static u64 src_enc[BENCH_MAX_N];   /* Encoded values for decode benchmarks */
+static u64 dst_any[BENCH_MAX_N];
+static u64 bench_sink;
+
+// Loop overhead measured with the identity function
+static double overhead_lat, overhead_tput;
+static int results_emitted;
+
+// Print usage information
+void print_usage(const char *prog_name) {
+    printf("Usage: %s [options]\n", prog_name);
+    printf("Options:\n");
+    printf("  -c, --cpu N         Pin to CPU N (default: 0, -1 to disable)\n");
+    printf("  -r, --reps N        Repetitions per measurement (median, default %d)\n", bench_reps);
+    printf("  -w, --warmup N      Warmup repetitions (default %d)\n", bench_warmup);
+    printf("  -f, --filter STR    Only run benchmarks whose name contains STR\n");
+    printf("  -o, --output FILE   Write JSON to FILE instead of stdout\n");
+    printf("  -n, --elements N    Elements per timed pass, a power of two (default %d,\n"
+           "                      max %d); use large passes to defeat branch history\n",
+           bench_n, BENCH_MAX_N);
+    printf("  -d, --dist NAME     Input distribution: bitlen (default), uniform,\n");
+    printf("                      lognormal, zipf, or all\n");
+    printf("  -p, --perf          Also report hardware counters (perf_event_open)\n");
+    printf("  -t, --threads N     Threads of the _mt benchmarks (default: all CPUs)\n");
+    printf("  -h, --help          Show this help message\n");
+}
+
+// Small deterministic PRNG (xorshift64*)
+static u64 bench_rng_state = 0x9E3779B97F4A7C15ULL;
+static u64 bench_rand64(void) {
+    bench_rng_state ^= bench_rng_state >> 12;
+    bench_rng_state ^= bench_rng_state << 25;
+    bench_rng_state ^= bench_rng_state >> 27;
+    return bench_rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+// Uniform double in (0, 1]
+static double bench_rand_unit(void) {
+    return ((bench_rand64() >> 11) + 1) * 0x1.0p-53;
+}
+
+// Draws one value of the given bit width from the current distribution
+static u64 dist_sample(int bits) {
+    u64 max = (bits == 64) ? ~0ULL : (1ULL << bits) - 1;
+    double v;
+
+    switch (bench_dist) {
+        case DIST_UNIFORM:
+            return bench_rand64() & max;
+        case DIST_LOGNORMAL:
+            /* Box-Muller; median 2^(bits/2), sigma of bits/6 octaves */
+            v = sqrt(-2.0 * log(bench_rand_unit())) * cos(2.0 * M_PI * bench_rand_unit());
+            v = bits / 2.0 + v * bits / 6.0;
+            return (v >= bits) ? max : (u64)exp2(v);
+        case DIST_ZIPF:
+            /* Inverse transform of the continuous Pareto tail, rank - 1 */
+            v = pow(bench_rand_unit(), -1.0 / 0.2) - 1.0;
+            return (v >= (double)max) ? max : (u64)v;
+        default:
+            return (bench_rand64() & max) >> (bench_rand64() % bits);
+    }
+}
+
+// Fills the source buffers from the current distribution
+static void fill_sources(void) {
+    bench_rng_state = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < bench_n; i++) {
+        src_u64[i] = dist_sample(64);
+        src_u32[i] = (u32)dist_sample(32);
+        src_u16[i] = (u16)dist_sample(16);
+        src_u8[i]  = (u8)dist_sample(8);
+    }
+}
+
+/*
+ * Hardware counters, opened as one group so that all four cover exactly the
+ * same instructions. User space only, as the functions never enter the kernel.
+ */
+enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_NR
+};
+
+struct perf_sample {
+    u64 v[PERF_NR];
+};
+
+#ifdef __linux__
+static int perf_fd[PERF_NR] = { -1, -1, -1, -1 };
+
+static int perf_open(u32 type, u64 config, int group_fd) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (group_fd < 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static bool perf_init(void) {
+    static const struct { u32 type; u64 config; } events[PERF_NR] = {
+        [PERF_CYCLES]        = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        [PERF_INSTRUCTIONS]  = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        [PERF_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        [PERF_L1D_MISSES]    = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                 (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    };
+
+    for (int i = 0; i < PERF_NR; i++) {
+        perf_fd[i] = perf_open(events[i].type, events[i].config, i ? perf_fd[0] : -1);
+        if (perf_fd[i] < 0) {
+            perror("perf_event_open");
+            while (i-- > 0) close(perf_fd[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline void perf_begin(void) {
+    if (!perf_on) return;
+    ioctl(perf_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(perf_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+// Stops the counters and adds them to `acc` (if not NULL)
+static inline void perf_end(struct perf_sample *acc) {
+    u64 buf[1 + PERF_NR];
+
+    if (!perf_on) return;
+    ioctl(perf_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    if (read(perf_fd[0], buf, sizeof(buf)) != (ssize_t)sizeof(buf) || !acc) return;
+    for (int i = 0; i < PERF_NR; i++)
+        acc->v[i] += buf[1 + i];
+}
+#else
+static bool perf_init(void) {
+    fprintf(stderr, "hardware counters are only supported on Linux\n");
+    return false;
+}
+static inline void perf_begin(void) {}
+static inline void perf_end(struct perf_sample *acc) { (void)acc; }
+#endif
+
+static int cmp_u64(const void *a, const void *b) {
+    u64 x = *(const u64 *)a, y = *(const u64 *)b;
+    return (x > y) - (x < y);
+}
+
+static double median_u64(u64 *v, int n) {
+    qsort(v, n, sizeof(*v), cmp_u64);
+    return (n & 1) ? (double)v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2.0;
+}
+
+static bool bench_selected(const char *name) {
+    return !bench_filter || strstr(name, bench_filter);
+}
+
+/* `pc` holds counters summed over all measured passes, or NULL. */
+static void emit_result(const char *name, const char *kind, double lat, double tput,
+                        const struct perf_sample *pc) {
+    fprintf(bench_out, "%s\n    {\"name\": \"%s\", \"kind\": \"%s\", \"dist\": \"%s\", ",
+            results_emitted++ ? "," : "", name, kind, dist_names[bench_dist]);
+    if (lat >= 0)
+        fprintf(bench_out, "\"latency\": %.2f, ", lat);
+    fprintf(bench_out, "\"throughput\": %.2f", tput);
+    if (perf_on && pc) {
+        double elems = (double)bench_reps * bench_n;
+        const u64 *v = pc->v;
+        fprintf(bench_out, ", \"ipc\": %.2f, \"instructions\": %.2f, "
+                "\"branch_misses\": %.4f, \"l1d_misses\": %.4f",
+                v[PERF_CYCLES] ? (double)v[PERF_INSTRUCTIONS] / v[PERF_CYCLES] : 0.0,
+                v[PERF_INSTRUCTIONS] / elems, v[PERF_BRANCH_MISSES] / elems,
+                v[PERF_L1D_MISSES] / elems);
+    }
+    fputc('}', bench_out);
+}
+
+/*
+ * Measures one scalar function. `expr` computes the result from `x` (the
+ * current input, of type in_t) and may also read `y` (the previous result in
+ * the latency loop, an unrelated input in the throughput loop), which is what
+ * the EWMA benchmarks use for their running average. Counters (-p) cover
+ * the throughput loop and include the loop's own instructions.
+ */
+#define BENCH_SCALAR(name, in_t, src, expr) do { \
+    if (!bench_selected(name)) break; \
+    const in_t *in_ = (const in_t *)(src); \
+    u64 lat_[BENCH_MAX_REPS], tput_[BENCH_MAX_REPS]; \
+    struct perf_sample pc_ = { { 0 } }; \
+    for (int r_ = -bench_warmup; r_ < bench_reps; r_++) { \
+        u64 y = 1, t0_, t1_; \
+        /* Latency: the next input is flipped by the previous result */ \
+        t0_ = bench_start(); \
+        for (int i_ = 0; i_ < bench_n; i_++) { \
+            in_t x = in_[i_] ^ (in_t)(y & 1); \
+            y = (u64)(expr); \
+        } \
+        t1_ = bench_stop(); \
+        bench_sink ^= y; \
+        if (r_ >= 0) lat_[r_] = t1_ - t0_; \
+        /* Throughput: independent inputs */ \
+        perf_begin(); \
+        t0_ = bench_start(); \
+        for (int i_ = 0; i_ < bench_n; i_++) { \
+            in_t x = in_[i_]; \
+            u64 y __attribute__((unused)) = in_[(i_ + 1) & (bench_n - 1)]; \
+            dst_any[i_] = (u64)(expr); \
+        } \
+        t1_ = bench_stop(); \
+        perf_end(r_ >= 0 ? &pc_ : NULL); \
+        bench_sink ^= dst_any[bench_rand64() % bench_n]; \
+        if (r_ >= 0) tput_[r_] = t1_ - t0_; \
+    } \
+    double lat = median_u64(lat_, bench_reps) / bench_n - overhead_lat; \
+    double tput = median_u64(tput_, bench_reps) / bench_n - overhead_tput; \
+    emit_result(name, "scalar", lat > 0 ? lat : 0, tput > 0 ? tput : 0, &pc_); \
+} while (0)
+
+/* Measures one '_array' call over n elements on every instruction set. */
+#define BENCH_ARRAY_N(name, call, n) do { \
+    enum intfp_isa max_ = intfp_isa_get(); \
+    for (int isa_ = INTFP_ISA_SCALAR; isa_ <= (int)max_; isa_++) { \
+        char label_[128]; \
+        intfp_isa_set((enum intfp_isa)isa_); \
+        snprintf(label_, sizeof(label_), "%s[%s]", name, isa_name(intfp_isa_get())); \
+        if (!bench_selected(label_)) continue; \
+        u64 t_[BENCH_MAX_REPS]; \
+        struct perf_sample pc_ = { { 0 } }; \
+        for (int r_ = -bench_warmup; r_ < bench_reps; r_++) { \
+            perf_begin(); \
+            u64 t0_ = bench_start(); \
+            call; \
+            u64 t1_ = bench_stop(); \
+            perf_end(r_ >= 0 ? &pc_ : NULL); \
+            if (r_ >= 0) t_[r_] = t1_ - t0_; \
+        } \
+        bench_sink ^= dst_any[bench_rand64() % bench_n]; \
+        emit_result(label_, "array", -1, median_u64(t_, bench_reps) / (double)(n), &pc_); \
+    } \
+    intfp_isa_set(max_); \
+} while (0)
+#define BENCH_ARRAY(name, call) BENCH_ARRAY_N(name, call, bench_n)
+
+static const char *isa_name(enum intfp_isa isa) {
+    switch (isa) {
+        case INTFP_ISA_AVX512_VBMI: return "avx512vbmi";
+        case INTFP_ISA_AVX512:      return "avx512";
+        case INTFP_ISA_AVX2:        return "avx2";
+        default:                    return "scalar";
+    }
+}
+
+// Measures the cost of the benchmark loops themselves (identity function)
+static void measure_overhead(void) {
+    u64 lat_[BENCH_MAX_REPS], tput_[BENCH_MAX_REPS];
+    for (int r = -bench_warmup; r < bench_reps; r++) {
+        u64 y = 1, t0, t1;
+        t0 = bench_start();
+        for (int i = 0; i < bench_n; i++) {
+            u64 x = src_u64[i] ^ (y & 1);
+            __asm__ volatile("" : "+r"(x));
+            y = x;
+        }
+        t1 = bench_stop();
+        bench_sink ^= y;
+        if (r >= 0) lat_[r] = t1 - t0;
+        t0 = bench_start();
+        for (int i = 0; i < bench_n; i++) {
+            u64 x = src_u64[i];
+            __asm__ volatile("" : "+r"(x));
+            dst_any[i] = x;
+        }
+        t1 = bench_stop();
+        if (r >= 0) tput_[r] = t1 - t0;
+    }
+    overhead_lat = median_u64(lat_, bench_reps) / bench_n;
+    overhead_tput = median_u64(tput_, bench_reps) / bench_n;
+}
+
+/*
+ * Benchmarks every conversion of one width pair: pul, log, _corr and the
+ * _corr_n levels 2 and 3, in both directions, plus the batch and branch-free
+ * (_bf) variants. The decoders are also run on raw random codes ("(raw)").
+ */
+#define BENCH_HBITS_LBITS(hbits, lbits) do { \
+    const u##hbits *h_ = src_u##hbits; \
+    u8 lfp_ = intfp_log_fpmax(hbits, lbits); \
+    BENCH_SCALAR("u" #hbits "_to_pul" #lbits "fpmax", u##hbits, h_, \
+        u##hbits##_to_pul##lbits##fpmax(x)); \
+    BENCH_SCALAR("u" #hbits "_to_pul" #lbits "fpmax_bf", u##hbits, h_, \
+        u##hbits##_to_pul##lbits##fpmax_bf(x)); \
+    for (int i = 0; i < bench_n; i++) \
+        ((u##lbits *)src_enc)[i] = u##hbits##_to_pul##lbits##fpmax(h_[i]); \
+    BENCH_SCALAR("pul" #lbits "fpmax_to_u" #hbits, u##lbits, src_enc, \
+        pul##lbits##fpmax_to_u##hbits(x)); \
+    BENCH_SCALAR("pul" #lbits "fpmax_to_u" #hbits "_bf", u##lbits, src_enc, \
+        pul##lbits##fpmax_to_u##hbits##_bf(x)); \
+    BENCH_ARRAY("u" #hbits "_to_pul" #lbits "fpmax_array", \
+        u##hbits##_to_pul##lbits##fpmax_array((u##lbits *)dst_any, h_, bench_n)); \
+    BENCH_ARRAY("pul" #lbits "fpmax_to_u" #hbits "_array", \
+        pul##lbits##fpmax_to_u##hbits##_array((u##hbits *)dst_any, \
+            (const u##lbits *)src_enc, bench_n)); \
+    BENCH_SCALAR("u" #hbits "_to_log" #lbits "fpmax", u##hbits, h_, \
+        u##hbits##_to_log##lbits##fpmax(x)); \
+    BENCH_SCALAR("u" #hbits "_to_log" #lbits "fpmax_bf", u##hbits, h_, \
+        u##hbits##_to_log##lbits##fpmax_bf(x)); \
+    BENCH_SCALAR("u" #hbits "_to_log" #lbits "fpmax_corr", u##hbits, h_, \
+        u##hbits##_to_log##lbits##fpmax_corr(x)); \
+    BENCH_SCALAR("u" #hbits "_to_log" #lbits "fp_corr_n(2)", u##hbits, h_, \
+        u##hbits##_to_log##lbits##fp_corr_n(x, lfp_, 2)); \
+    BENCH_SCALAR("u" #hbits "_to_log" #lbits "fp_corr_n(3)", u##hbits, h_, \
+        u##hbits##_to_log##lbits##fp_corr_n(x, lfp_, 3)); \
+    BENCH_ARRAY("u" #hbits "_to_log" #lbits "fpmax_corr_array", \
+        u##hbits##_to_log##lbits##fpmax_corr_array((s##lbits *)dst_any, h_, bench_n)); \
+    for (int i = 0; i < bench_n; i++) \
+        ((s##lbits *)src_enc)[i] = u##hbits##_to_log##lbits##fpmax_corr(h_[i]); \
+    BENCH_SCALAR("log" #lbits "fpmax_to_u" #hbits, s##lbits, src_enc, \
+        log##lbits##fpmax_to_u##hbits(x)); \
+    BENCH_SCALAR("log" #lbits "fpmax_to_u" #hbits "_bf", s##lbits, src_enc, \
+        log##lbits##fpmax_to_u##hbits##_bf(x)); \
+    BENCH_SCALAR("log" #lbits "fpmax_to_u" #hbits "_corr", s##lbits, src_enc, \
+        log##lbits##fpmax_to_u##hbits##_corr(x)); \
+    BENCH_SCALAR("log" #lbits "fp_to_u" #hbits "_corr_n(2)", s##lbits, src_enc, \
+        log##lbits##fp_to_u##hbits##_corr_n(x, lfp_, 2)); \
+    BENCH_SCALAR("log" #lbits "fp_to_u" #hbits "_corr_n(3)", s##lbits, src_enc, \
+        log##lbits##fp_to_u##hbits##_corr_n(x, lfp_, 3)); \
+    BENCH_ARRAY("log" #lbits "fpmax_to_u" #hbits "_corr_array", \
+        log##lbits##fpmax_to_u##hbits##_corr_array((u##hbits *)dst_any, \
+            (const s##lbits *)src_enc, bench_n)); \
+    /* Raw random codes: zero, underflow and saturation are unpredictable */ \
+    for (int i = 0; i < bench_n; i++) \
+        ((u##lbits *)src_enc)[i] = (u##lbits)bench_rand64(); \
+    BENCH_SCALAR("pul" #lbits "fpmax_to_u" #hbits "(raw)", u##lbits, src_enc, \
+        pul##lbits##fpmax_to_u##hbits(x)); \
+    BENCH_SCALAR("pul" #lbits "fpmax_to_u" #hbits "_bf(raw)", u##lbits, src_enc, \
+        pul##lbits##fpmax_to_u##hbits##_bf(x)); \
+    BENCH_SCALAR("log" #lbits "fp_to_u" #hbits "fp(raw)", s##lbits, src_enc, \
+        log##lbits##fp_to_u##hbits##fp(x, lfp_, hbits / 2)); \
+    BENCH_SCALAR("log" #lbits "fp_to_u" #hbits "fp_bf(raw)", s##lbits, src_enc, \
+        log##lbits##fp_to_u##hbits##fp_bf(x, lfp_, hbits / 2)); \
+} while (0)
+
+// Benchmarks the table-driven 8-bit decoders against the computed ones
+#define BENCH_LUT8(hbits) do { \
+    static struct u##hbits##_lut8 lut_; \
+    pul8fp_to_u##hbits##_lut8_init(&lut_, INTFP_PUL_FPMAX(hbits, 8)); \
+    for (int i = 0; i < bench_n; i++) \
+        ((u8 *)src_enc)[i] = (u8)bench_rand64(); \
+    BENCH_ARRAY("pul8fpmax_to_u" #hbits "_array(raw)", \
+        pul8fpmax_to_u##hbits##_array((u##hbits *)dst_any, (const u8 *)src_enc, bench_n)); \
+    BENCH_ARRAY("pul8fp_to_u" #hbits "_lut8_array(raw)", \
+        pul8fp_to_u##hbits##_lut8_array((u##hbits *)dst_any, (const u8 *)src_enc, bench_n, &lut_)); \
+} while (0)
+
+// Benchmarks the EWMA functions of one width
+#define BENCH_EWMA(bits) do { \
+    BENCH_SCALAR("ewma_s" #bits "fp_div", s##bits, src_u##bits, \
+        ewma_s##bits##fp_div(x, (s##bits)y, 0, 7)); \
+    BENCH_SCALAR("ewma_s" #bits "fp_shr", s##bits, src_u##bits, \
+        ewma_s##bits##fp_shr(x, (s##bits)y, 0, 3)); \
+} while (0)
+
+// Benchmarks saturating log mul/div/pow of one width and the array forms
+#define BENCH_LOG_ARITH(bits) do { \
+    BENCH_SCALAR("log" #bits "_mul", s##bits, src_u##bits, \
+        log##bits##_mul(x, (s##bits)y)); \
+    BENCH_SCALAR("log" #bits "_div", s##bits, src_u##bits, \
+        log##bits##_div(x, (s##bits)y)); \
+    BENCH_SCALAR("log" #bits "_pow", s##bits, src_u##bits, \
+        log##bits##_pow(x, 3)); \
+    for (int i = 0; i < bench_n; i++) \
+        ((s##bits *)src_enc)[i] = (s##bits)bench_rand64(); \
+    BENCH_ARRAY("log" #bits "_mul_array", \
+        log##bits##_mul_array((s##bits *)dst_any, (const s##bits *)src_u##bits, \
+            (const s##bits *)src_enc, bench_n)); \
+} while (0)
+
+// Exact reference for muldiv, as mul_u64_u64_div_u64() on x86-64: mulq + divq
+static inline u64 exact_muldiv_u64(u64 a, u64 b, u64 c) {
+    return (u64)((unsigned __int128)a * b / c);
+}
+
+/*
+ * Benchmarks approximate a * b / c against the exact 128-bit version. The
+ * divisor is kept above the multiplier so that the exact quotient fits in
+ * 64 bits (divq faults otherwise), as for a delta scaled by a weight ratio.
+ * The top bit of the multiplier is set so that the latency chain cannot
+ * collapse to a zero multiplier (a predictable early-out). The array form
+ * runs on three random arrays.
+ */
+#define MULDIV_B64 ((y & 0xffffffff) | (1ULL << 31))
+#define MULDIV_B32 ((u32)(y & 0xffff) | (1u << 15))
+#define BENCH_MULDIV() do { \
+    BENCH_SCALAR("mul_u64_u64_div_u64(exact)", u64, src_u64, \
+        exact_muldiv_u64(x, MULDIV_B64, MULDIV_B64 | (1ULL << 32))); \
+    BENCH_SCALAR("u64_muldiv", u64, src_u64, \
+        u64_muldiv(x, MULDIV_B64, MULDIV_B64 | (1ULL << 32))); \
+    BENCH_SCALAR("u64_muldiv_corr", u64, src_u64, \
+        u64_muldiv_corr(x, MULDIV_B64, MULDIV_B64 | (1ULL << 32))); \
+    BENCH_SCALAR("u64_muldiv_corr_n(3)", u64, src_u64, \
+        u64_muldiv_corr_n(x, MULDIV_B64, MULDIV_B64 | (1ULL << 32), 3)); \
+    BENCH_SCALAR("u32_muldiv_corr_n(3)", u32, src_u32, \
+        u32_muldiv_corr_n(x, MULDIV_B32, MULDIV_B32 | (1u << 16), 3)); \
+    BENCH_ARRAY("u64_muldiv_corr_n_array(0)", \
+        u64_muldiv_corr_n_array((u64 *)dst_any, src_u64, src_u64 + 1, src_u64 + 2, \
+            bench_n - 2, 0)); \
+    BENCH_ARRAY("u64_muldiv_corr_n_array(1)", \
+        u64_muldiv_corr_n_array((u64 *)dst_any, src_u64, src_u64 + 1, src_u64 + 2, \
+            bench_n - 2, 1)); \
+} while (0)
+
+// Hardware division reference; the fixed divisor is read through a volatile
+// so that the compiler cannot turn the division into a multiplication
+static volatile u64 bench_divisor = 1991;
+static inline u64 hw_div_u64(u64 a, u64 b) { return a / b; }
+static inline u32 hw_div_u32(u32 a, u32 b) { return a / b; }
+
+/*
+ * Benchmarks exact division against the hardware divider: one-shot, and by
+ * a divisor prepared once, as for repeated division by one weight. The
+ * one-shot divisor varies with y; the prepared one is fixed.
+ */
+#define BENCH_DIV() do { \
+    u64 d_ = bench_divisor; \
+    struct u64_recip r64_ = u64_recip_init(d_); \
+    struct u32_recip r32_ = u32_recip_init((u32)d_); \
+    BENCH_SCALAR("div_u64(hardware)", u64, src_u64, hw_div_u64(x, y | 1)); \
+    BENCH_SCALAR("u64_div_exact", u64, src_u64, u64_div_exact(x, y | 1)); \
+    BENCH_SCALAR("u64_recip_init", u64, src_u64, u64_recip_init(x).m); \
+    BENCH_SCALAR("div_u64(hardware, fixed divisor)", u64, src_u64, hw_div_u64(x, d_)); \
+    BENCH_SCALAR("u64_div_recip", u64, src_u64, u64_div_recip(x, &r64_)); \
+    BENCH_SCALAR("div_u32(hardware)", u32, src_u32, hw_div_u32(x, (u32)y | 1)); \
+    BENCH_SCALAR("u32_div_exact", u32, src_u32, u32_div_exact(x, (u32)y | 1)); \
+    BENCH_SCALAR("div_u32(hardware, fixed divisor)", u32, src_u32, hw_div_u32(x, (u32)d_)); \
+    BENCH_SCALAR("u32_div_recip", u32, src_u32, u32_div_recip(x, &r32_)); \
+    BENCH_ARRAY("u64_div_recip_array", \
+        u64_div_recip_array((u64 *)dst_any, src_u64, bench_n, &r64_)); \
+} while (0)
+
+// Bit-by-bit square root, as in the kernel's int_sqrt()
+static inline u64 bitwise_isqrt_u64(u64 v) {
+    u64 r = 0, b = 1ULL << 62;
+    while (b > v) b >>= 2;
+    for (; b; b >>= 2) {
+        if (v >= r + b) { v -= r + b; r = (r >> 1) + b; }
+        else r >>= 1;
+    }
+    return r;
+}
+
+// Bit-by-bit cube root, as in TCP CUBIC's cubic_root() fallback
+static inline u64 bitwise_icbrt_u64(u64 v) {
+    u64 y = 0;
+    for (int s = 63; s >= 0; s -= 3) {
+        y <<= 1;
+        u64 b = 3 * y * (y + 1) + 1;
+        if ((v >> s) >= b) { v -= b << s; y++; }
+    }
+    return y;
+}
+
+// Benchmarks the integer roots against bit-by-bit loops
+#define BENCH_ROOT() do { \
+    BENCH_SCALAR("isqrt_u64(bitwise)", u64, src_u64, bitwise_isqrt_u64(x)); \
+    BENCH_SCALAR("u64_isqrt", u64, src_u64, u64_isqrt(x)); \
+    BENCH_SCALAR("u64_isqrt_approx", u64, src_u64, u64_isqrt_approx(x)); \
+    BENCH_SCALAR("u32_isqrt", u32, src_u32, u32_isqrt(x)); \
+    BENCH_SCALAR("icbrt_u64(bitwise)", u64, src_u64, bitwise_icbrt_u64(x)); \
+    BENCH_SCALAR("u64_icbrt", u64, src_u64, u64_icbrt(x)); \
+    BENCH_SCALAR("u64_icbrt_approx", u64, src_u64, u64_icbrt_approx(x)); \
+    BENCH_SCALAR("u32_icbrt", u32, src_u32, u32_icbrt(x)); \
+} while (0)
+
+// libm reference for the fixed-point power: Q16 in, Q16 out
+static inline u32 libm_pow_q16(u32 v, double e) {
+    return (u32)(pow(v / 65536.0, e) * 65536.0);
+}
+
+// Benchmarks fractional powers (gamma 1/2.2 on Q16) against libm pow()
+#define BENCH_POW() do { \
+    BENCH_SCALAR("pow(libm, Q16)", u32, src_u32, libm_pow_q16(x, 1 / 2.2)); \
+    BENCH_SCALAR("u32fp_pow_q(level 1)", u32, src_u32, u32fp_pow_q(x, 16, 29789, 16, 1)); \
+    BENCH_SCALAR("u32fp_pow_q(level 3)", u32, src_u32, u32fp_pow_q(x, 16, 29789, 16, 3)); \
+    BENCH_SCALAR("u64fp_rsqrt(level 3)", u64, src_u64, u64fp_rsqrt(x, 0, 40, 3)); \
+    BENCH_SCALAR("log32_pow_q", s32, src_u32, log32_pow_q(x, 29789, 16)); \
+} while (0)
+
+// Benchmarks the u8/u16 power-law tables on one 4K (3840x2160) plane
+#define BENCH_FRAME_N (3840 * 2160)
+#define BENCH_POW_LUT() do { \
+    static struct u8_pow_lut l8_; \
+    static struct u16_pow_lut l16_; \
+    u8 *f8_ = malloc(BENCH_FRAME_N * 2); \
+    u16 *f16_ = malloc(BENCH_FRAME_N * 4); \
+    if (!f8_ || !f16_) { free(f8_); free(f16_); break; } \
+    for (size_t i_ = 0; i_ < BENCH_FRAME_N; i_++) { \
+        f8_[i_] = (u8)bench_rand64(); \
+        f16_[i_] = (u16)bench_rand64(); \
+    } \
+    BENCH_SCALAR("pow(libm, u16)", u16, src_u16, (u16)(pow(x / 65535.0, 1 / 2.2) * 65535 + 0.5)); \
+    BENCH_SCALAR("u16_pow_norm", u16, src_u16, u16_pow_norm(x, 29789, 16)); \
+    u8_pow_lut_init(&l8_, 29789, 16); \
+    u16_pow_lut_init(&l16_, 29789, 16); \
+    BENCH_ARRAY_N("u8_pow_lut_array(4K)", \
+        u8_pow_lut_array(f8_ + BENCH_FRAME_N, f8_, BENCH_FRAME_N, &l8_), BENCH_FRAME_N); \
+    BENCH_ARRAY_N("u16_pow_lut_array(4K)", \
+        u16_pow_lut_array(f16_ + BENCH_FRAME_N, f16_, BENCH_FRAME_N, &l16_), BENCH_FRAME_N); \
+    free(f8_); \
+    free(f16_); \
+} while (0)
+
+/*
+ * Benchmarks the multithreaded conversions on a u64 4K plane, which does not
+ * fit in cache, against the single-threaded call. The workers are pinned to
+ * CPUs 1..N-1 next to the calling thread's -c CPU, and the buffers are
+ * placed by first touch.
+ */
+#define BENCH_MT() do { \
+    struct intfp_pool *pool_ = intfp_pool_create((unsigned)bench_threads, INTFP_POOL_PIN); \
+    u64 *in_ = pool_ ? intfp_pool_alloc(pool_, BENCH_FRAME_N, sizeof(u64)) : NULL; \
+    s32 *enc_ = pool_ ? intfp_pool_alloc(pool_, BENCH_FRAME_N, sizeof(s32)) : NULL; \
+    u64 *out_ = pool_ ? intfp_pool_alloc(pool_, BENCH_FRAME_N, sizeof(u64)) : NULL; \
+    char name_[64]; \
+    if (!in_ || !enc_ || !out_) { \
+        free(in_); free(enc_); free(out_); \
+        intfp_pool_destroy(pool_); \
+        break; \
+    } \
+    for (size_t i_ = 0; i_ < BENCH_FRAME_N; i_++) \
+        in_[i_] = src_u64[i_ & (bench_n - 1)]; \
+    BENCH_ARRAY_N("u64fp_to_log32fp_corr_n_array(4K)", \
+        u64fp_to_log32fp_corr_n_array(enc_, in_, BENCH_FRAME_N, 0, 26, 3), BENCH_FRAME_N); \
+    snprintf(name_, sizeof(name_), "u64fp_to_log32fp_corr_n_array_mt(4K,%u)", pool_->nthreads); \
+    BENCH_ARRAY_N(name_, u64fp_to_log32fp_corr_n_array_mt(pool_, enc_, in_, BENCH_FRAME_N, \
+        0, 26, 3), BENCH_FRAME_N); \
+    BENCH_ARRAY_N("log32fp_to_u64fp_corr_n_array(4K)", \
+        log32fp_to_u64fp_corr_n_array(out_, enc_, BENCH_FRAME_N, 26, 0, 3), BENCH_FRAME_N); \
+    snprintf(name_, sizeof(name_), "log32fp_to_u64fp_corr_n_array_mt(4K,%u)", pool_->nthreads); \
+    BENCH_ARRAY_N(name_, log32fp_to_u64fp_corr_n_array_mt(pool_, out_, enc_, BENCH_FRAME_N, \
+        26, 0, 3), BENCH_FRAME_N); \
+    free(in_); \
+    free(enc_); \
+    free(out_); \
+    intfp_pool_destroy(pool_); \
+} while (0)
+
+// Benchmarks random access and decoding of a u64 -> pul16 container (1K chunks)
+#define BENCH_COL() do { \
+    static u64 buf_[(BENCH_MAX_N * 2 + 4096) / 8]; \
+    struct intfp_col col_; \
+    if (intfp_col_create(&col_, buf_, sizeof(buf_), INTFP_COL_PUL, 64, 16, \
+            INTFP_PUL_FPMAX(64, 16), 0, bench_n, 10) != INTFP_COL_OK) \
+        break; \
+    intfp_col_encode(&col_, 0, src_u64, bench_n); \
+    BENCH_SCALAR("intfp_col_get(pul16)", u64, src_u64, \
+        intfp_col_get(&col_, x & (bench_n - 1))); \
+    BENCH_ARRAY("intfp_col_decode(pul16)", intfp_col_decode(&col_, dst_any, 0, bench_n)); \
+} while (0)
+
+/*
+ * Benchmarks entropy-coded 'pul' blocks of bench_n u64 values. The labels
+ * carry the block size in bytes per value (2 and 1 for plain 'pul16'/'pul8').
+ */
+#define BENCH_RANS(lbits) do { \
+    static u8 blk_[INTFP_RANS_BOUND(64, 16, BENCH_MAX_N)]; \
+    const u8 fp_ = INTFP_PUL_FPMAX(64, lbits); \
+    size_t size_ = u64_to_pul##lbits##fp_rans(blk_, sizeof(blk_), src_u64, bench_n, fp_); \
+    char name_[64]; \
+    snprintf(name_, sizeof(name_), "u64_to_pul" #lbits "fp_rans(%.3fB)", \
+             (double)size_ / bench_n); \
+    BENCH_ARRAY_N(name_, u64_to_pul##lbits##fp_rans(blk_, sizeof(blk_), src_u64, \
+        bench_n, fp_), bench_n); \
+    snprintf(name_, sizeof(name_), "pul" #lbits "fp_rans_to_u64(%.3fB)", \
+             (double)size_ / bench_n); \
+    BENCH_ARRAY_N(name_, pul##lbits##fp_rans_to_u64(dst_any, bench_n, blk_, size_), bench_n); \
+} while (0)
+
+/*
+ * Benchmarks the time-series codec on a slowly varying u64 series of
+ * bench_n values (log32 codes, 1K-value blocks): appending, and scanning
+ * the whole range back through the seek points.
+ */
+#define BENCH_TS() do { \
+    static u64 series_[BENCH_MAX_N]; \
+    static u8 buf_[INTFP_TS_BOUND(BENCH_MAX_N) + 64 * INTFP_TS_HEADER_SIZE]; \
+    static struct intfp_ts_point pts_[BENCH_MAX_N / INTFP_TS_BLOCK_LEN + 1]; \
+    struct intfp_ts_writer w_; \
+    for (int i_ = 0; i_ < bench_n; i_++) \
+        series_[i_] = (u64)(1e9 * (2.0 + sin(i_ * 1e-3))) + bench_rand64() % 64; \
+    BENCH_ARRAY("intfp_ts_append_u64(log32)", ( \
+        intfp_ts_writer_init(&w_, buf_, sizeof(buf_), INTFP_TS_LOG32, 0), \
+        intfp_ts_append_u64(&w_, series_, bench_n), intfp_ts_flush(&w_))); \
+    size_t npts_ = intfp_ts_index(buf_, w_.len, pts_, sizeof(pts_) / sizeof(pts_[0])); \
+    BENCH_ARRAY("intfp_ts_scan_u64(log32)", intfp_ts_scan_u64(dst_any, buf_, w_.len, \
+        pts_, npts_, 0, bench_n, INTFP_TS_LOG32)); \
+} while (0)
+
+/*
+ * Benchmarks packed arrays of `width`-bit 'pul' codes of u64 values: bulk
+ * encode and decode, bulk unpacking of the codes, and decoding one value
+ * at a time with intfp_packed_get().
+ */
+#define BENCH_PACKED(width) do { \
+    static u64 words_[INTFP_PACKED_WORDS(BENCH_MAX_N, width)]; \
+    struct intfp_packed a_; \
+    intfp_packed_init(&a_, words_, bench_n, INTFP_PACKED_PUL, 64, width, INTFP_PACKED_FPMAX); \
+    BENCH_ARRAY("intfp_packed_encode(u64, " #width ")", \
+        intfp_packed_encode(&a_, 0, src_u64, bench_n)); \
+    BENCH_ARRAY("intfp_packed_decode(u64, " #width ")", \
+        intfp_packed_decode(&a_, dst_any, 0, bench_n)); \
+    BENCH_ARRAY("intfp_packed_unpack(" #width ")", \
+        intfp_packed_unpack(&a_, dst_any, 0, bench_n)); \
+    BENCH_ARRAY("intfp_packed_get(u64, " #width ")", \
+        for (int i_ = 0; i_ < bench_n; i_++) dst_any[i_] = intfp_packed_get(&a_, i_)); \
+} while (0)
+
+/*
+ * Benchmarks block floating point on u64 values: encoding and decoding
+ * mbits-bit mantissas with one exponent per 32 values.
+ */
+#define BENCH_BFP(mbits) do { \
+    static u##mbits mans_[BENCH_MAX_N]; \
+    static u8 exps_[INTFP_BFP_EXPS(BENCH_MAX_N, 32)]; \
+    BENCH_ARRAY("u64_to_bfp" #mbits, u64_to_bfp##mbits(exps_, mans_, src_u64, bench_n, 32)); \
+    BENCH_ARRAY("bfp" #mbits "_to_u64", bfp##mbits##_to_u64(dst_any, exps_, mans_, bench_n, 32)); \
+} while (0)
+
+/*
+ * Benchmarks lossless 'pul16' of u64 values at fpmax: encoding the codes
+ * with their residual stream, and reconstructing the exact values.
+ */
+#define BENCH_RES() do { \
+    static u16 codes_[BENCH_MAX_N]; \
+    static u8 res_[INTFP_RES_BOUND(64, BENCH_MAX_N, 10)]; \
+    size_t size_ = 0; \
+    BENCH_ARRAY("u64_to_pul16fp_res", \
+        size_ = u64_to_pul16fp_res(codes_, res_, sizeof(res_), src_u64, bench_n, 10)); \
+    BENCH_ARRAY("pul16fp_res_to_u64", \
+        pul16fp_res_to_u64(dst_any, codes_, bench_n, res_, size_, 0, 10)); \
+} while (0)
+
+// Benchmarks log-domain addition and subtraction of one width
+#define BENCH_LOG_ADD(bits, fp) do { \
+    BENCH_SCALAR("log" #bits "fp_add", s##bits, src_u##bits, \
+        log##bits##fp_add(x, (s##bits)y, fp)); \
+    BENCH_SCALAR("log" #bits "fp_sub", s##bits, src_u##bits, \
+        log##bits##fp_sub(x, (s##bits)y, fp)); \
+} while (0)
+
+// Benchmarks signed 'log' conversions from s64 and the arithmetic of one width
+#define BENCH_SLOG(bits) do { \
+    BENCH_SCALAR("s64_to_slog" #bits "fpmax", s64, src_u64, \
+        s64_to_slog##bits##fpmax(x)); \
+    BENCH_SCALAR("slog" #bits "fpmax_to_s64", s##bits, src_u##bits, \
+        slog##bits##fpmax_to_s64(x)); \
+    BENCH_SCALAR("slog" #bits "_mul", s##bits, src_u##bits, \
+        slog##bits##_mul(x, (s##bits)y)); \
+    BENCH_SCALAR("slog" #bits "_div", s##bits, src_u##bits, \
+        slog##bits##_div(x, (s##bits)y)); \
+} while (0)
+
+// Benchmarks the radix rescaling functions of one width
+#define BENCH_RADIX(bits) do { \
+    BENCH_SCALAR("rescale_log" #bits "fp_to_radix", s##bits, src_u##bits, \
+        rescale_log##bits##fp_to_radix(x, U32FP_RADIX_TYPE_DB_POWER)); \
+    BENCH_SCALAR("rescale_log" #bits "fp_from_radix", s##bits, src_u##bits, \
+        rescale_log##bits##fp_from_radix(x, U32FP_RADIX_TYPE_DB_POWER)); \
+} while (0)
+
+static void pin_cpu(int cpu) {
+    cpu_set_t set;
+    if (cpu < 0) return;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        fprintf(stderr, "warning: could not pin to CPU %d\n", cpu);
+}
+
+// Runs every benchmark on the current source buffers
+static void run_benchmarks(void) {
+    BENCH_HBITS_LBITS( 8, 8);
+    BENCH_HBITS_LBITS(16, 8);
+    BENCH_HBITS_LBITS(32, 8);
+    BENCH_HBITS_LBITS(64, 8);
+    BENCH_HBITS_LBITS(16,16);
+    BENCH_HBITS_LBITS(32,16);
+    BENCH_HBITS_LBITS(64,16);
+    BENCH_HBITS_LBITS(32,32);
+    BENCH_HBITS_LBITS(64,32);
+    BENCH_HBITS_LBITS(64,64);
+
+    BENCH_LUT8(8);
+    BENCH_LUT8(16);
+    BENCH_LUT8(32);
+    BENCH_LUT8(64);
+
+    BENCH_EWMA(8);
+    BENCH_EWMA(16);
+    BENCH_EWMA(32);
+    BENCH_EWMA(64);
+
+    BENCH_LOG_ARITH(8);
+    BENCH_LOG_ARITH(16);
+    BENCH_LOG_ARITH(32);
+    BENCH_LOG_ARITH(64);
+
+    BENCH_MULDIV();
+    BENCH_DIV();
+    BENCH_ROOT();
+    BENCH_POW();
+    BENCH_POW_LUT();
+    BENCH_MT();
+    BENCH_COL();
+    BENCH_RANS(16);
+    BENCH_RANS(8);
+    BENCH_TS();
+    BENCH_PACKED(12);
+    BENCH_PACKED(20);
+    BENCH_BFP(8);
+    BENCH_BFP(16);
+    BENCH_RES();
+
+    BENCH_LOG_ADD(16, 10);
+    BENCH_LOG_ADD(32, 25);
+    BENCH_LOG_ADD(64, 57);
+
+    BENCH_SLOG(16);
+    BENCH_SLOG(32);
+
+    BENCH_RADIX(8);
+    BENCH_RADIX(16);
+    BENCH_RADIX(32);
+}
+
+int main(int argc, char *argv[]) {
+    int cpu = 0;
+    const char *output = NULL;
+    int dist_first = DIST_BITLEN, dist_last = DIST_BITLEN;
+
+    static struct option long_options[] = {
+        {"cpu", required_argument, NULL, 'c'},
+        {"reps", required_argument, NULL, 'r'},
+        {"warmup", required_argument, NULL, 'w'},
+        {"filter", required_argument, NULL, 'f'},
+        {"output", required_argument, NULL, 'o'},
+        {"elements", required_argument, NULL, 'n'},
+        {"dist", required_argument, NULL, 'd'},
+        {"perf", no_argument, NULL, 'p'},
+        {"threads", required_argument, NULL, 't'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "c:r:w:f:o:n:d:t:ph", long_options, NULL)) != -1) {
+        switch (c) {
+            case 'c':
+                cpu = atoi(optarg);
+                break;
+            case 'r':
+                bench_reps = atoi(optarg);
+                break;
+            case 'w':
+                bench_warmup = atoi(optarg);
+                break;
+            case 'f':
+                bench_filter = optarg;
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'n':
+                bench_n = atoi(optarg);
+                break;
+            case 'd':
+                if (strcmp(optarg, "all") == 0) {
+                    dist_first = DIST_UNIFORM;
+                    dist_last = DIST_COUNT - 1;
+                    break;
+                }
+                for (dist_first = 0; dist_first < DIST_COUNT; dist_first++)
+                    if (strcmp(optarg, dist_names[dist_first]) == 0)
+                        break;
+                if (dist_first == DIST_COUNT) {
+                    fprintf(stderr, "unknown distribution: %s\n", optarg);
+                    return 1;
+                }
+                dist_last = dist_first;
+                break;
+            case 'p':
+                perf_on = true;
+                break;
+            case 't':
+                bench_threads = atoi(optarg);
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (bench_reps < 1 || bench_reps > BENCH_MAX_REPS) {
+        fprintf(stderr, "reps must be between 1 and %d\n", BENCH_MAX_REPS);
+        return 1;
+    }
+    if (bench_n < 2 || bench_n > BENCH_MAX_N || (bench_n & (bench_n - 1))) {
+        fprintf(stderr, "elements must be a power of two between 2 and %d\n", BENCH_MAX_N);
+        return 1;
+    }
+
+    bench_out = output ? fopen(output, "w") : stdout;
+    if (!bench_out) {
+        perror(output);
+        return 1;
+    }
+
+    pin_cpu(cpu);
+    if (perf_on && !perf_init()) {
+        fprintf(stderr, "warning: hardware counters unavailable, continuing without\n");
+        perf_on = false;
+    }
+    bench_dist = DIST_BITLEN;
+    fill_sources();
+    measure_overhead();
+
+    fprintf(bench_out, "{\n  \"library\": \"intfp\",\n  \"version\": \"%s\",\n", INTFP_VERSION);
+    fprintf(bench_out, "  \"unit\": \"%s per element\",\n", BENCH_UNIT);
+    fprintf(bench_out, "  \"cpu\": %d,\n  \"isa\": \"%s\",\n", cpu, isa_name(intfp_isa_get()));
+    fprintf(bench_out, "  \"perf\": %s,\n", perf_on ? "true" : "false");
+    fprintf(bench_out, "  \"elements\": %d,\n  \"reps\": %d,\n  \"warmup\": %d,\n",
+            bench_n, bench_reps, bench_warmup);
+    fprintf(bench_out, "  \"overhead\": {\"latency\": %.2f, \"throughput\": %.2f},\n",
+            overhead_lat, overhead_tput);
+    fprintf(bench_out, "  \"results\": [");
+
+    for (int d = dist_first; d <= dist_last; d++) {
+        bench_dist = (enum bench_dist)d;
+        fill_sources();
+        run_benchmarks();
+    }
+
+    fprintf(bench_out, "\n  ],\n  \"sink\": %llu\n}\n", (unsigned long long)(bench_sink & 1));
+    if (bench_out != stdout) fclose(bench_out);
+
+    return 0;
+}
@@ -57,6 +57,8 @@
  *   u64 to pul16, log8 to log32), allowing fine-tuning for specific needs.
  * - **Practical Utilities:** Includes ready-to-use functions for Exponentially
  *   Weighted Moving Average (EWMA) and radix conversion (e.g., to decibels).
+ * - **Batch Conversion:** `_array` variants convert whole buffers, using AVX2
+ *   or AVX-512 kernels (intfp_simd.h) selected at run time on x86-64.
  *
  * @warning
  * The `log` format is a high-speed approximation. It represents a value `v` as
@@ -70,6 +72,129 @@
  * require providing equivalent implementations.
  */
 
+/** @brief Library version string, matching the header comment above. */
+#define INTFP_VERSION "1.5"
+
+/*
+ * Linkage
+ *
+ * Every function is defined `static inline` so that the header can be
+ * included from any number of translation units without duplicate symbols,
+ * and so that hot-path calls collapse into a few instructions at the call
+ * site without LTO. Define INTFP_API before including this header to choose
+ * another storage class (e.g. empty, for the external definitions of
+ * versions up to 1.5 in a single translation unit).
+ *
+ * The lookup tables are `static const` by default; the compiler drops them
+ * from translation units that do not use them. To keep a single copy per
+ * program instead, define INTFP_SHARED_TABLES in every translation unit and
+ * INTFP_IMPLEMENTATION in exactly one of them, which then holds the
+ * definitions.
+ */
+#ifndef INTFP_API
+#define INTFP_API static inline
+#endif
+
+#if !defined(INTFP_SHARED_TABLES)
+#define __INTFP_TABLE static const __attribute__((unused))
+#define __intfp_table_init(...) = __VA_ARGS__
+#elif defined(INTFP_IMPLEMENTATION)
+#define __INTFP_TABLE const
+#define __intfp_table_init(...) = __VA_ARGS__
+#else
+#define __INTFP_TABLE extern const
+#define __intfp_table_init(...)
+#endif
+
+/*
+ * Selective instantiation
+ *
+ * By default every width pair and function family is generated. To cut
+ * compile time, and object size when functions have external linkage, define
+ * INTFP_SELECT and name only what is needed:
+ *
+ *   INTFP_WITH_<h>_<l>       width pair of INTFP_DECL_HBITS_LBITS (e.g. 64_32)
+ *   INTFP_WITH_CONV_<i>_<o>  width pair of INTFP_DECL_IBITS_OBITS (e.g. 32_16)
+ *   INTFP_WITH_PUL           'pul' encode/decode
+ *   INTFP_WITH_LOG           'log' encode/decode, saturating 'log' mul/div/pow
+ *                            and pow_q/root/recip/rsqrt
+ *   INTFP_WITH_CORR          corrected 'log' (_corr)
+ *   INTFP_WITH_CORR_N        multi-level corrected 'log' (_corr_n), implies
+ *                            INTFP_WITH_LOG and INTFP_WITH_CORR
+ *   INTFP_WITH_LOG_ADD       log-domain addition/subtraction, implies
+ *                            INTFP_WITH_CORR
+ *   INTFP_WITH_SLOG          signed 'log' (slog), implies INTFP_WITH_LOG
+ *   INTFP_WITH_MULDIV        approximate a * b / c, implies INTFP_WITH_CORR_N;
+ *                            needs the pairs 16_16, 32_32 or 64_32
+ *   INTFP_WITH_DIV           exact division by a 'log'-seeded reciprocal,
+ *                            implies INTFP_WITH_CORR_N; needs the pairs
+ *                            32_32 or 64_32
+ *   INTFP_WITH_ROOT          exact and approximate isqrt/icbrt, implies
+ *                            INTFP_WITH_CORR_N; needs the pairs 32_32 or
+ *                            64_32
+ *   INTFP_WITH_POW           fixed-point pow/root/recip/rsqrt, implies
+ *                            INTFP_WITH_CORR_N; needs the pairs 16_16,
+ *                            32_32 or 64_32 (64_32 for the u8/u16
+ *                            power-law tables)
+ *   INTFP_WITH_EWMA          EWMA functions
+ *   INTFP_WITH_RADIX         radix rescaling
+ *
+ * Families apply to every selected pair; the fixed-point conversions of a
+ * selected pair are always generated. For example, u64 <-> log32 and
+ * u64 <-> pul16 only:
+ *
+ *   #define INTFP_SELECT
+ *   #define INTFP_WITH_64_32
+ *   #define INTFP_WITH_64_16
+ *   #define INTFP_WITH_PUL
+ *   #define INTFP_WITH_LOG
+ *   #include "intfp.h"
+ */
+#if defined(INTFP_SELECT) && (defined(INTFP_WITH_MULDIV) || defined(INTFP_WITH_DIV) || \
+	defined(INTFP_WITH_ROOT) || defined(INTFP_WITH_POW)) && !defined(INTFP_WITH_CORR_N)
+#define INTFP_WITH_CORR_N
+#endif
+#if defined(INTFP_SELECT) && defined(INTFP_WITH_CORR_N)
+#ifndef INTFP_WITH_LOG
+#define INTFP_WITH_LOG
+#endif
+#ifndef INTFP_WITH_CORR
+#define INTFP_WITH_CORR
+#endif
+#endif
+#if defined(INTFP_SELECT) && defined(INTFP_WITH_LOG_ADD) && !defined(INTFP_WITH_CORR)
+#define INTFP_WITH_CORR
+#endif
+#if defined(INTFP_SELECT) && defined(INTFP_WITH_SLOG) && !defined(INTFP_WITH_LOG)
+#define INTFP_WITH_LOG
+#endif
+
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_PUL)
+#define __intfp_if_pul(...) __VA_ARGS__
+#else
+#define __intfp_if_pul(...)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_LOG)
+#define __intfp_if_log(...) __VA_ARGS__
+#else
+#define __intfp_if_log(...)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CORR)
+#define __intfp_if_corr(...) __VA_ARGS__
+#else
+#define __intfp_if_corr(...)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CORR_N)
+#define __intfp_if_corr_n(...) __VA_ARGS__
+#else
+#define __intfp_if_corr_n(...)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_SLOG)
+#define __intfp_if_slog(...) __VA_ARGS__
+#else
+#define __intfp_if_slog(...)
+#endif
+
 /**
  * @brief Calculates the number of bits in a 32-bit value (Find Last Set).
  * @param v The 32-bit unsigned integer.
@@ -131,6 +256,12 @@
  */
 #define intfp_log_0(bits) intfp_signed_min(bits)
 
+/**
+ * @brief Defines the special representation for the value '0' in 'slog' format.
+ * The most negative number, as in 'log'; its sign bit (bit 0) is clear.
+ */
+#define intfp_slog_0(bits) intfp_signed_min(bits)
+
 /**
  * @brief Calculates the optimal number of exponent bits for a 'pul' conversion.
  *
@@ -141,7 +272,7 @@
  * @param pul_bits The bit-width of the destination 'pul' type (e.g., 32 for pul32).
  * @return The optimal number of exponent bits for the 'pul' format.
  */
-u8 intfp_pul_fpmax(u8 int_bits, u8 pul_bits) {
+INTFP_API u8 intfp_pul_fpmax(u8 int_bits, u8 pul_bits) {
 	return pul_bits - intfp_fls32(int_bits-1);
 }
 
@@ -156,10 +287,25 @@ u8 intfp_pul_fpmax(u8 int_bits, u8 pul_bits) {
  * @param pul_bits The bit-width of the destination 'log' type (e.g., 32 for log32).
  * @return The optimal number of exponent bits for the 'log' format.
  */
-u8 intfp_log_fpmax(u8 int_bits, u8 pul_bits) {
+INTFP_API u8 intfp_log_fpmax(u8 int_bits, u8 pul_bits) {
 	return pul_bits-1 - intfp_fls32(int_bits-1);
 }
 
+/* Constant-expression form of intfp_fls32(bits-1), for widths 8 to 64. */
+#define __intfp_exp_bits(bits) \
+	((bits) > 32 ? 6 : (bits) > 16 ? 5 : (bits) > 8 ? 4 : 3)
+
+/**
+ * @brief Constant-expression forms of intfp_pul_fpmax() and intfp_log_fpmax().
+ * Usable wherever the compiler requires a constant (array sizes, case labels,
+ * static initializers), and what the generated 'fpmax' functions use.
+ */
+#define INTFP_PUL_FPMAX(int_bits, pul_bits) ((pul_bits) - __intfp_exp_bits(int_bits))
+#define INTFP_LOG_FPMAX(int_bits, log_bits) ((log_bits)-1 - __intfp_exp_bits(int_bits))
+/* 'slog' gives one bit to the sign, so its magnitude has one bit less than 'log'. */
+#define INTFP_SLOG_FPMAX(int_bits, slog_bits) (INTFP_LOG_FPMAX(int_bits, slog_bits) - 1)
+
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CORR)
 /**
  * @brief Pre-computed correction tables for improved log-domain precision.
  *
@@ -172,7 +318,7 @@ u8 intfp_log_fpmax(u8 int_bits, u8 pul_bits) {
  * decode: c = 88/256 ≈ 0.3438,  lut[i] = round(88 * i * (256-i) / 256)
  * Max value: 5696 (encode) / 5632 (decode) at i=128, well within u16 range.
  */
-const u16 __intfp_enc_corr_lut[256] = {
+__INTFP_TABLE u16 __intfp_enc_corr_lut[256] __intfp_table_init({
 	    0,    89,   177,   264,   350,   436,   521,   606,   690,   773,   855,   937,  1018,  1098,  1178,  1257,
 	 1335,  1413,  1489,  1565,  1641,  1716,  1790,  1863,  1936,  2008,  2079,  2150,  2219,  2289,  2357,  2425,
 	 2492,  2558,  2624,  2689,  2753,  2817,  2880,  2942,  3004,  3065,  3125,  3184,  3243,  3301,  3358,  3415,
@@ -189,8 +335,8 @@ const u16 __intfp_enc_corr_lut[256] = {
 	 3471,  3415,  3358,  3301,  3243,  3184,  3125,  3065,  3004,  2942,  2880,  2817,  2753,  2689,  2624,  2558,
 	 2492,  2425,  2357,  2289,  2219,  2150,  2079,  2008,  1936,  1863,  1790,  1716,  1641,  1565,  1489,  1413,
 	 1335,  1257,  1178,  1098,  1018,   937,   855,   773,   690,   606,   521,   436,   350,   264,   177,    89,
-};
-const u16 __intfp_dec_corr_lut[256] = {
+});
+__INTFP_TABLE u16 __intfp_dec_corr_lut[256] __intfp_table_init({
 	    0,    88,   175,   261,   346,   431,   516,   599,   682,   764,   846,   926,  1006,  1086,  1165,  1243,
 	 1320,  1397,  1473,  1548,  1622,  1696,  1770,  1842,  1914,  1985,  2056,  2125,  2194,  2263,  2331,  2398,
 	 2464,  2530,  2595,  2659,  2722,  2785,  2848,  2909,  2970,  3030,  3090,  3148,  3206,  3264,  3321,  3377,
@@ -207,7 +353,7 @@ const u16 __intfp_dec_corr_lut[256] = {
 	 3432,  3377,  3321,  3264,  3206,  3148,  3090,  3030,  2970,  2909,  2848,  2785,  2722,  2659,  2595,  2530,
 	 2464,  2398,  2331,  2263,  2194,  2125,  2056,  1985,  1914,  1842,  1770,  1696,  1622,  1548,  1473,  1397,
 	 1320,  1243,  1165,  1086,  1006,   926,   846,   764,   682,   599,   516,   431,   346,   261,   175,    88,
-};
+});
 
 /**
  * @brief Exact pre-computed correction tables for higher-precision log conversion.
@@ -221,7 +367,7 @@ const u16 __intfp_dec_corr_lut[256] = {
  *
  * Used by _corr_n() with level >= 2.
  */
-const u16 __intfp_enc_corr_exact_lut[257] = {
+__INTFP_TABLE u16 __intfp_enc_corr_exact_lut[257] __intfp_table_init({
 	    0,  113,  224,  334,  442,  549,  654,  759,  861,  963, 1063, 1162, 1259, 1355, 1450, 1544,
 	 1636, 1727, 1817, 1905, 1992, 2078, 2163, 2246, 2329, 2410, 2490, 2568, 2646, 2722, 2797, 2871,
 	 2944, 3016, 3087, 3156, 3224, 3292, 3358, 3423, 3487, 3550, 3611, 3672, 3732, 3790, 3848, 3905,
@@ -239,8 +385,8 @@ const u16 __intfp_enc_corr_exact_lut[257] = {
 	 2090, 2031, 1971, 1911, 1851, 1790, 1729, 1667, 1605, 1542, 1480, 1416, 1353, 1289, 1224, 1159,
 	 1094, 1029,  963,  896,  830,  763,  695,  627,  559,  490,  421,  352,  282,  212,  142,   71,
 	    0,
-};
-const u16 __intfp_dec_corr_exact_lut[257] = {
+});
+__INTFP_TABLE u16 __intfp_dec_corr_exact_lut[257] __intfp_table_init({
 	    0,   78,  156,  233,  310,  387,  463,  538,  613,  687,  761,  835,  908,  980, 1052, 1124,
 	 1194, 1265, 1335, 1404, 1473, 1542, 1610, 1677, 1744, 1810, 1876, 1941, 2006, 2071, 2134, 2198,
 	 2260, 2323, 2384, 2446, 2506, 2566, 2626, 2685, 2744, 2802, 2859, 2916, 2972, 3028, 3083, 3138,
@@ -258,7 +404,8 @@ const u16 __intfp_dec_corr_exact_lut[257] = {
 	 2686, 2617, 2546, 2474, 2402, 2328, 2254, 2179, 2103, 2026, 1948, 1869, 1789, 1708, 1627, 1544,
 	 1461, 1377, 1291, 1205, 1118, 1030,  941,  851,  761,  669,  576,  482,  388,  292,  196,   98,
 	    0,
-};
+});
+#endif
 
 /**
  * @brief Linearly interpolate between adjacent LUT entries (Q0.16 result).
@@ -272,31 +419,80 @@ const u16 __intfp_dec_corr_exact_lut[257] = {
 	((u16)((lut)[idx] + ((s32)((lut)[(idx)+1] - (lut)[idx]) * (frac) >> (fbits))))
 
 /**
- * @brief Generates the core conversion functions between integer, fixed-point,
- * 'pul', and 'log' representations.
- * @param hbits The bit-width of the source/destination integer or fixed-point type.
- * @param lbits The bit-width of the destination/source 'pul' or 'log' type.
+ * @enum intfp_isa
+ * @brief Instruction sets available to the `_array` batch conversions.
  */
-#define INTFP_DECL_HBITS_LBITS(hbits, lbits) \
-/* --- Standard Integer <-> Fixed-Point Conversions --- */ \
+enum intfp_isa {
+	INTFP_ISA_SCALAR, /**< Portable scalar loop. */
+	INTFP_ISA_AVX2,   /**< x86 AVX2 (clz emulated through float exponents). */
+	INTFP_ISA_AVX512, /**< x86 AVX-512F/CD/BW (vplzcnt, in-register LUTs). */
+	INTFP_ISA_AVX512_VBMI, /**< AVX-512 plus VBMI (vpermi2b byte tables). */
+};
+
+/* Operations understood by the SIMD batch kernels. */
+enum __intfp_batch_op {
+	__INTFP_BATCH_TO_PUL,
+	__INTFP_BATCH_FROM_PUL,
+	__INTFP_BATCH_TO_LOG,
+	__INTFP_BATCH_FROM_LOG,
+};
+
+/*
+ * SIMD batch kernels are built on x86-64 user space with GCC/Clang, and
+ * selected at run time by cpuid. Define INTFP_NO_SIMD to force the scalar
+ * fallback everywhere.
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && \
+	!defined(__KERNEL__) && !defined(INTFP_NO_SIMD)
+#include "intfp_simd.h"
+#else
+INTFP_API enum intfp_isa intfp_isa_get(void) {
+	return INTFP_ISA_SCALAR;
+}
+INTFP_API enum intfp_isa intfp_isa_set(enum intfp_isa isa) {
+	(void)isa;
+	return INTFP_ISA_SCALAR;
+}
+/* No SIMD: batch conversions run entirely in their scalar tail loop */
+#define __intfp_simd_batch(hbits, lbits, op, dst, src, n, ifp, ofp, level) ((size_t)0)
+#define __intfp_simd_log_arith(bits, dst, a, b, n, div) ((size_t)0)
+#define __intfp_simd_lut8(dst, src, n, lut, bytes) ((size_t)0)
+#define __intfp_simd_lut16(dst, src, n, lut) ((size_t)0)
+#endif
+
+/*
+ * The generators below are split by function family, so that selective
+ * instantiation (INTFP_SELECT) can leave out whole families. Each takes the
+ * same (hbits, lbits) pair as INTFP_DECL_HBITS_LBITS.
+ *
+ * The '_array' variants convert `n` elements from `src` to `dst` and produce
+ * exactly the same values as calling the scalar function per element.
+ * On x86-64 the bulk is handled by AVX2 or AVX-512 kernels chosen at run time
+ * (see intfp_isa_get()); the remainder, and every element on other targets,
+ * goes through the scalar function. `src` and `dst` must not overlap.
+ */
+
+/* Integer <-> fixed-point conversions (always generated). */
+#define __INTFP_DECL_FIXED(hbits, lbits) \
 /** @brief Converts an integer to a fixed-point value by left-shifting. */ \
-u##hbits u##lbits##_to_u##hbits##fp(u##lbits v, u8 fp) { \
+INTFP_API u##hbits u##lbits##_to_u##hbits##fp(u##lbits v, u8 fp) { \
 	return (u##hbits)v << fp; \
 } \
 /** @brief Converts a fixed-point value back to an integer by right-shifting. */ \
-u##lbits u##hbits##fp_to_u##lbits(u##hbits v, u8 fp) { \
+INTFP_API u##lbits u##hbits##fp_to_u##lbits(u##hbits v, u8 fp) { \
 	return v >> fp; \
 } \
 /** @brief Converts a signed integer to a signed fixed-point value. */ \
-s##hbits s##lbits##_to_s##hbits##fp(s##lbits v, u8 fp) { \
+INTFP_API s##hbits s##lbits##_to_s##hbits##fp(s##lbits v, u8 fp) { \
 	return (s##hbits)v << fp; \
 } \
 /** @brief Converts a signed fixed-point value back to a signed integer. */ \
-s##lbits s##hbits##fp_to_s##lbits(s##hbits v, u8 fp) { \
+INTFP_API s##lbits s##hbits##fp_to_s##lbits(s##hbits v, u8 fp) { \
 	return v >> fp; \
-} \
-\
-/* --- Packed Unsigned Log ('pul') Representation --- */ \
+}
+
+/* 'pul' encode/decode, scalar and batch. */
+#define __INTFP_DECL_PUL(hbits, lbits) \
 /** \
  * The 'pul' format approximates an unsigned integer in a compact, logarithmic form. \
  * It is composed of an exponent and a mantissa: | exponent | mantissa | \
@@ -314,7 +510,7 @@ s##lbits s##hbits##fp_to_s##lbits(s##hbits v, u8 fp) { \
  *            The range is 1 to (lbits - 1 - fls(lbits)). \
  * @return The 'pul' representation of the value. \
  */ \
-u##lbits u##hbits##_to_pul##lbits##fp(u##hbits v, u8 ofp) { \
+INTFP_API u##lbits u##hbits##_to_pul##lbits##fp(u##hbits v, u8 ofp) { \
 	if (v <= 1) return !v; /* Special encoding: v=0 -> 1, v=1 -> 0 */ \
 	u8 clz = __intfp_clz(v, hbits); \
 	/* Keep implicit leading 1 in mantissa; addition carries it into exponent */ \
@@ -322,9 +518,9 @@ u##lbits u##hbits##_to_pul##lbits##fp(u##hbits v, u8 ofp) { \
 	return ((u##lbits)(hbits - 2 - clz) << ofp) + m; \
 } \
 /** @brief Converts to 'pul' using the maximum possible precision for the mantissa. */ \
-u##lbits u##hbits##_to_pul##lbits##fpmax(u##hbits v) { \
+INTFP_API u##lbits u##hbits##_to_pul##lbits##fpmax(u##hbits v) { \
 	return u##hbits##_to_pul##lbits##fp( \
-		v, intfp_pul_fpmax(hbits, lbits)); \
+		v, INTFP_PUL_FPMAX(hbits, lbits)); \
 } \
 \
 /** \
@@ -334,7 +530,7 @@ u##lbits u##hbits##_to_pul##lbits##fpmax(u##hbits v) { \
  *            The range is 1 to (hbits - 1 - fls(hbits)). \
  * @return The reconstructed unsigned integer. Returns max value on overflow. \
  */ \
-u##hbits pul##lbits##fp_to_u##hbits(u##lbits v, u8 ifp) { \
+INTFP_API u##hbits pul##lbits##fp_to_u##hbits(u##lbits v, u8 ifp) { \
 	if (v == intfp_pul_0(lbits)) return 0; /* pul value of 1 represents 0 */ \
 	u##lbits e = v >> ifp; /* Extract exponent */ \
 	if (e >= hbits) return intfp_unsigned_max(hbits); /* Avoid overflow */ \
@@ -345,12 +541,76 @@ u##hbits pul##lbits##fp_to_u##hbits(u##lbits v, u8 ifp) { \
 	return norm >> (hbits-1 - e); \
 } \
 /** @brief Converts from 'pul' using the maximum possible precision for the mantissa. */ \
-u##hbits pul##lbits##fpmax_to_u##hbits(u##hbits v) { \
+INTFP_API u##hbits pul##lbits##fpmax_to_u##hbits(u##hbits v) { \
 	return pul##lbits##fp_to_u##hbits( \
-		v, intfp_pul_fpmax(hbits, lbits)); \
+		v, INTFP_PUL_FPMAX(hbits, lbits)); \
 } \
 \
-/* --- Signed Logarithmic ('log') Representation --- */ \
+/** \
+ * @brief Branch-free variant of u##hbits##_to_pul##lbits##fp(). \
+ * Same results; the 0/1 special cases are selected with a mask instead of \
+ * an early return, for inputs where that branch would mispredict. \
+ */ \
+INTFP_API u##lbits u##hbits##_to_pul##lbits##fp_bf(u##hbits v, u8 ofp) { \
+	/* v|1 keeps clz defined; v=1 then carries to exactly 0 by itself */ \
+	u8 clz = __intfp_clz(v | 1, hbits); \
+	u##lbits m = (u##hbits)(v << clz) >> (hbits - 1 - ofp); \
+	u##lbits r = ((u##lbits)(hbits - 2 - clz) << ofp) + m; \
+	u##lbits zero = -(u##lbits)(v == 0); \
+	return (r & ~zero) | (zero & 1); \
+} \
+/** @brief Branch-free u##hbits##_to_pul##lbits##fpmax(). */ \
+INTFP_API u##lbits u##hbits##_to_pul##lbits##fpmax_bf(u##hbits v) { \
+	return u##hbits##_to_pul##lbits##fp_bf( \
+		v, INTFP_PUL_FPMAX(hbits, lbits)); \
+} \
+/** \
+ * @brief Branch-free variant of pul##lbits##fp_to_u##hbits(). \
+ * Same results; zero and saturation are applied as masks. \
+ */ \
+INTFP_API u##hbits pul##lbits##fp_to_u##hbits##_bf(u##lbits v, u8 ifp) { \
+	u##lbits e = v >> ifp; \
+	u##hbits m = v & intfp_bitmask(ifp - 1, lbits); \
+	u##hbits norm = (u##hbits)1 << (hbits-1) | (m << (hbits-1 - ifp)); \
+	/* The shift is wrapped into range; out-of-range results are masked off */ \
+	u##hbits r = norm >> ((hbits-1 - e) & (hbits-1)); \
+	u##hbits sat = -(u##hbits)(e >= hbits); \
+	u##hbits zero = -(u##hbits)(v == intfp_pul_0(lbits)); \
+	return (r | sat) & ~zero; \
+} \
+/** @brief Branch-free pul##lbits##fpmax_to_u##hbits(). */ \
+INTFP_API u##hbits pul##lbits##fpmax_to_u##hbits##_bf(u##lbits v) { \
+	return pul##lbits##fp_to_u##hbits##_bf( \
+		v, INTFP_PUL_FPMAX(hbits, lbits)); \
+} \
+\
+/** @brief Converts an array of unsigned integers to 'pul'. */ \
+INTFP_API void u##hbits##_to_pul##lbits##fp_array(u##lbits *dst, const u##hbits *src, \
+		size_t n, u8 ofp) { \
+	size_t i = __intfp_simd_batch(hbits, lbits, __INTFP_BATCH_TO_PUL, \
+		dst, src, n, 0, ofp, 0); \
+	for (; i < n; i++) dst[i] = u##hbits##_to_pul##lbits##fp(src[i], ofp); \
+} \
+/** @brief Converts an array to 'pul' using max precision. */ \
+INTFP_API void u##hbits##_to_pul##lbits##fpmax_array(u##lbits *dst, const u##hbits *src, \
+		size_t n) { \
+	u##hbits##_to_pul##lbits##fp_array(dst, src, n, INTFP_PUL_FPMAX(hbits, lbits)); \
+} \
+/** @brief Converts an array of 'pul' values back to unsigned integers. */ \
+INTFP_API void pul##lbits##fp_to_u##hbits##_array(u##hbits *dst, const u##lbits *src, \
+		size_t n, u8 ifp) { \
+	size_t i = __intfp_simd_batch(hbits, lbits, __INTFP_BATCH_FROM_PUL, \
+		dst, src, n, ifp, 0, 0); \
+	for (; i < n; i++) dst[i] = pul##lbits##fp_to_u##hbits(src[i], ifp); \
+} \
+/** @brief Converts an array from 'pul' using max precision. */ \
+INTFP_API void pul##lbits##fpmax_to_u##hbits##_array(u##hbits *dst, const u##lbits *src, \
+		size_t n) { \
+	pul##lbits##fp_to_u##hbits##_array(dst, src, n, INTFP_PUL_FPMAX(hbits, lbits)); \
+}
+
+/* Uncorrected 'log' encode/decode, scalar and batch. */
+#define __INTFP_DECL_LOG(hbits, lbits) \
 /** \
  * The 'log' format approximates a number in a signed logarithmic form. \
  * It is composed of a sign, exponent, and mantissa: | sign | exponent | mantissa | \
@@ -389,7 +649,7 @@ u##hbits pul##lbits##fpmax_to_u##hbits(u##hbits v) { \
  * @param ofp The number of bits to use for mantissa in the output 'log' value. \
  * @return The approximate 'log' representation of the value. \
  */ \
-s##lbits u##hbits##fp_to_log##lbits##fp(u##hbits v, u8 ifp, u8 ofp) { \
+INTFP_API s##lbits u##hbits##fp_to_log##lbits##fp(u##hbits v, u8 ifp, u8 ofp) { \
 	if (v == 0) return intfp_log_0(lbits); \
 	u8 clz = __intfp_clz(v, hbits); \
 	/* Keep implicit leading 1 in mantissa; addition carries it into exponent. \
@@ -398,20 +658,118 @@ s##lbits u##hbits##fp_to_log##lbits##fp(u##hbits v, u8 ifp, u8 ofp) { \
 	return (s##lbits)(((u##lbits)(hbits - 2 - clz - ifp) << ofp) + m); \
 } \
 /** @brief Converts to 'log' using max precision, from a fixed-point value. */ \
-s##lbits u##hbits##fp_to_log##lbits##fpmax(u##hbits v, u8 ifp) { \
+INTFP_API s##lbits u##hbits##fp_to_log##lbits##fpmax(u##hbits v, u8 ifp) { \
 	return u##hbits##fp_to_log##lbits##fp( \
-		v, ifp, intfp_log_fpmax(hbits, lbits)); \
+		v, ifp, INTFP_LOG_FPMAX(hbits, lbits)); \
 } \
 /** @brief Converts an unsigned integer (no fractional part) to 'log' representation. */ \
-s##lbits u##hbits##_to_log##lbits##fp(u##hbits v, u8 ofp) { \
+INTFP_API s##lbits u##hbits##_to_log##lbits##fp(u##hbits v, u8 ofp) { \
 	return u##hbits##fp_to_log##lbits##fp(v, 0, ofp); \
 } \
 /** @brief Converts an unsigned integer to 'log' using max precision. */ \
-s##lbits u##hbits##_to_log##lbits##fpmax(u##hbits v) { \
+INTFP_API s##lbits u##hbits##_to_log##lbits##fpmax(u##hbits v) { \
 	return u##hbits##fp_to_log##lbits##fpmax(v, 0); \
 } \
 \
-/* --- Corrected 'log' Representation (_corr suffix) --- */ \
+/** \
+ * @brief Converts a 'log' representation back to an unsigned fixed-point value. \
+ * @param v The input 'log' value. \
+ * @param ifp The number of bits used for the exponent in the input 'log' value. \
+ * @param ofp The number of fractional bits in the output fixed-point value. \
+ * @return The reconstructed unsigned fixed-point value. \
+ */ \
+INTFP_API u##hbits log##lbits##fp_to_u##hbits##fp(s##lbits v, u8 ifp, u8 ofp) { \
+	if (v == intfp_log_0(lbits)) return 0; \
+	/* The exponent is signed (the floor of v / 2^ifp, as the encoder writes it). \
+	 * A negative log value means the original value was < 1.0 */ \
+	s##lbits e = v >> ifp; \
+	/* Adjust exponent for the output fixed-point format */ \
+	s##lbits scaled_e = e + ofp; \
+	if (scaled_e < 0) return 0; /* Underflow */ \
+	if (scaled_e >= hbits) return intfp_unsigned_max(hbits); /* Overflow */ \
+	u##hbits m = v & intfp_bitmask(ifp - 1, lbits); \
+	u##hbits norm = (u##hbits)1 << (hbits-1) | (m << (hbits-1 - ifp)); \
+	return norm >> (hbits-1 - scaled_e); \
+} \
+/** @brief Converts from 'log' (max precision) to a fixed-point value. */ \
+INTFP_API u##hbits log##lbits##fpmax_to_u##hbits##fp(s##lbits v, u8 ofp) { \
+	return log##lbits##fp_to_u##hbits##fp( \
+		v, INTFP_LOG_FPMAX(hbits, lbits), ofp); \
+} \
+/** @brief Converts a 'log' value to an integer (no fractional part). */ \
+INTFP_API u##hbits log##lbits##fp_to_u##hbits(s##lbits v, u8 ifp) { \
+	return log##lbits##fp_to_u##hbits##fp(v, ifp, 0); \
+} \
+/** @brief Converts from 'log' (max precision) to an unsigned integer. */ \
+INTFP_API u##hbits log##lbits##fpmax_to_u##hbits(s##lbits v) { \
+	return log##lbits##fpmax_to_u##hbits##fp(v, 0); \
+} \
+\
+/** \
+ * @brief Branch-free variant of u##hbits##fp_to_log##lbits##fp(). \
+ * Same results; zero maps to log_0 through a mask instead of an early return. \
+ */ \
+INTFP_API s##lbits u##hbits##fp_to_log##lbits##fp_bf(u##hbits v, u8 ifp, u8 ofp) { \
+	u8 clz = __intfp_clz(v | 1, hbits); \
+	u##lbits m = (u##hbits)(v << clz) >> (hbits - 1 - ofp); \
+	u##lbits r = ((u##lbits)(hbits - 2 - clz - ifp) << ofp) + m; \
+	u##lbits zero = -(u##lbits)(v == 0); \
+	return (s##lbits)((r & ~zero) | (zero & (u##lbits)intfp_log_0(lbits))); \
+} \
+/** @brief Branch-free u##hbits##_to_log##lbits##fpmax(). */ \
+INTFP_API s##lbits u##hbits##_to_log##lbits##fpmax_bf(u##hbits v) { \
+	return u##hbits##fp_to_log##lbits##fp_bf( \
+		v, 0, INTFP_LOG_FPMAX(hbits, lbits)); \
+} \
+/** \
+ * @brief Branch-free variant of log##lbits##fp_to_u##hbits##fp(). \
+ * Same results; zero, underflow and saturation are selected with masks. \
+ * Costs the same on every input. \
+ */ \
+INTFP_API u##hbits log##lbits##fp_to_u##hbits##fp_bf(s##lbits v, u8 ifp, u8 ofp) { \
+	s##lbits e = v >> ifp; \
+	s##lbits scaled_e = e + ofp; \
+	u##hbits m = v & intfp_bitmask(ifp - 1, lbits); \
+	u##hbits norm = (u##hbits)1 << (hbits-1) | (m << (hbits-1 - ifp)); \
+	/* The shift is wrapped into range; out-of-range results are masked off */ \
+	u##hbits r = norm >> ((hbits-1 - scaled_e) & (hbits-1)); \
+	u##hbits sat = -(u##hbits)(scaled_e >= hbits); \
+	u##hbits zero = -(u##hbits)((scaled_e < 0) | (v == intfp_log_0(lbits))); \
+	return (r | sat) & ~zero; \
+} \
+/** @brief Branch-free log##lbits##fpmax_to_u##hbits(). */ \
+INTFP_API u##hbits log##lbits##fpmax_to_u##hbits##_bf(s##lbits v) { \
+	return log##lbits##fp_to_u##hbits##fp_bf( \
+		v, INTFP_LOG_FPMAX(hbits, lbits), 0); \
+} \
+\
+/** @brief Converts an array of unsigned fixed-point values to 'log'. */ \
+INTFP_API void u##hbits##fp_to_log##lbits##fp_array(s##lbits *dst, const u##hbits *src, \
+		size_t n, u8 ifp, u8 ofp) { \
+	size_t i = __intfp_simd_batch(hbits, lbits, __INTFP_BATCH_TO_LOG, \
+		dst, src, n, ifp, ofp, 0); \
+	for (; i < n; i++) dst[i] = u##hbits##fp_to_log##lbits##fp(src[i], ifp, ofp); \
+} \
+/** @brief Converts an array of unsigned integers to 'log' using max precision. */ \
+INTFP_API void u##hbits##_to_log##lbits##fpmax_array(s##lbits *dst, const u##hbits *src, \
+		size_t n) { \
+	u##hbits##fp_to_log##lbits##fp_array(dst, src, n, 0, INTFP_LOG_FPMAX(hbits, lbits)); \
+} \
+/** @brief Converts an array of 'log' values back to unsigned fixed-point. */ \
+INTFP_API void log##lbits##fp_to_u##hbits##fp_array(u##hbits *dst, const s##lbits *src, \
+		size_t n, u8 ifp, u8 ofp) { \
+	size_t i = __intfp_simd_batch(hbits, lbits, __INTFP_BATCH_FROM_LOG, \
+		dst, src, n, ifp, ofp, 0); \
+	for (; i < n; i++) dst[i] = log##lbits##fp_to_u##hbits##fp(src[i], ifp, ofp); \
+} \
+/** @brief Converts an array from 'log' (max precision) to unsigned integers. */ \
+INTFP_API void log##lbits##fpmax_to_u##hbits##_array(u##hbits *dst, const s##lbits *src, \
+		size_t n) { \
+	log##lbits##fp_to_u##hbits##fp_array(dst, src, n, INTFP_LOG_FPMAX(hbits, lbits), 0); \
+}
+
+/* Corrected 'log' (_corr suffix), scalar and batch. */
+#define __INTFP_DECL_CORR(hbits, lbits) \
 /** \
  * The '_corr' variants improve upon 'log' by applying a pre-computed LUT \
  * correction to both encode and decode, reducing end-to-end multiplication \
@@ -435,7 +793,7 @@ s##lbits u##hbits##_to_log##lbits##fpmax(u##hbits v) { \
  * @param ofp The number of bits to use for mantissa in the output value. \
  * @return The corrected 'log' representation of the value. \
  */ \
-s##lbits u##hbits##fp_to_log##lbits##fp_corr(u##hbits v, u8 ifp, u8 ofp) { \
+INTFP_API s##lbits u##hbits##fp_to_log##lbits##fp_corr(u##hbits v, u8 ifp, u8 ofp) { \
 	if (v == 0) return intfp_log_0(lbits); \
 	u8 clz = __intfp_clz(v, hbits); \
 	u##lbits m = (u##hbits)(v << clz) >> (hbits - 1 - ofp); \
@@ -447,60 +805,25 @@ s##lbits u##hbits##fp_to_log##lbits##fp_corr(u##hbits v, u8 ifp, u8 ofp) { \
 		(u##lbits)(__intfp_enc_corr_lut[_idx] >> (16 - ofp)) : \
 		(u##lbits)((u##lbits)__intfp_enc_corr_lut[_idx] << (ofp - 16)); \
 	{ u##lbits _r = ((u##lbits)(hbits - 2 - clz - ifp) << ofp) + m; \
-	if (_r > (u##lbits)intfp_signed_max(lbits)) \
+	/* Only a non-negative exponent can overflow into the sign bit */ \
+	if (hbits - 2 - clz - ifp >= 0 && _r > (u##lbits)intfp_signed_max(lbits)) \
 		_r = (u##lbits)intfp_signed_max(lbits); \
 	return (s##lbits)_r; } \
 } \
 /** @brief Converts to corrected 'log' using max precision, from a fixed-point value. */ \
-s##lbits u##hbits##fp_to_log##lbits##fpmax_corr(u##hbits v, u8 ifp) { \
+INTFP_API s##lbits u##hbits##fp_to_log##lbits##fpmax_corr(u##hbits v, u8 ifp) { \
 	return u##hbits##fp_to_log##lbits##fp_corr( \
-		v, ifp, intfp_log_fpmax(hbits, lbits)); \
+		v, ifp, INTFP_LOG_FPMAX(hbits, lbits)); \
 } \
 /** @brief Converts an unsigned integer to corrected 'log' representation. */ \
-s##lbits u##hbits##_to_log##lbits##fp_corr(u##hbits v, u8 ofp) { \
+INTFP_API s##lbits u##hbits##_to_log##lbits##fp_corr(u##hbits v, u8 ofp) { \
 	return u##hbits##fp_to_log##lbits##fp_corr(v, 0, ofp); \
 } \
 /** @brief Converts an unsigned integer to corrected 'log' using max precision. */ \
-s##lbits u##hbits##_to_log##lbits##fpmax_corr(u##hbits v) { \
+INTFP_API s##lbits u##hbits##_to_log##lbits##fpmax_corr(u##hbits v) { \
 	return u##hbits##fp_to_log##lbits##fpmax_corr(v, 0); \
 } \
 \
-/** \
- * @brief Converts a 'log' representation back to an unsigned fixed-point value. \
- * @param v The input 'log' value. \
- * @param ifp The number of bits used for the exponent in the input 'log' value. \
- * @param ofp The number of fractional bits in the output fixed-point value. \
- * @return The reconstructed unsigned fixed-point value. \
- */ \
-u##hbits log##lbits##fp_to_u##hbits##fp(s##lbits v, u8 ifp, u8 ofp) { \
-	if (v == intfp_log_0(lbits)) return 0; \
-	bool negative = v < 0; \
-	if (negative) v = -v; \
-	/* The exponent itself is signed. A negative log value means the original value was < 1.0 */ \
-	s##lbits e = v >> ifp; \
-	if (negative) e = -e; \
-	/* Adjust exponent for the output fixed-point format */ \
-	s##lbits scaled_e = e + ofp; \
-	if (scaled_e < 0) return 0; /* Underflow */ \
-	if (scaled_e >= hbits) return intfp_unsigned_max(hbits); /* Overflow */ \
-	u##hbits m = v & intfp_bitmask(ifp - 1, lbits); \
-	u##hbits norm = (u##hbits)1 << (hbits-1) | (m << (hbits-1 - ifp)); \
-	return norm >> (hbits-1 - scaled_e); \
-} \
-/** @brief Converts from 'log' (max precision) to a fixed-point value. */ \
-u##hbits log##lbits##fpmax_to_u##hbits##fp(s##lbits v, u8 ofp) { \
-	return log##lbits##fp_to_u##hbits##fp( \
-		v, intfp_log_fpmax(hbits, lbits), ofp); \
-} \
-/** @brief Converts a 'log' value to an integer (no fractional part). */ \
-u##hbits log##lbits##fp_to_u##hbits(s##lbits v, u8 ifp) { \
-	return log##lbits##fp_to_u##hbits##fp(v, ifp, 0); \
-} \
-/** @brief Converts from 'log' (max precision) to an unsigned integer. */ \
-u##hbits log##lbits##fpmax_to_u##hbits(s##lbits v) { \
-	return log##lbits##fpmax_to_u##hbits##fp(v, 0); \
-} \
-\
 /** \
  * @brief Converts a corrected 'log' representation back to an unsigned fixed-point value. \
  * \
@@ -512,12 +835,9 @@ u##hbits log##lbits##fpmax_to_u##hbits(s##lbits v) { \
  * @param ofp The number of fractional bits in the output fixed-point value. \
  * @return The reconstructed unsigned fixed-point value. \
  */ \
-u##hbits log##lbits##fp_to_u##hbits##fp_corr(s##lbits v, u8 ifp, u8 ofp) { \
+INTFP_API u##hbits log##lbits##fp_to_u##hbits##fp_corr(s##lbits v, u8 ifp, u8 ofp) { \
 	if (v == intfp_log_0(lbits)) return 0; \
-	bool negative = v < 0; \
-	if (negative) v = -v; \
 	s##lbits e = v >> ifp; \
-	if (negative) e = -e; \
 	s##lbits scaled_e = e + ofp; \
 	if (scaled_e < 0) return 0; \
 	if (scaled_e >= hbits) return intfp_unsigned_max(hbits); \
@@ -533,26 +853,54 @@ u##hbits log##lbits##fp_to_u##hbits##fp_corr(s##lbits v, u8 ifp, u8 ofp) { \
 	return norm >> (hbits-1 - scaled_e); \
 } \
 /** @brief Converts from corrected 'log' (max precision) to a fixed-point value. */ \
-u##hbits log##lbits##fpmax_to_u##hbits##fp_corr(s##lbits v, u8 ofp) { \
+INTFP_API u##hbits log##lbits##fpmax_to_u##hbits##fp_corr(s##lbits v, u8 ofp) { \
 	return log##lbits##fp_to_u##hbits##fp_corr( \
-		v, intfp_log_fpmax(hbits, lbits), ofp); \
+		v, INTFP_LOG_FPMAX(hbits, lbits), ofp); \
 } \
 /** @brief Converts a corrected 'log' value to an integer (no fractional part). */ \
-u##hbits log##lbits##fp_to_u##hbits##_corr(s##lbits v, u8 ifp) { \
+INTFP_API u##hbits log##lbits##fp_to_u##hbits##_corr(s##lbits v, u8 ifp) { \
 	return log##lbits##fp_to_u##hbits##fp_corr(v, ifp, 0); \
 } \
 /** @brief Converts from corrected 'log' (max precision) to an unsigned integer. */ \
-u##hbits log##lbits##fpmax_to_u##hbits##_corr(s##lbits v) { \
+INTFP_API u##hbits log##lbits##fpmax_to_u##hbits##_corr(s##lbits v) { \
 	return log##lbits##fpmax_to_u##hbits##fp_corr(v, 0); \
 } \
 \
-/* --- Multi-level corrected 'log' (_corr_n) --- */ \
+/** @brief Converts an array of unsigned fixed-point values to corrected 'log'. */ \
+INTFP_API void u##hbits##fp_to_log##lbits##fp_corr_array(s##lbits *dst, const u##hbits *src, \
+		size_t n, u8 ifp, u8 ofp) { \
+	size_t i = __intfp_simd_batch(hbits, lbits, __INTFP_BATCH_TO_LOG, \
+		dst, src, n, ifp, ofp, 1); \
+	for (; i < n; i++) dst[i] = u##hbits##fp_to_log##lbits##fp_corr(src[i], ifp, ofp); \
+} \
+/** @brief Converts an array of unsigned integers to corrected 'log' using max precision. */ \
+INTFP_API void u##hbits##_to_log##lbits##fpmax_corr_array(s##lbits *dst, const u##hbits *src, \
+		size_t n) { \
+	u##hbits##fp_to_log##lbits##fp_corr_array(dst, src, n, \
+		0, INTFP_LOG_FPMAX(hbits, lbits)); \
+} \
+/** @brief Converts an array of corrected 'log' values back to unsigned fixed-point. */ \
+INTFP_API void log##lbits##fp_to_u##hbits##fp_corr_array(u##hbits *dst, const s##lbits *src, \
+		size_t n, u8 ifp, u8 ofp) { \
+	size_t i = __intfp_simd_batch(hbits, lbits, __INTFP_BATCH_FROM_LOG, \
+		dst, src, n, ifp, ofp, 1); \
+	for (; i < n; i++) dst[i] = log##lbits##fp_to_u##hbits##fp_corr(src[i], ifp, ofp); \
+} \
+/** @brief Converts an array from corrected 'log' (max precision) to unsigned integers. */ \
+INTFP_API void log##lbits##fpmax_to_u##hbits##_corr_array(u##hbits *dst, const s##lbits *src, \
+		size_t n) { \
+	log##lbits##fp_to_u##hbits##fp_corr_array(dst, src, n, \
+		INTFP_LOG_FPMAX(hbits, lbits), 0); \
+}
+
+/* Multi-level corrected 'log' (_corr_n), scalar and batch. Needs LOG and CORR. */
+#define __INTFP_DECL_CORR_N(hbits, lbits) \
 /** \
  * @brief Converts to 'log' with configurable correction level. \
  * @param level 0: no correction, 1: polynomial LUT (same as _corr), \
  *              2: exact LUT, 3: exact LUT + linear interpolation. \
  */ \
-s##lbits u##hbits##fp_to_log##lbits##fp_corr_n(u##hbits v, u8 ifp, u8 ofp, u8 level) { \
+INTFP_API s##lbits u##hbits##fp_to_log##lbits##fp_corr_n(u##hbits v, u8 ifp, u8 ofp, u8 level) { \
 	if (v == 0) return intfp_log_0(lbits); \
 	if (level == 0) return u##hbits##fp_to_log##lbits##fp(v, ifp, ofp); \
 	if (level == 1) return u##hbits##fp_to_log##lbits##fp_corr(v, ifp, ofp); \
@@ -576,11 +924,11 @@ s##lbits u##hbits##fp_to_log##lbits##fp_corr_n(u##hbits v, u8 ifp, u8 ofp, u8 le
 		(u##lbits)((u##lbits)_corr << (ofp - 16)); \
 	u##lbits _result = ((u##lbits)(hbits - 2 - clz - ifp) << ofp) + m; \
 	/* Clamp to s##lbits positive max to prevent sign overflow */ \
-	if (_result > (u##lbits)intfp_signed_max(lbits)) \
+	if (hbits - 2 - clz - ifp >= 0 && _result > (u##lbits)intfp_signed_max(lbits)) \
 		_result = (u##lbits)intfp_signed_max(lbits); \
 	return (s##lbits)_result; \
 } \
-s##lbits u##hbits##_to_log##lbits##fp_corr_n(u##hbits v, u8 ofp, u8 level) { \
+INTFP_API s##lbits u##hbits##_to_log##lbits##fp_corr_n(u##hbits v, u8 ofp, u8 level) { \
 	return u##hbits##fp_to_log##lbits##fp_corr_n(v, 0, ofp, level); \
 } \
 \
@@ -589,15 +937,12 @@ s##lbits u##hbits##_to_log##lbits##fp_corr_n(u##hbits v, u8 ofp, u8 level) { \
  * @param level 0: no correction, 1: polynomial LUT (same as _corr), \
  *              2: exact LUT, 3: exact LUT + linear interpolation. \
  */ \
-u##hbits log##lbits##fp_to_u##hbits##fp_corr_n(s##lbits v, u8 ifp, u8 ofp, u8 level) { \
+INTFP_API u##hbits log##lbits##fp_to_u##hbits##fp_corr_n(s##lbits v, u8 ifp, u8 ofp, u8 level) { \
 	if (level == 0) return log##lbits##fp_to_u##hbits##fp(v, ifp, ofp); \
 	if (level == 1) return log##lbits##fp_to_u##hbits##fp_corr(v, ifp, ofp); \
 	/* Level 2+: exact LUT */ \
 	if (v == intfp_log_0(lbits)) return 0; \
-	bool negative = v < 0; \
-	if (negative) v = -v; \
 	s##lbits e = v >> ifp; \
-	if (negative) e = -e; \
 	s##lbits scaled_e = e + ofp; \
 	if (scaled_e < 0) return 0; \
 	if (scaled_e >= hbits) return intfp_unsigned_max(hbits); \
@@ -620,101 +965,1222 @@ u##hbits log##lbits##fp_to_u##hbits##fp_corr_n(s##lbits v, u8 ifp, u8 ofp, u8 le
 		(u##hbits)((u##hbits)_corr << ((hbits-1) - 16)); \
 	return norm >> (hbits-1 - scaled_e); \
 } \
-u##hbits log##lbits##fp_to_u##hbits##_corr_n(s##lbits v, u8 ifp, u8 level) { \
+INTFP_API u##hbits log##lbits##fp_to_u##hbits##_corr_n(s##lbits v, u8 ifp, u8 level) { \
 	return log##lbits##fp_to_u##hbits##fp_corr_n(v, ifp, 0, level); \
+} \
+\
+/** @brief Converts an array to corrected 'log' with a correction level (0-3). */ \
+INTFP_API void u##hbits##fp_to_log##lbits##fp_corr_n_array(s##lbits *dst, const u##hbits *src, \
+		size_t n, u8 ifp, u8 ofp, u8 level) { \
+	size_t i = __intfp_simd_batch(hbits, lbits, __INTFP_BATCH_TO_LOG, \
+		dst, src, n, ifp, ofp, level); \
+	for (; i < n; i++) \
+		dst[i] = u##hbits##fp_to_log##lbits##fp_corr_n(src[i], ifp, ofp, level); \
+} \
+/** @brief Converts an array from corrected 'log' with a correction level (0-3). */ \
+INTFP_API void log##lbits##fp_to_u##hbits##fp_corr_n_array(u##hbits *dst, const s##lbits *src, \
+		size_t n, u8 ifp, u8 ofp, u8 level) { \
+	size_t i = __intfp_simd_batch(hbits, lbits, __INTFP_BATCH_FROM_LOG, \
+		dst, src, n, ifp, ofp, level); \
+	for (; i < n; i++) \
+		dst[i] = log##lbits##fp_to_u##hbits##fp_corr_n(src[i], ifp, ofp, level); \
 }
 
+/* Signed 'log' (slog) conversions. */
+#define __INTFP_DECL_SLOG(hbits, lbits) \
+/** \
+ * The 'slog' format is a sign-magnitude 'log' for signed values: \
+ * | 'log' of |v| (lbits-1 bits) | sign | \
+ * - The magnitude is an ordinary 'log' value shifted left by one; bit 0 \
+ *   is set for negative values. intfp_slog_0() represents 0. \
+ * - Multiply/divide XOR the signs and add/subtract the magnitudes \
+ *   (slog##lbits##_mul(), slog##lbits##_div()), without branches. \
+ * - ofp/ifp count the fractional bits of the magnitude, at most \
+ *   INTFP_SLOG_FPMAX(hbits, lbits). \
+ */ \
+\
+/** \
+ * @brief Converts a signed fixed-point value to its 'slog' representation. \
+ * Branch-free: the magnitude is encoded with u##hbits##fp_to_log##lbits##fp_bf(). \
+ * @param v The input signed fixed-point value. \
+ * @param ifp The number of fractional bits in the input value `v`. \
+ * @param ofp The number of fractional bits of the output magnitude. \
+ * @return The 'slog' representation of the value. \
+ */ \
+INTFP_API s##lbits s##hbits##fp_to_slog##lbits##fp(s##hbits v, u8 ifp, u8 ofp) { \
+	u##hbits sign = -(u##hbits)(v < 0); \
+	u##hbits mag = ((u##hbits)v ^ sign) - sign; \
+	u##lbits l = (u##lbits)u##hbits##fp_to_log##lbits##fp_bf(mag, ifp, ofp); \
+	u##lbits zero = -(u##lbits)(mag == 0); \
+	l = (u##lbits)(l << 1) | (sign & 1); \
+	return (s##lbits)((l & ~zero) | (zero & (u##lbits)intfp_slog_0(lbits))); \
+} \
+/** @brief Converts a signed integer to 'slog'. */ \
+INTFP_API s##lbits s##hbits##_to_slog##lbits##fp(s##hbits v, u8 ofp) { \
+	return s##hbits##fp_to_slog##lbits##fp(v, 0, ofp); \
+} \
+/** @brief Converts a signed integer to 'slog' using max precision. */ \
+INTFP_API s##lbits s##hbits##_to_slog##lbits##fpmax(s##hbits v) { \
+	return s##hbits##fp_to_slog##lbits##fp(v, 0, INTFP_SLOG_FPMAX(hbits, lbits)); \
+} \
+\
+/** \
+ * @brief Converts a 'slog' value back to a signed fixed-point value. \
+ * Branch-free: the magnitude is decoded with log##lbits##fp_to_u##hbits##fp_bf(). \
+ * @param v The input 'slog' value. \
+ * @param ifp The number of fractional bits of the input magnitude. \
+ * @param ofp The number of fractional bits for the output value. \
+ * @return The signed fixed-point value, saturated to the range of s##hbits. \
+ */ \
+INTFP_API s##hbits slog##lbits##fp_to_s##hbits##fp(s##lbits v, u8 ifp, u8 ofp) { \
+	u##hbits sign = -(u##hbits)(v & 1); \
+	u##hbits mag = log##lbits##fp_to_u##hbits##fp_bf((s##lbits)(v >> 1), ifp, ofp) & \
+		-(u##hbits)(v != intfp_slog_0(lbits)); \
+	/* A negative result may reach 2^(hbits-1), a positive one only s##hbits max */ \
+	u##hbits lim = (u##hbits)intfp_signed_max(hbits) - sign; \
+	mag = (mag > lim) ? lim : mag; \
+	return (s##hbits)((mag ^ sign) - sign); \
+} \
+/** @brief Converts a 'slog' value to a signed integer. */ \
+INTFP_API s##hbits slog##lbits##fp_to_s##hbits(s##lbits v, u8 ifp) { \
+	return slog##lbits##fp_to_s##hbits##fp(v, ifp, 0); \
+} \
+/** @brief Converts a 'slog' value (max precision) to a signed integer. */ \
+INTFP_API s##hbits slog##lbits##fpmax_to_s##hbits(s##lbits v) { \
+	return slog##lbits##fp_to_s##hbits##fp(v, INTFP_SLOG_FPMAX(hbits, lbits), 0); \
+} \
+__intfp_if_corr( \
+/** @brief Converts a signed fixed-point value to 'slog' with the '_corr' magnitude. */ \
+INTFP_API s##lbits s##hbits##fp_to_slog##lbits##fp_corr(s##hbits v, u8 ifp, u8 ofp) { \
+	u##hbits sign = -(u##hbits)(v < 0); \
+	u##hbits mag = ((u##hbits)v ^ sign) - sign; \
+	if (mag == 0) return intfp_slog_0(lbits); \
+	u##lbits l = (u##lbits)u##hbits##fp_to_log##lbits##fp_corr(mag, ifp, ofp); \
+	return (s##lbits)((u##lbits)(l << 1) | (sign & 1)); \
+} \
+/** @brief Converts a signed integer to 'slog' (max precision, '_corr' magnitude). */ \
+INTFP_API s##lbits s##hbits##_to_slog##lbits##fpmax_corr(s##hbits v) { \
+	return s##hbits##fp_to_slog##lbits##fp_corr(v, 0, INTFP_SLOG_FPMAX(hbits, lbits)); \
+} \
+/** @brief Converts a 'slog' value to signed fixed-point with the '_corr' magnitude. */ \
+INTFP_API s##hbits slog##lbits##fp_to_s##hbits##fp_corr(s##lbits v, u8 ifp, u8 ofp) { \
+	if (v == intfp_slog_0(lbits)) return 0; \
+	u##hbits sign = -(u##hbits)(v & 1); \
+	u##hbits mag = log##lbits##fp_to_u##hbits##fp_corr((s##lbits)(v >> 1), ifp, ofp); \
+	u##hbits lim = (u##hbits)intfp_signed_max(hbits) - sign; \
+	mag = (mag > lim) ? lim : mag; \
+	return (s##hbits)((mag ^ sign) - sign); \
+} \
+/** @brief Converts a 'slog' value (max precision) to a signed integer, '_corr' magnitude. */ \
+INTFP_API s##hbits slog##lbits##fpmax_to_s##hbits##_corr(s##lbits v) { \
+	return slog##lbits##fp_to_s##hbits##fp_corr(v, INTFP_SLOG_FPMAX(hbits, lbits), 0); \
+})
+
+/**
+ * @brief Generates the core conversion functions between integer, fixed-point,
+ * 'pul', and 'log' representations.
+ * @param hbits The bit-width of the source/destination integer or fixed-point type.
+ * @param lbits The bit-width of the destination/source 'pul' or 'log' type.
+ */
+#define INTFP_DECL_HBITS_LBITS(hbits, lbits) \
+	__INTFP_DECL_FIXED(hbits, lbits) \
+	__intfp_if_pul(__INTFP_DECL_PUL(hbits, lbits)) \
+	__intfp_if_log(__INTFP_DECL_LOG(hbits, lbits)) \
+	__intfp_if_corr(__INTFP_DECL_CORR(hbits, lbits)) \
+	__intfp_if_corr_n(__INTFP_DECL_CORR_N(hbits, lbits)) \
+	__intfp_if_slog(__INTFP_DECL_SLOG(hbits, lbits))
+
 /* Generate conversion functions for various bit-width combinations */
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_8_8)
 INTFP_DECL_HBITS_LBITS( 8, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_8)
 INTFP_DECL_HBITS_LBITS(16, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_8)
 INTFP_DECL_HBITS_LBITS(32, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
 INTFP_DECL_HBITS_LBITS(64, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_16)
 INTFP_DECL_HBITS_LBITS(16,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_16)
 INTFP_DECL_HBITS_LBITS(32,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
 INTFP_DECL_HBITS_LBITS(64,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_32)
 INTFP_DECL_HBITS_LBITS(32,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_32)
 INTFP_DECL_HBITS_LBITS(64,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_64)
 INTFP_DECL_HBITS_LBITS(64,64)
+#endif
+
+/**
+ * @brief Generates table-driven decoders of the 8-bit formats to u##hbits.
+ * An 8-bit code has only 256 values, so for a given fp a decoder is a single
+ * table load. The *_lut8_init() functions fill a table from the scalar
+ * decoder, and the *_lut8_array() functions apply it to n codes with the
+ * same results. On x86-64, 8- and 16-bit values are looked up with byte
+ * shuffles (see intfp_simd.h) and 32- and 64-bit values are gathered.
+ * @param hbits The bit-width of the decoded values (8, 16, 32, 64).
+ */
+#define INTFP_DECL_LUT8(hbits) \
+/** @brief The decoded value of each of the 256 codes of an 8-bit format. */ \
+struct u##hbits##_lut8 { \
+	u##hbits t[256]; /**< t[code]; 'slog' tables hold the bits of s##hbits values. */ \
+}; \
+INTFP_API void __u##hbits##_lut8_array(u##hbits *dst, const u8 *src, size_t n, \
+		const struct u##hbits##_lut8 *lut) { \
+	size_t i = __intfp_simd_lut8(dst, src, n, lut->t, hbits / 8); \
+	for (; i < n; i++) \
+		dst[i] = lut->t[src[i]]; \
+} \
+__intfp_if_pul( \
+/** @brief Fills lut with pul8fp_to_u##hbits(code, ifp) for every code. */ \
+INTFP_API void pul8fp_to_u##hbits##_lut8_init(struct u##hbits##_lut8 *lut, u8 ifp) { \
+	for (int v = 0; v < 256; v++) \
+		lut->t[v] = pul8fp_to_u##hbits((u8)v, ifp); \
+} \
+/** @brief Decodes n 'pul8' codes through a table from pul8fp_to_u##hbits##_lut8_init(). */ \
+INTFP_API void pul8fp_to_u##hbits##_lut8_array(u##hbits *dst, const u8 *src, size_t n, \
+		const struct u##hbits##_lut8 *lut) { \
+	__u##hbits##_lut8_array(dst, src, n, lut); \
+}) \
+__intfp_if_log( \
+/** @brief Fills lut with log8fp_to_u##hbits##fp(code, ifp, ofp) for every code. */ \
+INTFP_API void log8fp_to_u##hbits##fp_lut8_init(struct u##hbits##_lut8 *lut, u8 ifp, u8 ofp) { \
+	for (int v = 0; v < 256; v++) \
+		lut->t[v] = log8fp_to_u##hbits##fp((s8)v, ifp, ofp); \
+} \
+/** @brief Decodes n 'log8' codes through a table from a log8fp_to_u##hbits##fp*_lut8_init(). */ \
+INTFP_API void log8fp_to_u##hbits##fp_lut8_array(u##hbits *dst, const s8 *src, size_t n, \
+		const struct u##hbits##_lut8 *lut) { \
+	__u##hbits##_lut8_array(dst, (const u8 *)src, n, lut); \
+}) \
+__intfp_if_corr_n( \
+/** @brief Fills lut with log8fp_to_u##hbits##fp_corr_n(code, ifp, ofp, level) for every code. */ \
+INTFP_API void log8fp_to_u##hbits##fp_corr_n_lut8_init(struct u##hbits##_lut8 *lut, \
+		u8 ifp, u8 ofp, u8 level) { \
+	for (int v = 0; v < 256; v++) \
+		lut->t[v] = log8fp_to_u##hbits##fp_corr_n((s8)v, ifp, ofp, level); \
+}) \
+__intfp_if_slog( \
+/** @brief Fills lut with slog8fp_to_s##hbits##fp(code, ifp, ofp) for every code. */ \
+INTFP_API void slog8fp_to_s##hbits##fp_lut8_init(struct u##hbits##_lut8 *lut, u8 ifp, u8 ofp) { \
+	for (int v = 0; v < 256; v++) \
+		lut->t[v] = (u##hbits)slog8fp_to_s##hbits##fp((s8)v, ifp, ofp); \
+} \
+/** @brief Decodes n 'slog8' codes through a table from slog8fp_to_s##hbits##fp_lut8_init(). */ \
+INTFP_API void slog8fp_to_s##hbits##fp_lut8_array(s##hbits *dst, const s8 *src, size_t n, \
+		const struct u##hbits##_lut8 *lut) { \
+	__u##hbits##_lut8_array((u##hbits *)dst, (const u8 *)src, n, lut); \
+})
+
+/* Generate table-driven decoders for the 8-bit formats */
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_8_8)
+INTFP_DECL_LUT8( 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_8)
+INTFP_DECL_LUT8(16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_8)
+INTFP_DECL_LUT8(32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
+INTFP_DECL_LUT8(64)
+#endif
 
+/*
+ * Fixed-format variants
+ *
+ * The functions above take the fractional bit count (`ifp`/`ofp`) at run
+ * time. Unless a call is inlined with a constant argument, their shifts use
+ * variable counts and the `ofp >= 8` / `ofp <= 16` selections of the
+ * correction index stay in the code. The generators below build variants with
+ * the count fixed at compile time. They are flattened (the generic body is
+ * always inlined into them), so every shift takes an immediate and those
+ * selections fold away, whatever the linkage or optimization level.
+ *
+ * They are not instantiated by default; invoke them for the formats in use,
+ * after including this header. The fractional bit count becomes part of the
+ * names, so it must be a plain decimal literal.
+ */
+#define __intfp_flatten __attribute__((flatten))
 
 /**
- * @brief Generates functions for converting between different 'pul' and 'log' types.
- * These functions allow changing the bit-width (e.g., log8 to log16) or the
- * exponent/mantissa allocation within the same bit-width.
- * @param ibits The bit-width of the input 'pul'/'log' type.
- * @param obits The bit-width of the output 'pul'/'log' type.
+ * @brief Generates 'pul' conversions with a fixed number of fractional bits.
+ * e.g. INTFP_DECL_PUL_FP(64, 16, 10) -> u64_to_pul16fp10(), pul16fp10_to_u64()
+ * @param hbits The bit-width of the integer type.
+ * @param lbits The bit-width of the 'pul' type.
+ * @param nfp   The number of fractional bits (at most INTFP_PUL_FPMAX(hbits, lbits)).
  */
-#define INTFP_DECL_IBITS_OBITS(ibits, obits) \
-/* --- In-type conversions (bit-width and exponent/mantissa ratio changes) --- */ \
-\
+#define INTFP_DECL_PUL_FP(hbits, lbits, nfp) __intfp_if_pul( \
+/** @brief Converts an unsigned integer to 'pul' with nfp fractional bits. */ \
+INTFP_API __intfp_flatten u##lbits u##hbits##_to_pul##lbits##fp##nfp(u##hbits v) { \
+	return u##hbits##_to_pul##lbits##fp(v, nfp); \
+} \
+/** @brief Converts a 'pul' value with nfp fractional bits to an unsigned integer. */ \
+INTFP_API __intfp_flatten u##hbits pul##lbits##fp##nfp##_to_u##hbits(u##lbits v) { \
+	return pul##lbits##fp_to_u##hbits(v, nfp); \
+})
+
+/**
+ * @brief Generates 'log' conversions (plain, _corr and _corr_n, as selected)
+ * with a fixed number of fractional bits.
+ * e.g. INTFP_DECL_LOG_FP(64, 32, 20) -> u64_to_log32fp20(), log32fp20_to_u64(),
+ *      u64_to_log32fp20_corr(), ..., log32fp20_to_u64_corr_n(v, level)
+ * @param hbits The bit-width of the integer type.
+ * @param lbits The bit-width of the 'log' type.
+ * @param nfp   The number of fractional bits (at most INTFP_LOG_FPMAX(hbits, lbits)).
+ */
+#define INTFP_DECL_LOG_FP(hbits, lbits, nfp) \
+__intfp_if_log( \
+/** @brief Converts an unsigned integer to 'log' with nfp fractional bits. */ \
+INTFP_API __intfp_flatten s##lbits u##hbits##_to_log##lbits##fp##nfp(u##hbits v) { \
+	return u##hbits##_to_log##lbits##fp(v, nfp); \
+} \
+/** @brief Converts a 'log' value with nfp fractional bits to an unsigned integer. */ \
+INTFP_API __intfp_flatten u##hbits log##lbits##fp##nfp##_to_u##hbits(s##lbits v) { \
+	return log##lbits##fp_to_u##hbits(v, nfp); \
+}) \
+__intfp_if_corr( \
+/** @brief Converts an unsigned integer to corrected 'log' with nfp fractional bits. */ \
+INTFP_API __intfp_flatten s##lbits u##hbits##_to_log##lbits##fp##nfp##_corr(u##hbits v) { \
+	return u##hbits##_to_log##lbits##fp_corr(v, nfp); \
+} \
+/** @brief Converts a corrected 'log' value with nfp fractional bits to an unsigned integer. */ \
+INTFP_API __intfp_flatten u##hbits log##lbits##fp##nfp##_to_u##hbits##_corr(s##lbits v) { \
+	return log##lbits##fp_to_u##hbits##_corr(v, nfp); \
+}) \
+__intfp_if_corr_n( \
+/** @brief Converts an unsigned integer to 'log' with nfp fractional bits and a correction level. */ \
+INTFP_API __intfp_flatten s##lbits u##hbits##_to_log##lbits##fp##nfp##_corr_n(u##hbits v, u8 level) { \
+	return u##hbits##_to_log##lbits##fp_corr_n(v, nfp, level); \
+} \
+/** @brief Converts a 'log' value with nfp fractional bits to an unsigned integer, with a correction level. */ \
+INTFP_API __intfp_flatten u##hbits log##lbits##fp##nfp##_to_u##hbits##_corr_n(s##lbits v, u8 level) { \
+	return log##lbits##fp_to_u##hbits##_corr_n(v, nfp, level); \
+})
+
+
+/* 'pul' to 'pul' re-encoding (bit-width and exponent/mantissa ratio changes). */
+#define __INTFP_DECL_CONV_PUL(ibits, obits) \
 /** @brief Converts a 'pul' value to another 'pul' type, adjusting for exponent bits. */ \
-u##obits pul##ibits##fp_to_pul##obits##fp(u##ibits v, u8 ifp, u8 ofp) { \
+INTFP_API u##obits pul##ibits##fp_to_pul##obits##fp(u##ibits v, u8 ifp, u8 ofp) { \
 	if (v == intfp_pul_0(ibits)) return intfp_pul_0(obits); \
 	/* Conversion is a simple shift if the exponent bit allocation changes. */ \
 	return (ifp == ofp) ? v : ((ifp < ofp) ? \
 		(v << (ofp - ifp)): (v >> (ifp - ofp))); \
 } \
 /** @brief Converts 'pul' to 'pul' using max precision settings for both. */ \
-u##obits pul##ibits##fpmax_to_pul##obits##fpmax(u##ibits v) { \
+INTFP_API u##obits pul##ibits##fpmax_to_pul##obits##fpmax(u##ibits v) { \
 	return pul##ibits##fp_to_pul##obits##fp( \
 		v, ibits - intfp_fls32(ibits-1), obits - intfp_fls32(ibits-1)); \
-} \
+}
+
+/* 'log' to 'log' re-encoding (bit-width and exponent/mantissa ratio changes). */
+#define __INTFP_DECL_CONV_LOG(ibits, obits) \
 /** @brief Converts a 'log' value to another 'log' type, adjusting for exponent bits. */ \
-s##obits log##ibits##fp_to_log##obits##fp(s##ibits v, u8 ifp, u8 ofp) { \
+INTFP_API s##obits log##ibits##fp_to_log##obits##fp(s##ibits v, u8 ifp, u8 ofp) { \
 	if (v == intfp_log_0(ibits)) return intfp_log_0(obits); \
 	return (ifp == ofp) ? v : (s##obits)((ifp < ofp) ? \
 		((u##ibits)v << (ofp - ifp)): ((u##ibits)v >> (ifp - ofp))); \
 } \
 /** @brief Converts 'log' to 'log' using max precision settings for both. */ \
-s##obits log##ibits##fpmax_to_log##obits##fpmax(s##ibits v) { \
+INTFP_API s##obits log##ibits##fpmax_to_log##obits##fpmax(s##ibits v) { \
 	return log##ibits##fp_to_log##obits##fp( \
 		v, ibits-1 - intfp_fls32(ibits-1), obits-1 - intfp_fls32(ibits-1)); \
-} \
-\
-/* --- Inter-type conversions ('pul' <-> 'log') --- */ \
+}
+
+/* Inter-type conversions ('pul' <-> 'log'). */
+#define __INTFP_DECL_CONV_PUL_LOG(ibits, obits) \
 \
 /** @brief Converts a 'pul' value to a 'log' value. */ \
-s##obits pul##ibits##fp_to_log##obits##fp(u##ibits v, u8 ifp, u8 ofp) { \
+INTFP_API s##obits pul##ibits##fp_to_log##obits##fp(u##ibits v, u8 ifp, u8 ofp) { \
 	if (v == intfp_pul_0(ibits)) return intfp_log_0(obits); \
 	/* Since 'pul' is always positive, this is just a bit-width/ratio change. */ \
 	return (ifp == ofp) ? v : ((ifp < ofp) ? \
 		(v << (ofp - ifp)): (v >> (ifp - ofp))); \
 } \
 /** @brief Converts 'pul' (max precision) to 'log' (max precision). */ \
-s##obits pul##ibits##fpmax_to_log##obits##fpmax(u##ibits v) { \
+INTFP_API s##obits pul##ibits##fpmax_to_log##obits##fpmax(u##ibits v) { \
 	return pul##ibits##fp_to_log##obits##fp( \
 		v, ibits - intfp_fls32(ibits-1), obits-1 - intfp_fls32(ibits-1)); \
 } \
 /** @brief Converts a 'log' value to a 'pul' value. */ \
-u##obits log##ibits##fp_to_pul##obits##fp(s##ibits v, u8 ifp, u8 ofp) { \
+INTFP_API u##obits log##ibits##fp_to_pul##obits##fp(s##ibits v, u8 ifp, u8 ofp) { \
 	/* 'pul' cannot represent negative 'log' values (i.e., values < 1.0) */ \
 	if (v < 0) return intfp_pul_0(obits); \
 	return (ifp == ofp) ? (u##obits)v : (u##obits)((ifp < ofp) ? \
 		((u##ibits)v << (ofp - ifp)): ((u##ibits)v >> (ifp - ofp))); \
 } \
 /** @brief Converts 'log' (max precision) to 'pul' (max precision). */ \
-u##obits log##ibits##fpmax_to_pul##obits##fpmax(s##ibits v) { \
+INTFP_API u##obits log##ibits##fpmax_to_pul##obits##fpmax(s##ibits v) { \
 	return log##ibits##fp_to_pul##obits##fp( \
 		v, ibits-1 - intfp_fls32(ibits-1), obits - intfp_fls32(ibits-1)); \
 }
 
+/**
+ * @brief Generates functions for converting between different 'pul' and 'log' types.
+ * These functions allow changing the bit-width (e.g., log8 to log16) or the
+ * exponent/mantissa allocation within the same bit-width.
+ * @param ibits The bit-width of the input 'pul'/'log' type.
+ * @param obits The bit-width of the output 'pul'/'log' type.
+ */
+#define INTFP_DECL_IBITS_OBITS(ibits, obits) \
+	__intfp_if_pul(__INTFP_DECL_CONV_PUL(ibits, obits)) \
+	__intfp_if_log(__INTFP_DECL_CONV_LOG(ibits, obits)) \
+	__intfp_if_pul(__intfp_if_log(__INTFP_DECL_CONV_PUL_LOG(ibits, obits)))
+
 /* Generate type-conversion functions for various bit-width combinations */
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_8_8)
 INTFP_DECL_IBITS_OBITS( 8, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_8_16)
 INTFP_DECL_IBITS_OBITS( 8,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_8_32)
 INTFP_DECL_IBITS_OBITS( 8,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_8_64)
 INTFP_DECL_IBITS_OBITS( 8,64)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_16_8)
 INTFP_DECL_IBITS_OBITS(16, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_16_16)
 INTFP_DECL_IBITS_OBITS(16,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_16_32)
 INTFP_DECL_IBITS_OBITS(16,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_16_64)
 INTFP_DECL_IBITS_OBITS(16,64)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_32_8)
 INTFP_DECL_IBITS_OBITS(32, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_32_16)
 INTFP_DECL_IBITS_OBITS(32,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_32_32)
 INTFP_DECL_IBITS_OBITS(32,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_32_64)
 INTFP_DECL_IBITS_OBITS(32,64)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_64_8)
 INTFP_DECL_IBITS_OBITS(64, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_64_16)
 INTFP_DECL_IBITS_OBITS(64,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_64_32)
 INTFP_DECL_IBITS_OBITS(64,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_CONV_64_64)
 INTFP_DECL_IBITS_OBITS(64,64)
+#endif
+
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_LOG)
+/**
+ * @brief Generates saturating 'log' arithmetic of one width.
+ * Multiplying two 'log' values by hand (`a + b`) wraps on overflow and turns
+ * intfp_log_0() into a garbage value. These helpers instead:
+ * - propagate zero: a zero operand gives intfp_log_0() (0^n and x/0 saturate),
+ * - saturate: a result too large becomes intfp_signed_max(), one too small
+ *   for the format becomes intfp_log_0(),
+ * and compile to an add/sub with overflow flag and a few conditional moves.
+ * The fractional bit count does not matter as long as both operands share it.
+ * @param bits The bit-width of the 'log' type (8, 16, 32, 64).
+ */
+#define INTFP_DECL_LOG_ARITH_BITS(bits) \
+/** @brief Multiplies two 'log' values (adds them), saturating. */ \
+INTFP_API s##bits log##bits##_mul(s##bits a, s##bits b) { \
+	s##bits r; \
+	u##bits ovf = -(u##bits)__builtin_add_overflow(a, b, &r); \
+	/* An overflow goes the way of the operands' common sign: max ^ -1 is min */ \
+	u##bits sat = (u##bits)intfp_signed_max(bits) ^ -(u##bits)(a < 0); \
+	u##bits zero = -(u##bits)((a == intfp_log_0(bits)) | (b == intfp_log_0(bits))); \
+	u##bits u = ((u##bits)r & ~ovf) | (sat & ovf); \
+	return (s##bits)((u & ~zero) | ((u##bits)intfp_log_0(bits) & zero)); \
+} \
+/** @brief Divides two 'log' values (subtracts them), saturating; x/0 gives the maximum. */ \
+INTFP_API s##bits log##bits##_div(s##bits a, s##bits b) { \
+	s##bits r; \
+	u##bits ovf = -(u##bits)__builtin_sub_overflow(a, b, &r); \
+	u##bits sat = (u##bits)intfp_signed_max(bits) ^ -(u##bits)(a < 0); \
+	u##bits azero = -(u##bits)(a == intfp_log_0(bits)); \
+	u##bits bzero = -(u##bits)(b == intfp_log_0(bits)); \
+	u##bits u = ((u##bits)r & ~ovf) | (sat & ovf); \
+	u = (u & ~bzero) | ((u##bits)intfp_signed_max(bits) & bzero); \
+	return (s##bits)((u & ~azero) | ((u##bits)intfp_log_0(bits) & azero)); \
+} \
+/** \
+ * @brief Raises a 'log' value to an integer power (multiplies it by n), saturating. \
+ * 0^0 is 1 (a 'log' value of 0), and 0 to a negative power saturates. \
+ */ \
+INTFP_API s##bits log##bits##_pow(s##bits a, s32 n) { \
+	s##bits r; \
+	u##bits ovf = -(u##bits)__builtin_mul_overflow(a, n, &r); \
+	u##bits sat = (u##bits)intfp_signed_max(bits) ^ -(u##bits)((a < 0) != (n < 0)); \
+	u##bits zero = -(u##bits)(a == intfp_log_0(bits)); \
+	u##bits zpow = ((u##bits)intfp_log_0(bits) & -(u##bits)(n > 0)) | \
+		((u##bits)intfp_signed_max(bits) & -(u##bits)(n < 0)); \
+	u##bits u = ((u##bits)r & ~ovf) | (sat & ovf); \
+	return (s##bits)((u & ~zero) | (zpow & zero)); \
+} \
+/** \
+ * @brief Changes the number of fractional bits of a 'log' value, saturating. \
+ * @param v The 'log' value (intfp_log_0() stays zero). \
+ * @param ifp The number of fractional bits of v. \
+ * @param ofp The number of fractional bits of the result. \
+ */ \
+INTFP_API s##bits log##bits##fp_rescale(s##bits v, u8 ifp, u8 ofp) { \
+	u8 l = (ofp > ifp) ? ofp - ifp : 0, rs = (ifp > ofp) ? ifp - ofp : 0; \
+	s##bits lim = intfp_signed_max(bits) >> l; \
+	u##bits r = (u##bits)(v >> rs) << l; \
+	u##bits big = -(u##bits)(v > lim); \
+	u##bits zero = -(u##bits)(v < -lim); \
+	r = (r & ~big) | ((u##bits)intfp_signed_max(bits) & big); \
+	return (s##bits)((r & ~zero) | ((u##bits)intfp_log_0(bits) & zero)); \
+} \
+/** @brief Multiplies two arrays of 'log' values element-wise, saturating (dst may alias a or b). */ \
+INTFP_API void log##bits##_mul_array(s##bits *dst, const s##bits *a, const s##bits *b, size_t n) { \
+	size_t i = __intfp_simd_log_arith(bits, dst, a, b, n, false); \
+	for (; i < n; i++) dst[i] = log##bits##_mul(a[i], b[i]); \
+} \
+/** @brief Divides two arrays of 'log' values element-wise, saturating (dst may alias a or b). */ \
+INTFP_API void log##bits##_div_array(s##bits *dst, const s##bits *a, const s##bits *b, size_t n) { \
+	size_t i = __intfp_simd_log_arith(bits, dst, a, b, n, true); \
+	for (; i < n; i++) dst[i] = log##bits##_div(a[i], b[i]); \
+}
+
+/* Sign-extends a narrow 'log' value, keeping zero */
+#define __intfp_log_widen(v, nbits, wbits) \
+	((s##wbits)(((u##wbits)(s##wbits)(v) & ~-(u##wbits)((v) == intfp_log_0(nbits))) | \
+		((u##wbits)intfp_log_0(wbits) & -(u##wbits)((v) == intfp_log_0(nbits)))))
+
+/**
+ * @brief Generates mixed-width saturating 'log' arithmetic.
+ * The narrow operand is widened and rescaled to the fractional bits of the
+ * wide one (log##wbits##fp_rescale()), and the result has the wide type.
+ * @param wbits The bit-width of the wide 'log' type.
+ * @param nbits The bit-width of the narrow 'log' type.
+ */
+#define INTFP_DECL_LOG_ARITH_MIXED(wbits, nbits) \
+/** @brief Multiplies a 'log' value by a narrower one; the result has afp fractional bits. */ \
+INTFP_API s##wbits log##wbits##fp_mul_log##nbits##fp(s##wbits a, s##nbits b, u8 afp, u8 bfp) { \
+	return log##wbits##_mul(a, log##wbits##fp_rescale(__intfp_log_widen(b, nbits, wbits), bfp, afp)); \
+} \
+/** @brief Divides a 'log' value by a narrower one; the result has afp fractional bits. */ \
+INTFP_API s##wbits log##wbits##fp_div_log##nbits##fp(s##wbits a, s##nbits b, u8 afp, u8 bfp) { \
+	return log##wbits##_div(a, log##wbits##fp_rescale(__intfp_log_widen(b, nbits, wbits), bfp, afp)); \
+} \
+/** @brief Divides a 'log' value by a wider one; the result has the wide type and bfp fractional bits. */ \
+INTFP_API s##wbits log##nbits##fp_div_log##wbits##fp(s##nbits a, s##wbits b, u8 afp, u8 bfp) { \
+	return log##wbits##_div(log##wbits##fp_rescale(__intfp_log_widen(a, nbits, wbits), afp, bfp), b); \
+}
+
+/**
+ * @brief Generates 'log' powers and roots with fractional exponents.
+ * x^e is e * log(x). The exponent is a signed fixed-point value with qfp
+ * fractional bits (Q-format), e.g. 1/2.2 = 29789 with qfp = 16. The product
+ * is rounded to nearest; its integer part is computed separately, so that
+ * no intermediate overflows and results saturate like log##bits##_pow().
+ * @param bits The bit-width of the 'log' type.
+ */
+#define INTFP_DECL_LOG_POW_BITS(bits) \
+/** \
+ * @brief Raises a 'log' value to the power e / 2^qfp, rounded and saturating. \
+ * 0^0 is 1, 0 to a negative power saturates, and results below the \
+ * 'log' range are zero. \
+ * @param qfp The fractional bits of e (0-30). \
+ */ \
+INTFP_API s##bits log##bits##_pow_q(s##bits a, s32 e, u8 qfp) { \
+	const s64 max = intfp_signed_max(bits); \
+	/* a * e / 2^qfp = (a >> qfp) * e + (a & mask) * e / 2^qfp */ \
+	s64 hi, lo = (((s64)a & (((s64)1 << qfp) - 1)) * e + (((s64)1 << qfp) >> 1)) >> qfp; \
+	bool ovf = __builtin_mul_overflow((s64)a >> qfp, (s64)e, &hi); \
+	ovf |= __builtin_add_overflow(hi, lo, &hi); \
+	/* An overflow has the sign of a * e */ \
+	u64 big = -(u64)((hi > max) | (ovf & ((a < 0) == (e < 0)))); \
+	u64 small = -(u64)((hi < -max) | (ovf & ((a < 0) != (e < 0)))); \
+	u64 r = ((u64)hi & ~big) | ((u64)max & big); \
+	r = (r & ~small) | ((u64)intfp_log_0(bits) & small); \
+	u64 zero = -(u64)(a == intfp_log_0(bits)); \
+	u64 zpow = ((u64)intfp_log_0(bits) & -(u64)(e > 0)) | ((u64)max & -(u64)(e < 0)); \
+	return (s##bits)((r & ~zero) | (zpow & zero)); \
+} \
+/** @brief Takes the n-th root of a 'log' value (divides it by n, rounded); n >= 1. */ \
+INTFP_API s##bits log##bits##_root(s##bits a, u8 n) { \
+	s##bits q = a / n, rem = a % n; \
+	q += (rem * 2 >= n) - (rem * 2 <= -n); \
+	u##bits zero = -(u##bits)(a == intfp_log_0(bits)); \
+	return (s##bits)(((u##bits)q & ~zero) | ((u##bits)intfp_log_0(bits) & zero)); \
+} \
+/** @brief Takes the reciprocal of a 'log' value (negates it); 1/0 saturates. */ \
+INTFP_API s##bits log##bits##_recip(s##bits a) { \
+	u##bits zero = -(u##bits)(a == intfp_log_0(bits)); \
+	return (s##bits)((-(u##bits)a & ~zero) | ((u##bits)intfp_signed_max(bits) & zero)); \
+} \
+/** @brief Takes the reciprocal square root of a 'log' value; 1/sqrt(0) saturates. */ \
+INTFP_API s##bits log##bits##_rsqrt(s##bits a) { \
+	return log##bits##_recip(log##bits##_root(a, 2)); \
+}
+
+/* Generate saturating 'log' arithmetic for 8, 16, 32, and 64-bit 'log' */
+INTFP_DECL_LOG_ARITH_BITS(8)
+INTFP_DECL_LOG_ARITH_BITS(16)
+INTFP_DECL_LOG_ARITH_BITS(32)
+INTFP_DECL_LOG_ARITH_BITS(64)
+INTFP_DECL_LOG_POW_BITS(8)
+INTFP_DECL_LOG_POW_BITS(16)
+INTFP_DECL_LOG_POW_BITS(32)
+INTFP_DECL_LOG_POW_BITS(64)
+INTFP_DECL_LOG_ARITH_MIXED(16, 8)
+INTFP_DECL_LOG_ARITH_MIXED(32, 8)
+INTFP_DECL_LOG_ARITH_MIXED(32, 16)
+INTFP_DECL_LOG_ARITH_MIXED(64, 8)
+INTFP_DECL_LOG_ARITH_MIXED(64, 16)
+INTFP_DECL_LOG_ARITH_MIXED(64, 32)
+#endif
+
+/*
+ * Clamps the muldiv sum r into the 'log' type: log_0 for a zero operand or
+ * a result below 1.0, top for a result too large for the integer type. The
+ * caller ORs the saturation mask (r >= lim) into the decoded value, since
+ * lim itself may not fit the 'log' type. Masks, not branches: which case
+ * applies depends on the data and predicts poorly.
+ */
+INTFP_API s64 __intfp_muldiv_clamp(s64 r, s64 top, s64 log_0, bool zero) {
+	s64 z = -(s64)(zero | (r < 0));
+	s64 sat = -(s64)(r > top);
+	r = (r & ~sat) | (top & sat);
+	return (r & ~z) | (log_0 & z);
+}
+
+/**
+ * @brief Generates the approximate a * b / c (muldiv) of one integer width.
+ * The three operands are encoded to 'log' (lbits wide, max precision),
+ * combined as log(a) + log(b) - log(c) in 64-bit arithmetic, so that the
+ * intermediate product cannot overflow, and decoded once. This replaces a
+ * double-width multiply and a division with three clz-based encodes.
+ *
+ * The result is truncated like integer division and saturates to the
+ * maximum of u##hbits, which is also the result of a division by zero
+ * (unless a or b is 0). There are no data-dependent branches outside the
+ * encoders and the decoder: zero and saturation are clamped to the 'log'
+ * range beforehand (__intfp_muldiv_clamp()).
+ * Relative error bounds for u32/u64 results >= 2^16, measured over random
+ * operands of every magnitude: level 0 (no correction) 12.5%, level 1
+ * (_corr) 1.8%, level 2 0.28%, level 3 0.005%. Smaller results add the
+ * truncation error of 1/result. u16 goes through log16, whose 11 fractional
+ * bits limit level 3 to 0.12% (results >= 2^12).
+ * @param hbits The bit-width of the operands and result (16, 32, 64).
+ * @param lbits The bit-width of the intermediate 'log' type.
+ */
+#define INTFP_DECL_MULDIV(hbits, lbits) \
+/** \
+ * @brief Computes a * b / c approximately, with a correction level. \
+ * @param level 0 = uncorrected 'log', 1 = _corr, 2 = exact LUT, \
+ *              3 = exact LUT with interpolation. \
+ */ \
+INTFP_API __intfp_flatten u##hbits u##hbits##_muldiv_corr_n(u##hbits a, u##hbits b, u##hbits c, u8 level) { \
+	const u8 fp = INTFP_LOG_FPMAX(hbits, lbits); \
+	const s64 lim = (s64)hbits << fp; \
+	/* c == 0 encodes to intfp_log_0(), far below -lim: the sum saturates */ \
+	s64 r = (s64)u##hbits##_to_log##lbits##fp_corr_n(a, fp, level) + \
+		u##hbits##_to_log##lbits##fp_corr_n(b, fp, level) - \
+		u##hbits##_to_log##lbits##fp_corr_n(c, fp, level); \
+	u##hbits sat = -(u##hbits)(r >= lim); \
+	r = __intfp_muldiv_clamp(r, lim - 1, intfp_log_0(lbits), (a == 0) | (b == 0)); \
+	return log##lbits##fp_to_u##hbits##_corr_n((s##lbits)r, fp, level) | sat; \
+} \
+/** @brief Computes a * b / c approximately (uncorrected, fastest). */ \
+INTFP_API __intfp_flatten u##hbits u##hbits##_muldiv(u##hbits a, u##hbits b, u##hbits c) { \
+	return u##hbits##_muldiv_corr_n(a, b, c, 0); \
+} \
+/** @brief Computes a * b / c approximately with the _corr correction. */ \
+INTFP_API __intfp_flatten u##hbits u##hbits##_muldiv_corr(u##hbits a, u##hbits b, u##hbits c) { \
+	return u##hbits##_muldiv_corr_n(a, b, c, 1); \
+} \
+/** \
+ * @brief Computes dst[i] = a[i] * b[i] / c[i] approximately for an array. \
+ * Works in chunks of 256 on the stack: the operands go through the batch \
+ * encoders, are combined in a plain loop and decoded by the batch decoder, \
+ * so the SIMD kernels are used where available. Same results as the \
+ * scalar u##hbits##_muldiv_corr_n(). \
+ */ \
+INTFP_API void u##hbits##_muldiv_corr_n_array(u##hbits *dst, const u##hbits *a, \
+		const u##hbits *b, const u##hbits *c, size_t n, u8 level) { \
+	const u8 fp = INTFP_LOG_FPMAX(hbits, lbits); \
+	const s64 lim = (s64)hbits << fp; \
+	s##lbits la[256], lb[256], lc[256]; \
+	u8 sat[256]; \
+	for (size_t off = 0; off < n; off += 256) { \
+		size_t m = (n - off < 256) ? n - off : 256; \
+		u##hbits##fp_to_log##lbits##fp_corr_n_array(la, a + off, m, 0, fp, level); \
+		u##hbits##fp_to_log##lbits##fp_corr_n_array(lb, b + off, m, 0, fp, level); \
+		u##hbits##fp_to_log##lbits##fp_corr_n_array(lc, c + off, m, 0, fp, level); \
+		for (size_t i = 0; i < m; i++) { \
+			s64 r = (s64)la[i] + lb[i] - lc[i]; \
+			sat[i] = r >= lim; \
+			la[i] = (s##lbits)__intfp_muldiv_clamp(r, lim - 1, intfp_log_0(lbits), \
+				(la[i] == intfp_log_0(lbits)) | (lb[i] == intfp_log_0(lbits))); \
+		} \
+		log##lbits##fp_to_u##hbits##fp_corr_n_array(dst + off, la, m, fp, 0, level); \
+		for (size_t i = 0; i < m; i++) \
+			dst[off + i] |= -(u##hbits)sat[i]; \
+	} \
+}
+
+/* Generate muldiv for u16 (via log16), u32 (via log32) and u64 (via log32) */
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_MULDIV) && defined(INTFP_WITH_16_16))
+INTFP_DECL_MULDIV(16, 16)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_MULDIV) && defined(INTFP_WITH_32_32))
+INTFP_DECL_MULDIV(32, 32)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_MULDIV) && defined(INTFP_WITH_64_32))
+INTFP_DECL_MULDIV(64, 32)
+#endif
+
+/*
+ * Full-width unsigned products: returns the high half and stores the low
+ * half. The 64-bit one uses unsigned __int128 (a single mul on x86-64) and
+ * falls back to four 32-bit partial products.
+ */
+INTFP_API u32 __intfp_mul_wide32(u32 a, u32 b, u32 *lo) {
+	u64 p = (u64)a * b;
+	*lo = (u32)p;
+	return (u32)(p >> 32);
+}
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 __intfp_u128;
+#endif
+INTFP_API u64 __intfp_mul_wide64(u64 a, u64 b, u64 *lo) {
+#ifdef __SIZEOF_INT128__
+	__intfp_u128 p = (__intfp_u128)a * b;
+	*lo = (u64)p;
+	return (u64)(p >> 64);
+#else
+	u64 ll = (a & 0xffffffff) * (b & 0xffffffff), lh = (a & 0xffffffff) * (b >> 32);
+	u64 hl = (a >> 32) * (b & 0xffffffff), hh = (a >> 32) * (b >> 32);
+	u64 mid = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+	*lo = (mid << 32) | (ll & 0xffffffff);
+	return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+/**
+ * @brief Generates exact division by a precomputed reciprocal.
+ * u##bits##_recip_init() normalizes the divisor to bn = b << clz(b) and
+ * computes m = floor(2^(2*bits-1) / bn): the 'log' domain gives the seed
+ * (-log(bn), _corr_n level 2, about 10 bits), Newton steps
+ * m += m * (1 - bn * m) double the correct bits, and a last exact
+ * multiply-and-correct step removes the truncation error of the steps.
+ * u##bits##_div_recip() is then one high multiply, a shift and one
+ * multiply-and-correct step, since the estimate is low by at most one.
+ *
+ * Division by zero saturates to the maximum of u##bits, like the other
+ * saturating functions. Setting up the reciprocal costs more than one
+ * hardware division; it pays off when the divisor is reused (weights,
+ * capacities, a column divided by one value).
+ * @param bits The bit-width of the operands (32, 64).
+ * @param lbits The bit-width of the 'log' type of the seed.
+ * @param steps The number of Newton steps from the seed.
+ */
+#define INTFP_DECL_DIV(bits, lbits, steps) \
+/** \
+ * @struct u##bits##_recip \
+ * @brief A divisor prepared for exact division by multiplication. \
+ */ \
+struct u##bits##_recip { \
+	u##bits b;   /**< The divisor. */ \
+	u##bits m;   /**< floor(2^(2*bits-1) / normalized divisor), at most the max. */ \
+	u##bits sat; /**< All ones for a zero divisor. */ \
+	u8 sh;       /**< bits-1 - clz(b): shift of the high product. */ \
+}; \
+\
+/** @brief Prepares the divisor b for u##bits##_div_recip(). */ \
+INTFP_API struct u##bits##_recip u##bits##_recip_init(u##bits b) { \
+	const u8 fp = INTFP_LOG_FPMAX(bits, lbits); \
+	u8 l = __intfp_clz(b | 1, bits); \
+	u##bits bn = b << l, lo, hi, t; \
+	/* log(2^(2*bits-1) / bn); the top value 2^(lbits-1) (bn = 2^(bits-1)) \
+	 * is one past the 'log' range and is taken down by one */ \
+	s64 lr = ((s64)(2 * bits - 1) << fp) - u##bits##_to_log##lbits##fp_corr_n(bn, fp, 2); \
+	lr -= lr >> (lbits - 1); \
+	u##bits m = log##lbits##fp_to_u##bits##_corr_n((s##lbits)lr, fp, 2); \
+	for (int i = 0; i < (steps); i++) { \
+		/* e = (2^(2*bits-1) - bn * m) / 2^bits, m += m * e / 2^(bits-1) */ \
+		hi = __intfp_mul_wide##bits(bn, m, &lo); \
+		s##bits e = (s##bits)(((u##bits)1 << (bits-1)) - hi - (lo != 0)); \
+		u##bits neg = -(u##bits)(e < 0); \
+		hi = __intfp_mul_wide##bits(m, ((u##bits)e ^ neg) - neg, &lo); \
+		t = (hi << 1) | (lo >> (bits-1)); \
+		m += (t ^ neg) - neg; \
+	} \
+	/* The steps truncate downwards: raise m while bn * (m + 1) still fits */ \
+	for (int i = 0; i < 2; i++) { \
+		hi = __intfp_mul_wide##bits(bn, m, &lo); \
+		u##bits e_hi = ((u##bits)1 << (bits-1)) - hi - (lo != 0); \
+		m += ((e_hi != 0) | (-lo >= bn)) & (m != intfp_unsigned_max(bits)); \
+	} \
+	struct u##bits##_recip r = { b, m, -(u##bits)(b == 0), (u8)(bits - 1 - l) }; \
+	return r; \
+} \
+/** @brief Computes a / r->b exactly. */ \
+INTFP_API u##bits u##bits##_div_recip(u##bits a, const struct u##bits##_recip *r) { \
+	u##bits lo, q = __intfp_mul_wide##bits(a, r->m, &lo) >> r->sh; \
+	q += (a - q * r->b) >= r->b; \
+	return q | r->sat; \
+} \
+/** @brief Divides an array by the same prepared divisor. */ \
+INTFP_API void u##bits##_div_recip_array(u##bits *dst, const u##bits *src, size_t n, \
+		const struct u##bits##_recip *r) { \
+	/* A local copy: stores to dst could otherwise alias *r */ \
+	const struct u##bits##_recip rc = *r; \
+	for (size_t i = 0; i < n; i++) \
+		dst[i] = u##bits##_div_recip(src[i], &rc); \
+} \
+/** \
+ * @brief Computes a / b exactly through a 'log'-seeded reciprocal. \
+ * Slower than a hardware divider on current x86 cores; meant for targets \
+ * without a fast one. Prefer u##bits##_recip_init() for repeated divisors. \
+ */ \
+INTFP_API u##bits u##bits##_div_exact(u##bits a, u##bits b) { \
+	struct u##bits##_recip r = u##bits##_recip_init(b); \
+	return u##bits##_div_recip(a, &r); \
+}
+
+/* Generate exact division for u32 and u64 (seeded via log32) */
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_DIV) && defined(INTFP_WITH_32_32))
+INTFP_DECL_DIV(32, 32, 2)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_DIV) && defined(INTFP_WITH_64_32))
+INTFP_DECL_DIV(64, 32, 3)
+#endif
+
+/**
+ * @brief Generates integer square and cube roots seeded in the 'log' domain.
+ * A root is a shift (log / 2) or a division by a constant (log / 3) of the
+ * 'log' value. The exact roots decode that estimate (_corr_n level 2, within
+ * about 0.12% plus the truncation to an integer), raise it by a margin so
+ * that it is not below the root, and finish with integer Newton steps
+ *   sqrt: s = (s + v / s) / 2,   cbrt: s = (2 * s + v / s^2) / 3,
+ * which never go below the root when started above it. A step may jump
+ * back up once it reaches the root, so each keeps the smaller value. The
+ * number of steps follows from the seed error (quadratic convergence); one
+ * last comparison takes off the remaining +1. The _approx variants skip the Newton steps
+ * and return the _corr estimate (about 1%).
+ * @param bits The bit-width of the operand (32, 64).
+ * @param lbits The bit-width of the intermediate 'log' type.
+ * @param sqrt_steps, cbrt_steps The number of Newton steps.
+ */
+#define INTFP_DECL_ROOT(bits, lbits, sqrt_steps, cbrt_steps) \
+/** @brief Computes floor(sqrt(v)) exactly. */ \
+INTFP_API u##bits u##bits##_isqrt(u##bits v) { \
+	const u8 fp = INTFP_LOG_FPMAX(bits, lbits); \
+	const u##bits top = ((u##bits)1 << (bits / 2)) - 1; \
+	if (v == 0) return 0; \
+	s##lbits l = u##bits##_to_log##lbits##fp_corr_n(v, fp, 2); \
+	u##bits s = log##lbits##fp_to_u##bits##_corr_n(l >> 1, fp, 2); \
+	s += (s >> 9) + 1; \
+	for (int i = 0; i < (sqrt_steps); i++) { \
+		u##bits t = (s + v / s) >> 1; \
+		s = (t < s) ? t : s; \
+	} \
+	s = (s < top) ? s : top; \
+	return s - (s * s > v); \
+} \
+/** @brief Computes floor(cbrt(v)) exactly. */ \
+INTFP_API u##bits u##bits##_icbrt(u##bits v) { \
+	const u8 fp = INTFP_LOG_FPMAX(bits, lbits); \
+	const u##bits top = ((bits) == 64) ? 2642245 : 1625; \
+	if (v == 0) return 0; \
+	s##lbits l = u##bits##_to_log##lbits##fp_corr_n(v, fp, 2); \
+	u##bits s = log##lbits##fp_to_u##bits##_corr_n(l / 3, fp, 2); \
+	s += (s >> 9) + 1; \
+	for (int i = 0; i < (cbrt_steps); i++) { \
+		u##bits t = (2 * s + v / (s * s)) / 3; \
+		s = (t < s) ? t : s; \
+	} \
+	s = (s < top) ? s : top; \
+	return s - (s * s * s > v); \
+} \
+/** @brief Approximates sqrt(v) from the corrected 'log' (about 1%). */ \
+INTFP_API u##bits u##bits##_isqrt_approx(u##bits v) { \
+	const u8 fp = INTFP_LOG_FPMAX(bits, lbits); \
+	s##lbits l = u##bits##_to_log##lbits##fp_corr(v, fp); \
+	/* log_0 / 2 is still far below 0 and decodes to 0 */ \
+	return log##lbits##fp_to_u##bits##_corr(l >> 1, fp); \
+} \
+/** @brief Approximates cbrt(v) from the corrected 'log' (about 1%). */ \
+INTFP_API u##bits u##bits##_icbrt_approx(u##bits v) { \
+	const u8 fp = INTFP_LOG_FPMAX(bits, lbits); \
+	s##lbits l = u##bits##_to_log##lbits##fp_corr(v, fp); \
+	return log##lbits##fp_to_u##bits##_corr(l / 3, fp); \
+}
+
+/* Generate roots for u32 and u64 (via log32) */
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_ROOT) && defined(INTFP_WITH_32_32))
+INTFP_DECL_ROOT(32, 32, 1, 1)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_ROOT) && defined(INTFP_WITH_64_32))
+INTFP_DECL_ROOT(64, 32, 2, 2)
+#endif
+
+/**
+ * @brief Generates fixed-point powers, roots and reciprocals through 'log'.
+ * Each function encodes the operand with _corr_n at the given level,
+ * applies the log##lbits##_pow_q() family and decodes once. This replaces
+ * pow() where no FPU is available: for example a gamma of 1/2.2 on a Q8
+ * value is u32fp_pow_q(v, 8, 29789, 16, 3). The error is that of one
+ * encode and one decode at the level (below 0.6% at level 1, 0.01% at
+ * level 3 for u32/u64), scaled by the exponent for the encode side.
+ * @param hbits The bit-width of the fixed-point operand (16, 32, 64).
+ * @param lbits The bit-width of the intermediate 'log' type.
+ */
+#define INTFP_DECL_POW(hbits, lbits) \
+/** @brief Computes v^(e / 2^qfp); v and the result have fp fractional bits. */ \
+INTFP_API u##hbits u##hbits##fp_pow_q(u##hbits v, u8 fp, s32 e, u8 qfp, u8 level) { \
+	const u8 lfp = INTFP_LOG_FPMAX(hbits, lbits); \
+	s##lbits l = u##hbits##fp_to_log##lbits##fp_corr_n(v, fp, lfp, level); \
+	return log##lbits##fp_to_u##hbits##fp_corr_n(log##lbits##_pow_q(l, e, qfp), lfp, fp, level); \
+} \
+/** @brief Computes the n-th root of v; v and the result have fp fractional bits. */ \
+INTFP_API u##hbits u##hbits##fp_root(u##hbits v, u8 fp, u8 n, u8 level) { \
+	const u8 lfp = INTFP_LOG_FPMAX(hbits, lbits); \
+	s##lbits l = u##hbits##fp_to_log##lbits##fp_corr_n(v, fp, lfp, level); \
+	return log##lbits##fp_to_u##hbits##fp_corr_n(log##lbits##_root(l, n), lfp, fp, level); \
+} \
+/** @brief Computes 1 / v; v has ifp and the result ofp fractional bits. */ \
+INTFP_API u##hbits u##hbits##fp_recip(u##hbits v, u8 ifp, u8 ofp, u8 level) { \
+	const u8 lfp = INTFP_LOG_FPMAX(hbits, lbits); \
+	s##lbits l = u##hbits##fp_to_log##lbits##fp_corr_n(v, ifp, lfp, level); \
+	return log##lbits##fp_to_u##hbits##fp_corr_n(log##lbits##_recip(l), lfp, ofp, level); \
+} \
+/** @brief Computes 1 / sqrt(v); v has ifp and the result ofp fractional bits. */ \
+INTFP_API u##hbits u##hbits##fp_rsqrt(u##hbits v, u8 ifp, u8 ofp, u8 level) { \
+	const u8 lfp = INTFP_LOG_FPMAX(hbits, lbits); \
+	s##lbits l = u##hbits##fp_to_log##lbits##fp_corr_n(v, ifp, lfp, level); \
+	return log##lbits##fp_to_u##hbits##fp_corr_n(log##lbits##_rsqrt(l), lfp, ofp, level); \
+}
+
+/* Generate powers for u16 (via log16), u32 (via log32) and u64 (via log32) */
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_POW) && defined(INTFP_WITH_16_16))
+INTFP_DECL_POW(16, 16)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_POW) && defined(INTFP_WITH_32_32))
+INTFP_DECL_POW(32, 32)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_POW) && defined(INTFP_WITH_64_32))
+INTFP_DECL_POW(64, 32)
+#endif
+
+/**
+ * @brief Generates power-law transforms of full-scale u##bits samples.
+ * Pixel and audio samples stand for v / max, so a gamma of 1/2.2 maps v to
+ * max * (v / max)^(1/2.2). u##bits##_pow_norm() computes one sample through
+ * u64fp_pow_q() at level 3; for whole planes, a table of every input is
+ * built once (256 entries for u8, 65536 for u16) and applied with
+ * u##bits##_pow_lut_array(), which is cheaper from a few thousand (u8) or
+ * about 64K (u16) samples on.
+ * @param bits The sample width (8 or 16).
+ */
+#define INTFP_DECL_POW_LUT(bits) \
+/** \
+ * @brief Computes max * (v / max)^(e / 2^qfp), rounded; max is the largest u##bits. \
+ * Zero stays zero for positive powers, and results above max saturate. \
+ */ \
+INTFP_API u##bits u##bits##_pow_norm(u##bits v, s32 e, u8 qfp) { \
+	const u64 max = intfp_unsigned_max(bits), one = (u64)1 << 32; \
+	/* v / max in Q32; max divides 2^32 - 1, so only v == max needs the +1 */ \
+	u64 x = v * (0xffffffffull / max) + (v == max); \
+	u64 y = u64fp_pow_q(x, 32, e, qfp, 3); \
+	y = y < one ? y : one; \
+	return (u##bits)((y * max + (one >> 1)) >> 32); \
+} \
+/** @brief A power law tabulated for every u##bits input. */ \
+struct u##bits##_pow_lut { \
+	u##bits t[(size_t)1 << bits]; \
+}; \
+/** @brief Fills lut with u##bits##_pow_norm(v, e, qfp) for every v. */ \
+INTFP_API void u##bits##_pow_lut_init(struct u##bits##_pow_lut *lut, s32 e, u8 qfp) { \
+	for (size_t v = 0; v < ((size_t)1 << bits); v++) \
+		lut->t[v] = u##bits##_pow_norm((u##bits)v, e, qfp); \
+} \
+/** \
+ * @brief Applies a tabulated power law to n samples: dst[i] = lut->t[src[i]]. \
+ * dst may be src (in place); other overlaps are not allowed. \
+ */ \
+INTFP_API void u##bits##_pow_lut_array(u##bits *dst, const u##bits *src, size_t n, \
+		const struct u##bits##_pow_lut *lut) { \
+	size_t i = __intfp_simd_pow_lut##bits(dst, src, n, lut->t); \
+	for (; i < n; i++) \
+		dst[i] = lut->t[src[i]]; \
+}
+
+/* SIMD lookups of the power-law tables: byte tables for u8, gathers for u16 */
+#define __intfp_simd_pow_lut8(dst, src, n, t) __intfp_simd_lut8(dst, src, n, t, 1)
+#define __intfp_simd_pow_lut16(dst, src, n, t) __intfp_simd_lut16(dst, src, n, t)
+
+/* Generate power-law tables for u8 and u16 samples (computed via u64fp_pow_q) */
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_POW) && defined(INTFP_WITH_64_32))
+INTFP_DECL_POW_LUT(8)
+INTFP_DECL_POW_LUT(16)
+#endif
+
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_LOG_ADD)
+/**
+ * @brief Gaussian logarithm tables for log-domain addition and subtraction.
+ *
+ * With d = |a - b| >= 0, the sum and difference of two log2 values are
+ *   log2(2^a + 2^b) = max(a, b) + sb(d),  sb(d) =  log2(1 + 2^-d)
+ *   log2(2^a - 2^b) = a + db(d) (a > b),  db(d) =  log2(1 - 2^-d)
+ * Both are stored in Q1.15 (they reach 1.0 at their first entry) with a
+ * step of 1/16 and a 257th entry for linear interpolation, as the exact
+ * correction tables above. Beyond the last entry, |sb| and |db| are below
+ * 2^-15 and are taken as 0.
+ *
+ * add: lut[i] = round( log2(1 + 2^-(i/16))     * 32768),  d in [0, 16]
+ * sub: lut[i] = round(-log2(1 - 2^-(2 + i/16)) * 32768),  d in [2, 18]
+ *
+ * db(d) diverges as d -> 0, so d < 2 is computed from the exact tables.
+ */
+__INTFP_TABLE u16 __intfp_log_add_lut[257] __intfp_table_init({
+	32768, 31755, 30764, 29796, 28849, 27925, 27022, 26141, 25282, 24445, 23628, 22833, 22059, 21306, 20573, 19861,
+	19168, 18495, 17842, 17207, 16592, 15995, 15416, 14855, 14311, 13785, 13275, 12782, 12305, 11843, 11397, 10966,
+	10549, 10146,  9758,  9382,  9020,  8671,  8334,  8009,  7695,  7393,  7102,  6822,  6552,  6292,  6041,  5800,
+	 5568,  5345,  5130,  4924,  4725,  4534,  4350,  4174,  4004,  3841,  3684,  3534,  3389,  3250,  3117,  2989,
+	 2866,  2748,  2635,  2526,  2421,  2321,  2225,  2133,  2044,  1959,  1878,  1800,  1725,  1653,  1584,  1518,
+	 1455,  1394,  1336,  1280,  1226,  1175,  1126,  1078,  1033,   990,   948,   909,   870,   834,   799,   765,
+	  733,   702,   673,   644,   617,   591,   566,   542,   519,   498,   477,   456,   437,   419,   401,   384,
+	  368,   352,   337,   323,   310,   296,   284,   272,   260,   249,   239,   229,   219,   210,   201,   192,
+	  184,   177,   169,   162,   155,   148,   142,   136,   130,   125,   120,   115,   110,   105,   101,    96,
+	   92,    88,    85,    81,    78,    74,    71,    68,    65,    62,    60,    57,    55,    53,    50,    48,
+	   46,    44,    42,    41,    39,    37,    36,    34,    33,    31,    30,    29,    27,    26,    25,    24,
+	   23,    22,    21,    20,    19,    19,    18,    17,    16,    16,    15,    14,    14,    13,    13,    12,
+	   12,    11,    11,    10,    10,     9,     9,     9,     8,     8,     7,     7,     7,     7,     6,     6,
+	    6,     6,     5,     5,     5,     5,     4,     4,     4,     4,     4,     4,     3,     3,     3,     3,
+	    3,     3,     3,     3,     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+	    1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+	    1,
+});
+__INTFP_TABLE u16 __intfp_log_sub_lut[257] __intfp_table_init({
+	13600, 12937, 12310, 11717, 11157, 10626, 10124,  9648,  9196,  8768,  8361,  7975,  7608,  7259,  6928,  6613,
+	 6313,  6027,  5755,  5497,  5250,  5015,  4791,  4578,  4375,  4181,  3996,  3819,  3651,  3490,  3337,  3191,
+	 3051,  2918,  2790,  2668,  2552,  2441,  2335,  2234,  2137,  2044,  1956,  1871,  1790,  1713,  1639,  1568,
+	 1501,  1436,  1374,  1315,  1259,  1205,  1153,  1104,  1056,  1011,   968,   926,   887,   849,   812,   778,
+	  744,   713,   682,   653,   625,   599,   573,   549,   525,   503,   481,   461,   441,   422,   404,   387,
+	  371,   355,   340,   325,   312,   298,   286,   274,   262,   251,   240,   230,   220,   211,   202,   193,
+	  185,   177,   170,   162,   156,   149,   143,   137,   131,   125,   120,   115,   110,   105,   101,    97,
+	   92,    89,    85,    81,    78,    74,    71,    68,    65,    63,    60,    57,    55,    53,    50,    48,
+	   46,    44,    42,    41,    39,    37,    36,    34,    33,    31,    30,    29,    27,    26,    25,    24,
+	   23,    22,    21,    20,    19,    19,    18,    17,    16,    16,    15,    14,    14,    13,    13,    12,
+	   12,    11,    11,    10,    10,     9,     9,     9,     8,     8,     7,     7,     7,     7,     6,     6,
+	    6,     6,     5,     5,     5,     5,     4,     4,     4,     4,     4,     4,     3,     3,     3,     3,
+	    3,     3,     3,     3,     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+	    1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+	    1,     1,     1,     1,     1,     1,     1,     1,     1,     0,     0,     0,     0,     0,     0,     0,
+	    0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+	    0,
+});
+
+/* Converts a Q1.15 table value to fp fractional bits, rounding to nearest. */
+#define __intfp_q15_to_fp(v, fp) ((fp) >= 15 ? \
+	(u64)(v) << ((fp) - 15) : \
+	((u64)(v) + (1U << (14 - (fp)))) >> (15 - (fp)))
+
+/* Table position of d (fp fractional bits) in 1/16 steps, 16-bit weight. */
+#define __intfp_log_add_pos(d, fp) ((fp) >= 20 ? \
+	(u32)((d) >> ((fp) - 20)) : (u32)((d) << (20 - (fp))))
+
+/* Interpolates a 257-entry exact table at a Q0.32 position, Q0.32 result. */
+#define __intfp_lut_interp32(lut, x) \
+	(((u32)(lut)[(x) >> 24] << 16) + (u32)((s32)((lut)[((x) >> 24) + 1] - \
+		(lut)[(x) >> 24]) * (s32)((x) & 0xffffff) >> 8))
+
+/**
+ * @brief sb(d) = log2(1 + 2^-d), the addition term of the Gaussian logarithm.
+ * @param d  The operand difference |a - b| with fp fractional bits.
+ * @param fp The number of fractional bits of d and of the result (0 to 57).
+ * @return sb(d) with fp fractional bits, 0 for d >= 16.
+ */
+INTFP_API u64 __intfp_log_sb(u64 d, u8 fp) {
+	if ((d >> fp) >= 16) return 0;
+	u32 p = __intfp_log_add_pos(d, fp);
+	return __intfp_q15_to_fp(
+		__intfp_lut_interp(__intfp_log_add_lut, p >> 16, p & 0xffff, 16), fp);
+}
+
+/**
+ * @brief db(d) = log2(1 - 2^-d), the subtraction term of the Gaussian logarithm.
+ * @param d  The operand difference a - b > 0 with fp fractional bits.
+ * @param fp The number of fractional bits of d and of the result (0 to 57).
+ * @return db(d) (<= 0) with fp fractional bits, 0 for d >= 18.
+ */
+INTFP_API s64 __intfp_log_db(u64 d, u8 fp) {
+	u64 i = d >> fp;
+	if (i >= 18) return 0;
+	if (i >= 2) {
+		u32 p = __intfp_log_add_pos(d - ((u64)2 << fp), fp);
+		return -(s64)__intfp_q15_to_fp(
+			__intfp_lut_interp(__intfp_log_sub_lut, p >> 16, p & 0xffff, 16), fp);
+	}
+	/*
+	 * d < 2: db(d) = log2(2^d - 1) - d, in Q32, with 2^d - 1 = 2^e (1 + m).
+	 * 2^f = 1 + f - dec(f) comes from the exact table, but loses its relative
+	 * precision as 2^d - 1 approaches 0, so below 1/4 it is d ln2 q instead,
+	 * with the series q = 1 + t/2(1 + t/3(1 + t/4(1 + t/5))), t = d ln2, normalized
+	 * from d itself to keep the precision of fp > 32. log2(1 + m) = m + enc(m).
+	 */
+	u64 x = (fp >= 32) ? d >> (fp - 32) : d << (32 - fp);
+	s32 e;
+	u32 m;
+	if (x >> 30) {
+		u32 f = (u32)x;
+		u64 y = (((1ULL << 32) + f - __intfp_lut_interp32(__intfp_dec_corr_exact_lut, f))
+			<< (x >> 32)) - (1ULL << 32);
+		u8 n = __builtin_clzll(y);
+		e = 31 - n;
+		m = (u32)(((y << n) << 1) >> 32);
+	} else {
+		u64 t = x * 0xB17217F8 >> 32, q = 1ULL << 32;
+		q = (1ULL << 32) + (t * q >> 32) / 5;
+		q = (1ULL << 32) + (t * q >> 32) / 4;
+		q = (1ULL << 32) + (t * q >> 32) / 3;
+		q = (1ULL << 32) + (t * q >> 32) / 2;
+		u8 nd = __builtin_clzll(d);
+		/* (d normalized, Q1.31) * (ln2 q, Q0.32): in [0.69, 1.52), Q1.63 */
+		u64 p = ((d << nd) >> 32) * (0xB17217F8 * q >> 32);
+		u8 np = __builtin_clzll(p);
+		e = 63 - nd - fp - np;
+		m = (u32)(((p << np) << 1) >> 32);
+	}
+	s64 r = (s64)e * ((s64)1 << 32) + m +
+		__intfp_lut_interp32(__intfp_enc_corr_exact_lut, m) - (s64)x;
+	return (fp >= 32) ? (s64)((u64)r << (fp - 32)) :
+		(r + ((s64)1 << (31 - fp))) >> (32 - fp);
+}
+
+/**
+ * @brief Generates log-domain addition and subtraction for one 'log' width.
+ * Sums stay in 'log' form instead of a decode -> add -> encode round trip.
+ * The operands are treated as log2 values with fp fractional bits, so the
+ * accuracy of a result is that of the operands: use _corr or _corr_n encodings
+ * when the sums must match the linear ones closely.
+ * @param bits The bit-width of the 'log' type (8, 16, 32, 64).
+ */
+#define INTFP_DECL_LOG_BITS(bits) \
+/** \
+ * @brief Log-domain addition: returns log2(2^a + 2^b). \
+ * @param a, b The 'log' operands. intfp_log_0() (zero) is the identity. \
+ * @param fp The number of fractional bits of a, b and the result (0 to 57). \
+ * @return The 'log' of the sum, saturated at the largest 'log' value. \
+ */ \
+INTFP_API s##bits log##bits##fp_add(s##bits a, s##bits b, u8 fp) { \
+	s##bits hi = (a > b) ? a : b, lo = (a > b) ? b : a; \
+	if (lo == intfp_log_0(bits)) return hi; \
+	u64 sb = __intfp_log_sb((u##bits)((u##bits)hi - (u##bits)lo), fp); \
+	/* Saturate instead of wrapping past the largest value */ \
+	if (sb > (u##bits)((u##bits)intfp_signed_max(bits) - (u##bits)hi)) \
+		return intfp_signed_max(bits); \
+	return (s##bits)(hi + (s##bits)sb); \
+} \
+/** \
+ * @brief Log-domain subtraction: returns log2(2^a - 2^b), clamped at zero. \
+ * @param a, b The 'log' operands. \
+ * @param fp The number of fractional bits of a, b and the result (0 to 57). \
+ * @return The 'log' of the difference; intfp_log_0() if a <= b. \
+ */ \
+INTFP_API s##bits log##bits##fp_sub(s##bits a, s##bits b, u8 fp) { \
+	if (b == intfp_log_0(bits)) return a; \
+	if (a <= b) return intfp_log_0(bits); \
+	s64 db = __intfp_log_db((u##bits)((u##bits)a - (u##bits)b), fp); \
+	/* Saturate to zero instead of wrapping past log_0 */ \
+	if ((u64)-db >= (u##bits)((u##bits)a - (u##bits)intfp_log_0(bits))) \
+		return intfp_log_0(bits); \
+	return (s##bits)(a + db); \
+}
+
+/* Generate log-domain addition and subtraction for 8, 16, 32, and 64-bit 'log' */
+INTFP_DECL_LOG_BITS(8)
+INTFP_DECL_LOG_BITS(16)
+INTFP_DECL_LOG_BITS(32)
+INTFP_DECL_LOG_BITS(64)
+#endif
+
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_SLOG)
+/**
+ * @brief Generates the 'slog' arithmetic of one width.
+ * All operations are branch-free. Magnitudes saturate instead of wrapping:
+ * a result too large for the format becomes the largest magnitude, one too
+ * small becomes intfp_slog_0().
+ * @param bits The bit-width of the 'slog' type (8, 16, 32, 64).
+ */
+#define INTFP_DECL_SLOG_BITS(bits) \
+/** \
+ * @brief Multiplies two 'slog' values: XORs the signs, adds the magnitudes. \
+ * @return The 'slog' product; intfp_slog_0() if either operand is 0. \
+ */ \
+INTFP_API s##bits slog##bits##_mul(s##bits a, s##bits b) { \
+	u##bits ma = (u##bits)a & ~(u##bits)1, mb = (u##bits)b & ~(u##bits)1; \
+	u##bits r = ma + mb; \
+	/* Signed overflow: both operands have the sign the result lacks */ \
+	u##bits ovf = -(u##bits)((s##bits)((ma ^ r) & (mb ^ r)) < 0); \
+	u##bits neg = -(u##bits)((s##bits)ma < 0); \
+	u##bits big = ovf & ~neg; \
+	u##bits zero = -(u##bits)((a == intfp_slog_0(bits)) | (b == intfp_slog_0(bits)) | \
+		(r == (u##bits)intfp_slog_0(bits))) | (ovf & neg); \
+	r = (r & ~big) | ((u##bits)intfp_signed_max(bits) & ~(u##bits)1 & big); \
+	r |= (a ^ b) & 1; \
+	return (s##bits)((r & ~zero) | (zero & (u##bits)intfp_slog_0(bits))); \
+} \
+/** \
+ * @brief Divides two 'slog' values: XORs the signs, subtracts the magnitudes. \
+ * @return The 'slog' quotient; intfp_slog_0() if a is 0, and the largest \
+ *         magnitude (with the sign of a) if only b is 0. \
+ */ \
+INTFP_API s##bits slog##bits##_div(s##bits a, s##bits b) { \
+	u##bits ma = (u##bits)a & ~(u##bits)1, mb = (u##bits)b & ~(u##bits)1; \
+	u##bits r = ma - mb; \
+	/* Signed overflow: the operands' signs differ and the result has b's */ \
+	u##bits ovf = -(u##bits)((s##bits)((ma ^ mb) & (ma ^ r)) < 0); \
+	u##bits neg = -(u##bits)((s##bits)ma < 0); \
+	u##bits azero = -(u##bits)(a == intfp_slog_0(bits)); \
+	u##bits bzero = -(u##bits)(b == intfp_slog_0(bits)); \
+	u##bits big = ((ovf & ~neg) | bzero) & ~azero; \
+	u##bits zero = azero | (ovf & neg & ~bzero) | \
+		(-(u##bits)(r == (u##bits)intfp_slog_0(bits)) & ~big); \
+	r = (r & ~big) | ((u##bits)intfp_signed_max(bits) & ~(u##bits)1 & big); \
+	r |= (a ^ (b & ~bzero)) & 1; \
+	return (s##bits)((r & ~zero) | (zero & (u##bits)intfp_slog_0(bits))); \
+} \
+/** @brief Negates a 'slog' value (0 stays 0). */ \
+INTFP_API s##bits slog##bits##_neg(s##bits v) { \
+	return (s##bits)(v ^ (v != intfp_slog_0(bits))); \
+} \
+/** @brief Returns the absolute value of a 'slog' value. */ \
+INTFP_API s##bits slog##bits##_abs(s##bits v) { \
+	return (s##bits)(v & ~(s##bits)1); \
+}
+
+/* Generate 'slog' arithmetic for 8, 16, 32, and 64-bit 'slog' */
+INTFP_DECL_SLOG_BITS(8)
+INTFP_DECL_SLOG_BITS(16)
+INTFP_DECL_SLOG_BITS(32)
+INTFP_DECL_SLOG_BITS(64)
+#endif
 
 /**
  * @brief Generates Exponentially Weighted Moving Average (EWMA) functions.
@@ -730,7 +2196,7 @@ INTFP_DECL_IBITS_OBITS(64,64)
  * @param damper The damping factor (divisor). A higher value means slower changes. \
  * @return The updated average. \
  */ \
-s##bits ewma_s##bits##fp_div(s##bits new, s##bits old, \
+INTFP_API s##bits ewma_s##bits##fp_div(s##bits new, s##bits old, \
 		s##bits bottom_limit, u##bits damper) { \
 	u##bits abs_diff, adj_diff; \
 	if (damper <= 1) return new; \
@@ -751,7 +2217,7 @@ s##bits ewma_s##bits##fp_div(s##bits new, s##bits old, \
  * @param damper The damping factor (shift amount). A higher value means slower changes. \
  * @return The updated average. \
  */ \
-s##bits ewma_s##bits##fp_shr(s##bits new, s##bits old, \
+INTFP_API s##bits ewma_s##bits##fp_shr(s##bits new, s##bits old, \
 		s##bits bottom_limit, u8 damper) { \
 	u##bits abs_diff, adj_diff; \
 	if (damper <= 1) return new; \
@@ -763,10 +2229,12 @@ s##bits ewma_s##bits##fp_shr(s##bits new, s##bits old, \
 	return (new > old) ? (old + adj_diff) : (old - adj_diff); \
 }
 /* Generate EWMA functions for 8, 16, 32, and 64-bit signed integers */
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_EWMA)
 INTFP_DECL_BITS(8)
 INTFP_DECL_BITS(16)
 INTFP_DECL_BITS(32)
 INTFP_DECL_BITS(64)
+#endif
 
 /**
  * @enum u32fp_radix_type
@@ -789,10 +2257,11 @@ struct u32fp_radix {
 	u8  from_shr; /**< Number of fractional bits in the 'from' constant. */
 };
 
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_RADIX)
 /**
  * @brief Table of pre-calculated conversion constants for different logarithmic bases.
  */
-const struct u32fp_radix u32fp_radix_tbl[U32FP_RADIX_TYPE_COUNT] = {
+__INTFP_TABLE struct u32fp_radix u32fp_radix_tbl[U32FP_RADIX_TYPE_COUNT] __intfp_table_init({
 	[U32FP_RADIX_TYPE_DB_POWER] = {
 		.to   = 0xC0A8C129, .to_shr   = 30, /* Constant for converting to a dB-like scale */
 		.from = 0x550A9686, .from_shr = 32, /* Constant for converting from a dB-like scale */
@@ -801,7 +2270,8 @@ const struct u32fp_radix u32fp_radix_tbl[U32FP_RADIX_TYPE_COUNT] = {
 		.to   = 0xC6CD5A3B, .to_shr   = 30, /* Constant for converting to a log_1.25 scale */
 		.from = 0x5269E11A, .from_shr = 32, /* Constant for converting from a log_1.25 scale */
 	},
-};
+});
+#endif
 
 /**
  * @brief Generates functions to rescale 'log' values between base-2 and another radix.
@@ -816,7 +2286,7 @@ const struct u32fp_radix u32fp_radix_tbl[U32FP_RADIX_TYPE_COUNT] = {
  * @param type The target radix type from u32fp_radix_type. \
  * @return The rescaled 'log' value in the new base. \
  */ \
-s##bits rescale_log##bits##fp_to_radix(s##bits v, enum u32fp_radix_type type) { \
+INTFP_API s##bits rescale_log##bits##fp_to_radix(s##bits v, enum u32fp_radix_type type) { \
 	const struct u32fp_radix *radix = &u32fp_radix_tbl[type]; \
 	if (v == 0 || v == intfp_log_0(bits)) return v; \
 	bool negative = v < 0; \
@@ -832,7 +2302,7 @@ s##bits rescale_log##bits##fp_to_radix(s##bits v, enum u32fp_radix_type type) {
  * @param type The radix type of the input value. \
  * @return The rescaled 'log' value in base-2. \
  */ \
-s##bits rescale_log##bits##fp_from_radix(s##bits v, enum u32fp_radix_type type) { \
+INTFP_API s##bits rescale_log##bits##fp_from_radix(s##bits v, enum u32fp_radix_type type) { \
 	const struct u32fp_radix *radix = &u32fp_radix_tbl[type]; \
 	if (v == 0 || v == intfp_log_0(bits)) return v; \
 	bool negative = v < 0; \
@@ -842,8 +2312,10 @@ s##bits rescale_log##bits##fp_from_radix(s##bits v, enum u32fp_radix_type type)
 	return (s##bits)temp; \
 }
 /* Generate radix conversion functions for 8, 16, and 32-bit log types */
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_RADIX)
 INTFP_DECL_BITS_UP_TO_32(8)
 INTFP_DECL_BITS_UP_TO_32(16)
 INTFP_DECL_BITS_UP_TO_32(32)
+#endif
 
 #endif /* _INTFP_H */
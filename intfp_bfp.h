@@ -0,0 +1,302 @@
+#ifndef _INTFP_BFP_H
+#define _INTFP_BFP_H
+/*
+ * Integer-based Fixed-Point and Pseudo-Logarithmic Number Library (intfp)
+ * Block floating point: one exponent shared by a block of values
+ * Copyright (C) 2025 Masahito Suzuki
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * @file intfp_bfp.h
+ * @brief Block floating point: 8- or 16-bit mantissas with a shared exponent.
+ *
+ * @details
+ * Neighbouring samples of a smooth signal have nearly the same exponent, so
+ * storing one per value, as 'pul' does, is mostly redundant. Here each block
+ * of 16, 32 or 64 values stores one u8 shift s, and each value the mantissa
+ * v >> s in mbits (8 or 16) bits. s is the smallest shift that fits the
+ * largest value of the block, so that value keeps mbits significant bits and
+ * a value 2^k times smaller keeps mbits - k. Decoding gives man << s: the
+ * dropped low bits are truncated, as in 'pul'.
+ *
+ * Block b's shift is exps[b] and value i's mantissa is mans[i]. A last block
+ * of fewer values is allowed. The values are the same whatever the input
+ * width, so blocks encoded from u16 values decode to u64 and back, and
+ * convert to and from 'pul'/'log' codes through u64.
+ */
+
+#include "intfp.h"
+
+#define INTFP_BFP_BLOCK_MIN 16
+#define INTFP_BFP_BLOCK_MAX 64
+
+/** @brief Whether `block` is a block size the codec takes: 16, 32 or 64. */
+#define INTFP_BFP_BLOCK_OK(block) ((block) == 16 || (block) == 32 || (block) == 64)
+
+/** @brief Number of shared exponents of n values in blocks of `block`. */
+#define INTFP_BFP_EXPS(n, block) (((n) + (block) - 1) / (block))
+
+/* Values per chunk of the 'pul'/'log' conversions; a multiple of every block */
+#define __INTFP_BFP_CHUNK 256
+
+/* The shift that fits `bits` significant bits in mbits. */
+#define __intfp_bfp_shift(bits, mbits) ((u8)((bits) > (mbits) ? (bits) - (mbits) : 0))
+
+/* Significant bits of the largest value of a block, from their OR. */
+static inline unsigned __intfp_bfp_bits(u64 any) {
+	return any ? 64 - __builtin_clzll(any) : 0;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__) && \
+	!defined(__KERNEL__) && !defined(INTFP_NO_SIMD)
+/* Loads or stores exactly `bytes` (4, 8 or 16) bytes in the low part of a vector */
+static inline __attribute__((target("avx2"))) __m128i __intfp_avx2_bfp_load(const void *p,
+		unsigned bytes) {
+	u32 w;
+	switch (bytes) {
+	case 4: __builtin_memcpy(&w, p, 4); return _mm_cvtsi32_si128((int)w);
+	case 8: return _mm_loadl_epi64((const __m128i *)p);
+	default: return _mm_loadu_si128((const __m128i *)p);
+	}
+}
+static inline __attribute__((target("avx2"))) void __intfp_avx2_bfp_store(void *p, __m128i v,
+		unsigned bytes) {
+	u32 w;
+	switch (bytes) {
+	case 4: w = (u32)_mm_cvtsi128_si32(v); __builtin_memcpy(p, &w, 4); break;
+	case 8: _mm_storel_epi64((__m128i *)p, v); break;
+	default: _mm_storeu_si128((__m128i *)p, v); break;
+	}
+}
+
+/*
+ * Encodes and decodes whole blocks, 256 bits of values at a time. The
+ * block's OR is folded to one lane for its shift; encoding shifts every
+ * lane right by it and gathers the low mbits of each lane with one pshufb
+ * per 128-bit half, decoding zero-extends the mantissas and shifts left.
+ */
+#define __INTFP_BFP_AVX2(hbits, mbits) \
+static inline __attribute__((target("avx2"))) void __intfp_avx2_u##hbits##_to_bfp##mbits( \
+		u8 *exps, u##mbits *mans, const u##hbits *src, size_t nblk, u8 block) { \
+	enum { LANES = 256 / hbits, HALF = LANES / 2 * (mbits / 8) }; \
+	u8 ctl[32]; \
+	/* Each half puts its mantissas at the start (low half) or after them (high) */ \
+	for (unsigned b = 0; b < 16; b++) { \
+		unsigned k = b % HALF, e = k / (mbits / 8) * (hbits / 8) + k % (mbits / 8); \
+		ctl[b] = b < HALF ? (u8)e : 0x80; \
+		ctl[16 + b] = b >= HALF && b < 2 * HALF ? (u8)e : 0x80; \
+	} \
+	const __m256i c = _mm256_loadu_si256((const __m256i *)ctl); \
+	for (size_t k = 0; k < nblk; k++, src += block, mans += block) { \
+		__m256i any = _mm256_setzero_si256(); \
+		for (unsigned j = 0; j < block; j += LANES) \
+			any = _mm256_or_si256(any, _mm256_loadu_si256((const __m256i *)(src + j))); \
+		__m128i o = _mm_or_si128(_mm256_castsi256_si128(any), _mm256_extracti128_si256(any, 1)); \
+		o = _mm_or_si128(o, _mm_unpackhi_epi64(o, o)); \
+		u64 x = (u64)_mm_cvtsi128_si64(o); \
+		if (hbits < 64) x = (u32)(x | x >> 32); \
+		if (hbits < 32) x = (u16)(x | x >> 16); \
+		u8 s = __intfp_bfp_shift(__intfp_bfp_bits(x), mbits); \
+		const __m128i sv = _mm_cvtsi32_si128(s); \
+		exps[k] = s; \
+		for (unsigned j = 0; j < block; j += LANES) { \
+			__m256i v = _mm256_srl_epi##hbits( \
+				_mm256_loadu_si256((const __m256i *)(src + j)), sv); \
+			v = _mm256_shuffle_epi8(v, c); \
+			__intfp_avx2_bfp_store(mans + j, _mm_or_si128(_mm256_castsi256_si128(v), \
+				_mm256_extracti128_si256(v, 1)), 2 * HALF); \
+		} \
+	} \
+} \
+static inline __attribute__((target("avx2"))) size_t __intfp_avx2_bfp##mbits##_to_u##hbits( \
+		u##hbits *dst, const u8 *exps, const u##mbits *mans, size_t nblk, u8 block) { \
+	enum { LANES = 256 / hbits }; \
+	size_t k = 0; \
+	/* Stops at a block whose values may not fit u##hbits, to saturate them */ \
+	for (; k < nblk && exps[k] <= hbits - mbits; k++, dst += block, mans += block) { \
+		const __m128i sv = _mm_cvtsi32_si128(exps[k]); \
+		for (unsigned j = 0; j < block; j += LANES) { \
+			__m256i v = _mm256_cvtepu##mbits##_epi##hbits( \
+				__intfp_avx2_bfp_load(mans + j, LANES * (mbits / 8))); \
+			_mm256_storeu_si256((__m256i *)(dst + j), _mm256_sll_epi##hbits(v, sv)); \
+		} \
+	} \
+	return k * block; \
+}
+__INTFP_BFP_AVX2(16, 8)
+__INTFP_BFP_AVX2(32, 8)
+__INTFP_BFP_AVX2(64, 8)
+__INTFP_BFP_AVX2(32, 16)
+__INTFP_BFP_AVX2(64, 16)
+
+/* Runs the AVX2 kernel on the whole blocks; returns the values done */
+#define __intfp_bfp_enc_simd(hbits, mbits, exps, mans, src, nblk, block) \
+	(intfp_isa_get() >= INTFP_ISA_AVX2 ? (__intfp_avx2_u##hbits##_to_bfp##mbits( \
+		exps, mans, src, nblk, block), (nblk) * (block)) : 0)
+#define __intfp_bfp_dec_simd(hbits, mbits, dst, exps, mans, nblk, block) \
+	(intfp_isa_get() >= INTFP_ISA_AVX2 ? \
+		__intfp_avx2_bfp##mbits##_to_u##hbits(dst, exps, mans, nblk, block) : 0)
+#else
+#define __intfp_bfp_enc_simd(hbits, mbits, exps, mans, src, nblk, block) ((size_t)0)
+#define __intfp_bfp_dec_simd(hbits, mbits, dst, exps, mans, nblk, block) ((size_t)0)
+#endif
+
+#define INTFP_DECL_BFP(hbits, mbits) \
+/** \
+ * @brief Encodes n values as blocks of `block` mbits-bit mantissas. \
+ * @param exps Output, INTFP_BFP_EXPS(n, block) shifts. \
+ * @param mans Output, n mantissas. \
+ * @param block Values per shared exponent: 16, 32 or 64. \
+ * @return 0, or -1 if block is none of those. \
+ */ \
+INTFP_API int u##hbits##_to_bfp##mbits(u8 *exps, u##mbits *mans, const u##hbits *src, \
+		size_t n, u8 block) { \
+	if (!INTFP_BFP_BLOCK_OK(block)) \
+		return -1; \
+	size_t i = __intfp_bfp_enc_simd(hbits, mbits, exps, mans, src, n / block, block); \
+	for (; i < n; i += block) { \
+		size_t m = n - i < block ? n - i : block; \
+		u##hbits any = 0; \
+		for (size_t k = 0; k < m; k++) \
+			any |= src[i + k]; \
+		u8 s = __intfp_bfp_shift(__intfp_bfp_bits(any), mbits); \
+		exps[i / block] = s; \
+		for (size_t k = 0; k < m; k++) \
+			mans[i + k] = (u##mbits)(src[i + k] >> s); \
+	} \
+	return 0; \
+} \
+/** \
+ * @brief Decodes n values from blocks of `block` mbits-bit mantissas. \
+ * Values that do not fit u##hbits (from a wider input) saturate. \
+ * @return 0, or -1 if block is not 16, 32 or 64. \
+ */ \
+INTFP_API int bfp##mbits##_to_u##hbits(u##hbits *dst, const u8 *exps, const u##mbits *mans, \
+		size_t n, u8 block) { \
+	if (!INTFP_BFP_BLOCK_OK(block)) \
+		return -1; \
+	size_t i = __intfp_bfp_dec_simd(hbits, mbits, dst, exps, mans, n / block, block); \
+	for (; i < n; i += block) { \
+		size_t m = n - i < block ? n - i : block; \
+		/* The encoder never shifts further; a larger shift is damaged data */ \
+		u8 s = exps[i / block] < 64 - mbits ? exps[i / block] : 64 - mbits; \
+		for (size_t k = 0; k < m; k++) { \
+			u64 v = (u64)mans[i + k] << s; \
+			dst[i + k] = v > intfp_unsigned_max(hbits) ? intfp_unsigned_max(hbits) : (u##hbits)v; \
+		} \
+	} \
+	return 0; \
+}
+
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_8)
+INTFP_DECL_BFP(16, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_8)
+INTFP_DECL_BFP(32, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
+INTFP_DECL_BFP(64, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_16)
+INTFP_DECL_BFP(32, 16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+INTFP_DECL_BFP(64, 16)
+#endif
+
+/*
+ * Conversions between blocks and 'pul##lbits'/'log##lbits' codes of the same
+ * values, in chunks through u64 and the 64-bit array conversions. Like the
+ * block codec, each returns 0, or -1 (having written nothing) if block is not
+ * 16, 32 or 64.
+ */
+#define INTFP_DECL_BFP_CONV(mbits, lbits) \
+__intfp_if_pul( \
+/** @brief Converts n block values to 'pul##lbits' codes with ofp mantissa bits. */ \
+INTFP_API int bfp##mbits##_to_pul##lbits##fp(u##lbits *dst, const u8 *exps, \
+		const u##mbits *mans, size_t n, u8 block, u8 ofp) { \
+	u64 buf[__INTFP_BFP_CHUNK]; \
+	if (!INTFP_BFP_BLOCK_OK(block)) \
+		return -1; \
+	for (size_t i = 0; i < n; i += __INTFP_BFP_CHUNK) { \
+		size_t m = n - i < __INTFP_BFP_CHUNK ? n - i : __INTFP_BFP_CHUNK; \
+		bfp##mbits##_to_u64(buf, exps + i / block, mans + i, m, block); \
+		u64_to_pul##lbits##fp_array(dst + i, buf, m, ofp); \
+	} \
+	return 0; \
+} \
+/** @brief Converts n 'pul##lbits' codes with ifp mantissa bits to blocks. */ \
+INTFP_API int pul##lbits##fp_to_bfp##mbits(u8 *exps, u##mbits *mans, \
+		const u##lbits *src, size_t n, u8 block, u8 ifp) { \
+	u64 buf[__INTFP_BFP_CHUNK]; \
+	if (!INTFP_BFP_BLOCK_OK(block)) \
+		return -1; \
+	for (size_t i = 0; i < n; i += __INTFP_BFP_CHUNK) { \
+		size_t m = n - i < __INTFP_BFP_CHUNK ? n - i : __INTFP_BFP_CHUNK; \
+		pul##lbits##fp_to_u64_array(buf, src + i, m, ifp); \
+		u64_to_bfp##mbits(exps + i / block, mans + i, buf, m, block); \
+	} \
+	return 0; \
+}) \
+__intfp_if_log( \
+/** @brief Converts n block values to 'log##lbits' codes with ofp fraction bits. */ \
+INTFP_API int bfp##mbits##_to_log##lbits##fp(s##lbits *dst, const u8 *exps, \
+		const u##mbits *mans, size_t n, u8 block, u8 ofp) { \
+	u64 buf[__INTFP_BFP_CHUNK]; \
+	if (!INTFP_BFP_BLOCK_OK(block)) \
+		return -1; \
+	for (size_t i = 0; i < n; i += __INTFP_BFP_CHUNK) { \
+		size_t m = n - i < __INTFP_BFP_CHUNK ? n - i : __INTFP_BFP_CHUNK; \
+		bfp##mbits##_to_u64(buf, exps + i / block, mans + i, m, block); \
+		u64fp_to_log##lbits##fp_array(dst + i, buf, m, 0, ofp); \
+	} \
+	return 0; \
+} \
+/** @brief Converts n 'log##lbits' codes with ifp fraction bits to blocks. */ \
+INTFP_API int log##lbits##fp_to_bfp##mbits(u8 *exps, u##mbits *mans, \
+		const s##lbits *src, size_t n, u8 block, u8 ifp) { \
+	u64 buf[__INTFP_BFP_CHUNK]; \
+	if (!INTFP_BFP_BLOCK_OK(block)) \
+		return -1; \
+	for (size_t i = 0; i < n; i += __INTFP_BFP_CHUNK) { \
+		size_t m = n - i < __INTFP_BFP_CHUNK ? n - i : __INTFP_BFP_CHUNK; \
+		log##lbits##fp_to_u64fp_array(buf, src + i, m, ifp, 0); \
+		u64_to_bfp##mbits(exps + i / block, mans + i, buf, m, block); \
+	} \
+	return 0; \
+})
+
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
+INTFP_DECL_BFP_CONV(8, 8)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_64_8) && defined(INTFP_WITH_64_16))
+INTFP_DECL_BFP_CONV(8, 16)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_64_8) && defined(INTFP_WITH_64_32))
+INTFP_DECL_BFP_CONV(8, 32)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_64_16) && defined(INTFP_WITH_64_8))
+INTFP_DECL_BFP_CONV(16, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+INTFP_DECL_BFP_CONV(16, 16)
+#endif
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_64_16) && defined(INTFP_WITH_64_32))
+INTFP_DECL_BFP_CONV(16, 32)
+#endif
+
+#endif /* _INTFP_BFP_H */
@@ -0,0 +1,388 @@
+#ifndef _INTFP_COL_H
+#define _INTFP_COL_H
+/*
+ * Integer-based Fixed-Point and Pseudo-Logarithmic Number Library (intfp)
+ * Memory-mappable columnar container
+ * Copyright (C) 2025 Masahito Suzuki
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * @file intfp_col.h
+ * @brief An on-disk container for one column of 'pul' or 'log' values.
+ *
+ * @details
+ * The container is designed to be mapped (mmap) and read in place. The
+ * functions here work on a memory range and never copy the values out of
+ * it; they use no libc, so the header also builds freestanding.
+ *
+ * Layout (all fields in the writer's byte order, see byte_order):
+ *
+ *   0   struct intfp_col_header (64 bytes)
+ *   64  u64 chunk offsets[nchunks], from the start of the container
+ *   ... chunks, each starting at a multiple of 64 bytes
+ *
+ * A column holds `count` u##hbits integers encoded as 'pul' or 'log' values
+ * of lbits bits, with the fp and correction level of the header, in chunks of
+ * 2^chunk_shift values (the last one may be shorter). Value i lives at
+ * offsets[i >> chunk_shift] + (i & mask) * lbits / 8, so random access is
+ * O(1). intfp_col_open() checks every field and chunk offset against the
+ * size of the range once, after which no access can leave it.
+ */
+
+#include "intfp.h"
+
+/** @brief File magic, the first 8 bytes of a container. */
+#define INTFP_COL_MAGIC "INTFPCOL"
+/** @brief Container version written by intfp_col_create(). */
+#define INTFP_COL_VERSION 1
+/** @brief Written in the writer's order; reads back swapped on the other. */
+#define INTFP_COL_BYTE_ORDER 0x01020304u
+/** @brief Default chunk size, 2^16 values. */
+#define INTFP_COL_CHUNK_SHIFT 16
+
+/** @brief Encoding of the values of a column. */
+enum intfp_col_kind {
+	INTFP_COL_PUL = 1, /**< 'pul', decoded with pul<l>fp_to_u<h>(). */
+	INTFP_COL_LOG = 2, /**< 'log', decoded with log<l>fp_to_u<h>fp_corr_n(). */
+};
+
+/** @brief Results of intfp_col_open() and intfp_col_create(). */
+enum intfp_col_status {
+	INTFP_COL_OK = 0,
+	INTFP_COL_EMAGIC = -1,   /**< Not a container. */
+	INTFP_COL_EVERSION = -2, /**< A newer, unknown version. */
+	INTFP_COL_EENDIAN = -3,  /**< Written with the other byte order. */
+	INTFP_COL_EFORMAT = -4,  /**< Kind, widths, fp or level invalid, or not
+	                              generated in this build (INTFP_SELECT). */
+	INTFP_COL_ERANGE = -5,   /**< A table or chunk lies outside the range,
+	                              or is misaligned. */
+};
+
+/** @brief The 64-byte header at the start of a container. */
+struct intfp_col_header {
+	char magic[8];     /**< INTFP_COL_MAGIC, not terminated. */
+	u32 byte_order;    /**< INTFP_COL_BYTE_ORDER. */
+	u16 version;       /**< INTFP_COL_VERSION. */
+	u16 header_size;   /**< 64; the chunk table follows the header. */
+	u8 kind;           /**< enum intfp_col_kind. */
+	u8 hbits, lbits;   /**< Width pair of INTFP_DECL_HBITS_LBITS. */
+	u8 fp;             /**< Fraction bits of the encoded values. */
+	u8 level;          /**< 'log' correction level (0-3); 0 for 'pul'. */
+	u8 chunk_shift;    /**< Values per chunk: 2^chunk_shift. */
+	u8 reserved0[2];
+	u64 count;         /**< Number of values. */
+	u64 nchunks;       /**< Entries in the chunk table. */
+	u8 reserved1[24];
+};
+
+/** @brief An opened container; see intfp_col_open(). */
+struct intfp_col {
+	u8 *base;
+	u64 size;
+	const u64 *chunks;
+	u64 count;
+	u8 kind, hbits, lbits, fp, level, chunk_shift;
+};
+
+/* Operations of __intfp_col_convert(). */
+enum __intfp_col_op { __INTFP_COL_PROBE, __INTFP_COL_ENCODE, __INTFP_COL_DECODE };
+
+#define __intfp_col_key(kind, hbits, lbits) ((u32)(kind) << 16 | (u32)(hbits) << 8 | (lbits))
+
+/* Cases of one width pair, for the families generated in this build. */
+#define __INTFP_COL_CASES(hbits, lbits) \
+__intfp_if_pul( \
+	case __intfp_col_key(INTFP_COL_PUL, hbits, lbits): \
+		if (op == __INTFP_COL_ENCODE) \
+			u##hbits##_to_pul##lbits##fp_array((u##lbits *)dst, (const u##hbits *)src, n, fp); \
+		else if (op == __INTFP_COL_DECODE) \
+			pul##lbits##fp_to_u##hbits##_array((u##hbits *)dst, (const u##lbits *)src, n, fp); \
+		return 1;) \
+__intfp_if_corr_n( \
+	case __intfp_col_key(INTFP_COL_LOG, hbits, lbits): \
+		if (op == __INTFP_COL_ENCODE) \
+			u##hbits##fp_to_log##lbits##fp_corr_n_array((s##lbits *)dst, \
+				(const u##hbits *)src, n, 0, fp, level); \
+		else if (op == __INTFP_COL_DECODE) \
+			log##lbits##fp_to_u##hbits##fp_corr_n_array((u##hbits *)dst, \
+				(const s##lbits *)src, n, fp, 0, level); \
+		return 1;)
+
+/*
+ * Runs the `_array` conversion of a column's format on n values, or only
+ * reports whether the format is generated (__INTFP_COL_PROBE).
+ */
+static inline int __intfp_col_convert(enum __intfp_col_op op, u8 kind, u8 hbits, u8 lbits,
+		void *dst, const void *src, size_t n, u8 fp, u8 level) {
+	(void)dst; (void)src; (void)n; (void)fp; (void)level;
+	switch (__intfp_col_key(kind, hbits, lbits)) {
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_8_8)
+	__INTFP_COL_CASES( 8, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_8)
+	__INTFP_COL_CASES(16, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_8)
+	__INTFP_COL_CASES(32, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
+	__INTFP_COL_CASES(64, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_16)
+	__INTFP_COL_CASES(16,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_16)
+	__INTFP_COL_CASES(32,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+	__INTFP_COL_CASES(64,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_32)
+	__INTFP_COL_CASES(32,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_32)
+	__INTFP_COL_CASES(64,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_64)
+	__INTFP_COL_CASES(64,64)
+#endif
+	}
+	return 0;
+}
+
+/* Scalar decoders of one width pair, kept apart from the batch ones so
+ * that intfp_col_get() stays small. */
+#define __INTFP_COL_GET_CASES(hbits, lbits) \
+__intfp_if_pul( \
+	case __intfp_col_key(INTFP_COL_PUL, hbits, lbits): \
+		return pul##lbits##fp_to_u##hbits(*(const u##lbits *)p, col->fp);) \
+__intfp_if_corr_n( \
+	case __intfp_col_key(INTFP_COL_LOG, hbits, lbits): \
+		return log##lbits##fp_to_u##hbits##fp_corr_n(*(const s##lbits *)p, col->fp, 0, \
+			col->level);)
+
+/* Offset of the first chunk in the layout of intfp_col_create(). */
+static inline u64 __intfp_col_data_offset(u64 nchunks) {
+	return (64 + nchunks * 8 + 63) & ~(u64)63;
+}
+
+/* Bytes of one full chunk, rounded up to keep the next chunk aligned. */
+static inline u64 __intfp_col_chunk_bytes(u8 lbits, u8 chunk_shift) {
+	return (((u64)lbits / 8 << chunk_shift) + 63) & ~(u64)63;
+}
+
+/**
+ * @brief Returns the number of values in chunk k of an opened container.
+ */
+INTFP_API u64 intfp_col_chunk_len(const struct intfp_col *col, u64 k) {
+	u64 first = k << col->chunk_shift;
+	u64 len = col->count - first;
+	return (len < ((u64)1 << col->chunk_shift)) ? len : (u64)1 << col->chunk_shift;
+}
+
+/**
+ * @brief Validates the container in [base, base + size) and fills col.
+ * After INTFP_COL_OK, every access through col stays inside the range. The
+ * range must stay mapped and unchanged while col is used.
+ * @param base Start of the container, aligned to 8 bytes (mmap gives pages).
+ * @return INTFP_COL_OK or a negative enum intfp_col_status.
+ */
+INTFP_API int intfp_col_open(struct intfp_col *col, const void *base, u64 size) {
+	const struct intfp_col_header *h = (const struct intfp_col_header *)base;
+	if (size < sizeof(*h) || ((size_t)base & 7))
+		return INTFP_COL_EMAGIC;
+	for (int i = 0; i < 8; i++)
+		if (h->magic[i] != INTFP_COL_MAGIC[i])
+			return INTFP_COL_EMAGIC;
+	if (h->byte_order != INTFP_COL_BYTE_ORDER)
+		return (h->byte_order == __builtin_bswap32(INTFP_COL_BYTE_ORDER)) ?
+			INTFP_COL_EENDIAN : INTFP_COL_EMAGIC;
+	if (h->version != INTFP_COL_VERSION)
+		return INTFP_COL_EVERSION;
+	/* The width pair first: intfp_pul_fpmax() needs hbits of a real format */
+	if (h->header_size != sizeof(*h) || h->level > 3 || h->fp == 0 ||
+	    !__intfp_col_convert(__INTFP_COL_PROBE, h->kind, h->hbits, h->lbits, 0, 0, 0, 0, 0) ||
+	    (h->kind == INTFP_COL_PUL && (h->fp > intfp_pul_fpmax(h->hbits, h->lbits) || h->level)) ||
+	    (h->kind == INTFP_COL_LOG && h->fp > intfp_log_fpmax(h->hbits, h->lbits)))
+		return INTFP_COL_EFORMAT;
+	if (h->chunk_shift < 6 || h->chunk_shift > 40 || h->count > ((u64)1 << 56) ||
+	    h->nchunks != (h->count + ((u64)1 << h->chunk_shift) - 1) >> h->chunk_shift ||
+	    h->nchunks > (size - sizeof(*h)) / 8)
+		return INTFP_COL_ERANGE;
+	col->base = (u8 *)base;
+	col->size = size;
+	col->chunks = (const u64 *)(h + 1);
+	col->count = h->count;
+	col->kind = h->kind;
+	col->hbits = h->hbits;
+	col->lbits = h->lbits;
+	col->fp = h->fp;
+	col->level = h->level;
+	col->chunk_shift = h->chunk_shift;
+	u64 table_end = sizeof(*h) + h->nchunks * 8;
+	for (u64 k = 0; k < h->nchunks; k++) {
+		u64 off = col->chunks[k];
+		u64 bytes = intfp_col_chunk_len(col, k) * (h->lbits / 8);
+		if ((off & 63) || off < table_end || off > size || bytes > size - off)
+			return INTFP_COL_ERANGE;
+	}
+	return INTFP_COL_OK;
+}
+
+/**
+ * @brief Returns the size of a container made by intfp_col_create().
+ * @param chunk_shift Values per chunk as a power of two (6 to 40), e.g.
+ *                    INTFP_COL_CHUNK_SHIFT.
+ */
+INTFP_API u64 intfp_col_size(u8 lbits, u64 count, u8 chunk_shift) {
+	u64 nchunks = (count + ((u64)1 << chunk_shift) - 1) >> chunk_shift;
+	if (nchunks == 0) return __intfp_col_data_offset(0);
+	return __intfp_col_data_offset(nchunks) +
+		(nchunks - 1) * __intfp_col_chunk_bytes(lbits, chunk_shift) +
+		(count - ((nchunks - 1) << chunk_shift)) * (lbits / 8);
+}
+
+/**
+ * @brief Writes the header and chunk table of a new container to base, and
+ * opens it. The values are then stored with intfp_col_encode().
+ * @param base A writable range of intfp_col_size() bytes, aligned to 8.
+ * @param kind INTFP_COL_PUL or INTFP_COL_LOG.
+ * @param fp Fraction bits of the encoded values, 1 to the format's fpmax.
+ * @param level 'log' correction level (0-3); must be 0 for 'pul'.
+ * @return INTFP_COL_OK or a negative enum intfp_col_status.
+ */
+INTFP_API int intfp_col_create(struct intfp_col *col, void *base, u64 size, u8 kind,
+		u8 hbits, u8 lbits, u8 fp, u8 level, u64 count, u8 chunk_shift) {
+	struct intfp_col_header *h = (struct intfp_col_header *)base;
+	if (chunk_shift < 6 || chunk_shift > 40)
+		return INTFP_COL_ERANGE;
+	if (size < intfp_col_size(lbits, count, chunk_shift) || ((size_t)base & 7))
+		return INTFP_COL_ERANGE;
+	for (u64 i = 0; i < sizeof(*h); i++)
+		((u8 *)base)[i] = 0;
+	for (int i = 0; i < 8; i++)
+		h->magic[i] = INTFP_COL_MAGIC[i];
+	h->byte_order = INTFP_COL_BYTE_ORDER;
+	h->version = INTFP_COL_VERSION;
+	h->header_size = sizeof(*h);
+	h->kind = kind;
+	h->hbits = hbits;
+	h->lbits = lbits;
+	h->fp = fp;
+	h->level = level;
+	h->chunk_shift = chunk_shift;
+	h->count = count;
+	h->nchunks = (count + ((u64)1 << chunk_shift) - 1) >> chunk_shift;
+	u64 *table = (u64 *)(h + 1);
+	for (u64 k = 0; k < h->nchunks; k++)
+		table[k] = __intfp_col_data_offset(h->nchunks) +
+			k * __intfp_col_chunk_bytes(lbits, chunk_shift);
+	return intfp_col_open(col, base, size);
+}
+
+/**
+ * @brief Returns the encoded value i in place (an u##lbits / s##lbits).
+ * @param i Index below col->count.
+ */
+INTFP_API const void *intfp_col_at(const struct intfp_col *col, u64 i) {
+	u64 mask = ((u64)1 << col->chunk_shift) - 1;
+	return col->base + col->chunks[i >> col->chunk_shift] + (i & mask) * (col->lbits / 8);
+}
+
+/**
+ * @brief Decodes values [first, first + n) to u##hbits integers in dst.
+ * Reads the encoded values straight from the container, one `_array` call
+ * per chunk. The range is clipped to col->count.
+ * @return The number of values decoded.
+ */
+INTFP_API u64 intfp_col_decode(const struct intfp_col *col, void *dst, u64 first, u64 n) {
+	if (first >= col->count) return 0;
+	if (n > col->count - first) n = col->count - first;
+	u64 mask = ((u64)1 << col->chunk_shift) - 1;
+	for (u64 i = first; i < first + n; ) {
+		u64 m = ((i | mask) + 1) - i;
+		if (m > first + n - i) m = first + n - i;
+		__intfp_col_convert(__INTFP_COL_DECODE, col->kind, col->hbits, col->lbits,
+			(u8 *)dst + (i - first) * (col->hbits / 8), intfp_col_at(col, i),
+			(size_t)m, col->fp, col->level);
+		i += m;
+	}
+	return n;
+}
+
+/**
+ * @brief Encodes n u##hbits integers from src into values [first, first + n).
+ * The container must be mapped writable. The range is clipped to col->count.
+ * @return The number of values encoded.
+ */
+INTFP_API u64 intfp_col_encode(struct intfp_col *col, u64 first, const void *src, u64 n) {
+	if (first >= col->count) return 0;
+	if (n > col->count - first) n = col->count - first;
+	u64 mask = ((u64)1 << col->chunk_shift) - 1;
+	for (u64 i = first; i < first + n; ) {
+		u64 m = ((i | mask) + 1) - i;
+		if (m > first + n - i) m = first + n - i;
+		__intfp_col_convert(__INTFP_COL_ENCODE, col->kind, col->hbits, col->lbits,
+			(void *)intfp_col_at(col, i), (const u8 *)src + (i - first) * (col->hbits / 8),
+			(size_t)m, col->fp, col->level);
+		i += m;
+	}
+	return n;
+}
+
+/**
+ * @brief Decodes value i, widened to u64.
+ * @param i Index below col->count.
+ */
+INTFP_API u64 intfp_col_get(const struct intfp_col *col, u64 i) {
+	const void *p = intfp_col_at(col, i);
+	switch (__intfp_col_key(col->kind, col->hbits, col->lbits)) {
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_8_8)
+	__INTFP_COL_GET_CASES( 8, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_8)
+	__INTFP_COL_GET_CASES(16, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_8)
+	__INTFP_COL_GET_CASES(32, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
+	__INTFP_COL_GET_CASES(64, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_16)
+	__INTFP_COL_GET_CASES(16,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_16)
+	__INTFP_COL_GET_CASES(32,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+	__INTFP_COL_GET_CASES(64,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_32)
+	__INTFP_COL_GET_CASES(32,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_32)
+	__INTFP_COL_GET_CASES(64,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_64)
+	__INTFP_COL_GET_CASES(64,64)
+#endif
+	}
+	return 0;
+}
+
+#endif /* _INTFP_COL_H */
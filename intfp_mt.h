@@ -0,0 +1,366 @@
+#ifndef _INTFP_MT_H
+#define _INTFP_MT_H
+/*
+ * Integer-based Fixed-Point and Pseudo-Logarithmic Number Library (intfp)
+ * Multithreaded batch conversion
+ * Copyright (C) 2025 Masahito Suzuki
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * @file intfp_mt.h
+ * @brief A pthread pool that spreads the `_array` conversions over cores.
+ *
+ * @details
+ * This optional header is for POSIX user space and must be built with
+ * -pthread; intfp.h itself stays free of threads and libc. Include it instead
+ * of intfp.h (with the same INTFP_SELECT macros, which it honors).
+ *
+ * An `_array_mt` variant is generated for every `pul`, `log` and `_corr_n`
+ * batch conversion of the selected width pairs. It takes a pool as its first
+ * argument and gives results bit-identical to the `_array` function, which
+ * each thread runs on its own part of the buffers.
+ *
+ * Scheduling:
+ * - The input is cut into blocks of INTFP_MT_BLOCK_BYTES of source plus
+ *   destination, so that a block streams through L2 once.
+ * - Each thread owns a contiguous range of blocks and claims them with an
+ *   atomic increment of its own counter. A thread that runs out steals
+ *   blocks from the other ranges the same way, so a thread slowed down by
+ *   the OS or a busy sibling core does not hold up the call.
+ * - The calling thread works as thread 0, and a call returns when every
+ *   block is done. One call at a time may run on a pool.
+ *
+ * With INTFP_POOL_PIN, worker i is pinned to CPU i (Linux, with _GNU_SOURCE
+ * defined before the first include). intfp_pool_alloc() then places pages on
+ * the NUMA node of the thread that converts them, by first touch.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__linux__) && defined(_GNU_SOURCE)
+#include <sched.h>
+#endif
+#include "intfp.h"
+
+/**
+ * @brief Bytes of source plus destination per scheduled block.
+ * Small enough to stay in L2 while it is converted, large enough that the
+ * one atomic increment per block does not show.
+ */
+#ifndef INTFP_MT_BLOCK_BYTES
+#define INTFP_MT_BLOCK_BYTES 65536
+#endif
+
+/** @brief Pool flag: pin worker i to CPU i (see intfp_pool_create()). */
+#define INTFP_POOL_PIN 1u
+
+/** @brief Work function of intfp_pool_run(), called on [begin, end). */
+typedef void (*intfp_pool_fn)(void *ctx, size_t begin, size_t end);
+
+/* Block counters of one thread, each on its own cache line. */
+struct __intfp_pool_slot {
+	size_t next, end;
+	char pad[64 - 2 * sizeof(size_t)];
+};
+
+struct __intfp_pool_worker {
+	struct intfp_pool *pool;
+	unsigned index;
+	pthread_t thread;
+};
+
+/** @brief A pool of threads created by intfp_pool_create(). */
+struct intfp_pool {
+	unsigned nthreads;  /* Including the calling thread */
+	unsigned flags;
+	pthread_mutex_t lock;
+	pthread_cond_t wake, idle;
+	unsigned long gen;  /* Incremented for every intfp_pool_run() */
+	unsigned busy;      /* Workers still running the current call */
+	int quit;
+	intfp_pool_fn fn;
+	void *ctx;
+	size_t n, block;
+	struct __intfp_pool_slot *slot;  /* 64-byte aligned within slot_mem */
+	void *slot_mem;
+	struct __intfp_pool_worker *worker;
+};
+
+/* Runs blocks of the current call: own range first, then the others'. */
+static inline void __intfp_pool_work(struct intfp_pool *pool, unsigned self) {
+	for (unsigned k = 0; k < pool->nthreads; k++) {
+		struct __intfp_pool_slot *s = &pool->slot[(self + k) % pool->nthreads];
+		while (__atomic_load_n(&s->next, __ATOMIC_RELAXED) < s->end) {
+			size_t b = __atomic_fetch_add(&s->next, 1, __ATOMIC_RELAXED);
+			if (b >= s->end) break;
+			size_t begin = b * pool->block;
+			size_t end = (pool->n - begin > pool->block) ? begin + pool->block : pool->n;
+			pool->fn(pool->ctx, begin, end);
+		}
+	}
+}
+
+static inline void __intfp_pool_pin(unsigned cpu) {
+#if defined(__linux__) && defined(_GNU_SOURCE)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu % CPU_SETSIZE, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	(void)cpu;
+#endif
+}
+
+static inline void *__intfp_pool_main(void *arg) {
+	struct __intfp_pool_worker *w = (struct __intfp_pool_worker *)arg;
+	struct intfp_pool *pool = w->pool;
+	if (pool->flags & INTFP_POOL_PIN)
+		__intfp_pool_pin(w->index);
+	unsigned long seen = 0;  /* A call may start before this thread does */
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (pool->gen == seen && !pool->quit)
+			pthread_cond_wait(&pool->wake, &pool->lock);
+		if (pool->quit) break;
+		seen = pool->gen;
+		pthread_mutex_unlock(&pool->lock);
+		__intfp_pool_work(pool, w->index);
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->busy == 0)
+			pthread_cond_signal(&pool->idle);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return NULL;
+}
+
+/**
+ * @brief Destroys a pool, joining its threads. NULL is ignored.
+ */
+INTFP_API void intfp_pool_destroy(struct intfp_pool *pool) {
+	if (!pool) return;
+	pthread_mutex_lock(&pool->lock);
+	pool->quit = 1;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	for (unsigned i = 1; i < pool->nthreads; i++)
+		pthread_join(pool->worker[i].thread, NULL);
+	pthread_cond_destroy(&pool->idle);
+	pthread_cond_destroy(&pool->wake);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->worker);
+	free(pool->slot_mem);
+	free(pool);
+}
+
+/**
+ * @brief Creates a pool of nthreads threads, the calling one included.
+ * If fewer threads can be started, the pool runs with those that were.
+ * @param nthreads Number of threads; 0 for one per online CPU.
+ * @param flags 0 or INTFP_POOL_PIN. The calling thread is never pinned, so
+ *              pin it to CPU 0 for a fully pinned pool.
+ * @return The pool, or NULL if out of memory.
+ */
+INTFP_API struct intfp_pool *intfp_pool_create(unsigned nthreads, unsigned flags) {
+	if (nthreads == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		nthreads = (cpus > 0) ? (unsigned)cpus : 1;
+	}
+	struct intfp_pool *pool = (struct intfp_pool *)calloc(1, sizeof(*pool));
+	if (!pool) return NULL;
+	/* One slot more, to align them to cache lines: aligned_alloc() is not C99 */
+	pool->slot_mem = calloc(nthreads + 1, sizeof(*pool->slot));
+	pool->slot = (struct __intfp_pool_slot *)((char *)pool->slot_mem +
+		(-(size_t)pool->slot_mem & 63));
+	pool->worker = (struct __intfp_pool_worker *)calloc(nthreads, sizeof(*pool->worker));
+	if (!pool->slot_mem || !pool->worker) {
+		free(pool->worker);
+		free(pool->slot_mem);
+		free(pool);
+		return NULL;
+	}
+	pool->flags = flags;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->wake, NULL);
+	pthread_cond_init(&pool->idle, NULL);
+	pool->nthreads = 1;
+	for (unsigned i = 1; i < nthreads; i++) {
+		pool->worker[i].pool = pool;
+		pool->worker[i].index = i;
+		if (pthread_create(&pool->worker[i].thread, NULL, __intfp_pool_main,
+				&pool->worker[i]) != 0)
+			break;
+		pool->nthreads++;
+	}
+	return pool;
+}
+
+/**
+ * @brief Calls fn(ctx, begin, end) over [0, n) in blocks of `block`, on every
+ * thread of the pool, and returns when all are done.
+ * Each thread starts with an equal contiguous share of the blocks and steals
+ * from the others when its share is done. A NULL pool runs fn(ctx, 0, n) on
+ * the calling thread.
+ * @param block Elements per call of fn (0 is taken as 1).
+ */
+INTFP_API void intfp_pool_run(struct intfp_pool *pool, size_t n, size_t block,
+		intfp_pool_fn fn, void *ctx) {
+	if (block == 0) block = 1;
+	if (!pool || pool->nthreads == 1 || n <= block) {
+		if (n) fn(ctx, 0, n);
+		return;
+	}
+	size_t nblocks = (n - 1) / block + 1;
+	unsigned t = pool->nthreads;
+	for (unsigned i = 0; i < t; i++) {
+		pool->slot[i].next = nblocks * i / t;
+		pool->slot[i].end = nblocks * (i + 1) / t;
+	}
+	pthread_mutex_lock(&pool->lock);
+	pool->fn = fn;
+	pool->ctx = ctx;
+	pool->n = n;
+	pool->block = block;
+	pool->busy = t - 1;
+	pool->gen++;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	__intfp_pool_work(pool, 0);
+	pthread_mutex_lock(&pool->lock);
+	while (pool->busy)
+		pthread_cond_wait(&pool->idle, &pool->lock);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+static inline void __intfp_pool_touch(void *ctx, size_t begin, size_t end) {
+	memset((char *)ctx + begin, 0, end - begin);
+}
+
+/**
+ * @brief Allocates a zero-filled buffer of n elements of `size` bytes whose
+ * pages are first touched by the pool threads.
+ * Each thread zeroes an equal contiguous share of the bytes, in blocks of
+ * INTFP_MT_BLOCK_BYTES. An `_array_mt` call also starts each thread on an
+ * equal share, of the elements, so on a NUMA machine with a pinned pool the
+ * pages of each share land on the node of the thread that converts them,
+ * apart from the pages at share edges and any blocks that are stolen. Free
+ * it with free().
+ * @return The buffer, or NULL if out of memory.
+ */
+INTFP_API void *intfp_pool_alloc(struct intfp_pool *pool, size_t n, size_t size) {
+	if (size && n > (size_t)-1 / size) return NULL;
+	size_t bytes = n * size;
+	void *p = malloc(bytes ? bytes : 1);
+	if (p) intfp_pool_run(pool, bytes, INTFP_MT_BLOCK_BYTES, __intfp_pool_touch, p);
+	return p;
+}
+
+/* Arguments of one `_array_mt` call, passed to its block function. */
+struct __intfp_mt_job {
+	void *dst;
+	const void *src;
+	u8 ifp, ofp, level;
+};
+
+/* Elements per block for a width pair: a multiple of 64, for whole vectors. */
+#define __INTFP_MT_BLOCK(hbits, lbits) \
+	((size_t)(INTFP_MT_BLOCK_BYTES / ((hbits + lbits) / 8)) & ~(size_t)63)
+
+/*
+ * Generates `name##_mt(pool, dst, src, n, ...)` running `name(dst, src, n,
+ * ...)` on the pool. `args` names the trailing parameters: O (ofp), I (ifp),
+ * IO (ifp, ofp) or ION (ifp, ofp, level).
+ */
+#define __INTFP_DECL_MT(hbits, lbits, name, dst_t, src_t, args) \
+static inline void __##name##_mt_block(void *ctx, size_t begin, size_t end) { \
+	const struct __intfp_mt_job *j = (const struct __intfp_mt_job *)ctx; \
+	name((dst_t *)j->dst + begin, (const src_t *)j->src + begin, end - begin, \
+		__INTFP_MT_PASS_##args); \
+} \
+/** @brief Runs name() on the threads of pool; the result is the same. */ \
+INTFP_API void name##_mt(struct intfp_pool *pool, dst_t *dst, const src_t *src, \
+		size_t n, __INTFP_MT_PARAMS_##args) { \
+	struct __intfp_mt_job j = { dst, src, __INTFP_MT_JOB_##args }; \
+	intfp_pool_run(pool, n, __INTFP_MT_BLOCK(hbits, lbits), __##name##_mt_block, &j); \
+}
+#define __INTFP_MT_PARAMS_O   u8 ofp
+#define __INTFP_MT_PASS_O     j->ofp
+#define __INTFP_MT_JOB_O      0, ofp, 0
+#define __INTFP_MT_PARAMS_I   u8 ifp
+#define __INTFP_MT_PASS_I     j->ifp
+#define __INTFP_MT_JOB_I      ifp, 0, 0
+#define __INTFP_MT_PARAMS_IO  u8 ifp, u8 ofp
+#define __INTFP_MT_PASS_IO    j->ifp, j->ofp
+#define __INTFP_MT_JOB_IO     ifp, ofp, 0
+#define __INTFP_MT_PARAMS_ION u8 ifp, u8 ofp, u8 level
+#define __INTFP_MT_PASS_ION   j->ifp, j->ofp, j->level
+#define __INTFP_MT_JOB_ION    ifp, ofp, level
+
+/**
+ * @brief Generates the `_array_mt` conversions of one width pair.
+ */
+#define INTFP_DECL_MT_HBITS_LBITS(hbits, lbits) \
+__intfp_if_pul( \
+	__INTFP_DECL_MT(hbits, lbits, u##hbits##_to_pul##lbits##fp_array, \
+		u##lbits, u##hbits, O) \
+	__INTFP_DECL_MT(hbits, lbits, pul##lbits##fp_to_u##hbits##_array, \
+		u##hbits, u##lbits, I)) \
+__intfp_if_log( \
+	__INTFP_DECL_MT(hbits, lbits, u##hbits##fp_to_log##lbits##fp_array, \
+		s##lbits, u##hbits, IO) \
+	__INTFP_DECL_MT(hbits, lbits, log##lbits##fp_to_u##hbits##fp_array, \
+		u##hbits, s##lbits, IO)) \
+__intfp_if_corr_n( \
+	__INTFP_DECL_MT(hbits, lbits, u##hbits##fp_to_log##lbits##fp_corr_n_array, \
+		s##lbits, u##hbits, ION) \
+	__INTFP_DECL_MT(hbits, lbits, log##lbits##fp_to_u##hbits##fp_corr_n_array, \
+		u##hbits, s##lbits, ION))
+
+/* Generate the multithreaded conversions for the width pairs of intfp.h */
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_8_8)
+INTFP_DECL_MT_HBITS_LBITS( 8, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_8)
+INTFP_DECL_MT_HBITS_LBITS(16, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_8)
+INTFP_DECL_MT_HBITS_LBITS(32, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
+INTFP_DECL_MT_HBITS_LBITS(64, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_16)
+INTFP_DECL_MT_HBITS_LBITS(16,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_16)
+INTFP_DECL_MT_HBITS_LBITS(32,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+INTFP_DECL_MT_HBITS_LBITS(64,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_32)
+INTFP_DECL_MT_HBITS_LBITS(32,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_32)
+INTFP_DECL_MT_HBITS_LBITS(64,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_64)
+INTFP_DECL_MT_HBITS_LBITS(64,64)
+#endif
+
+#endif /* _INTFP_MT_H */
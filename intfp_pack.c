@@ -0,0 +1,342 @@
+/**
+ * intfp-pack: Command-Line Pack/Unpack Tool
+ *
+ * Converts raw little-endian u8/u16/u32/u64 files to 'pul' or 'log' files of
+ * the same layout and back. Files are streamed in blocks of PACK_CHUNK
+ * values, so they may be larger than RAM and may be pipes, and each block is
+ * converted by the '_array_mt' functions on all CPUs. When packing, every
+ * block is also decoded again to report the relative error of the format.
+ *
+ * The packed files carry no header: unpack with the same -f, -i, -w, -p and
+ * -c options that were used to pack.
+ */
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <time.h>
+#include <math.h>
+
+// Type aliases used by intfp.h
+typedef uint8_t   u8;
+typedef uint16_t  u16;
+typedef uint32_t  u32;
+typedef uint64_t  u64;
+typedef int8_t    s8;
+typedef int16_t   s16;
+typedef int32_t   s32;
+typedef int64_t   s64;
+
+#include "intfp_mt.h"
+
+#define PACK_CHUNK (1 << 20)  /* Values per read: 8 MiB of u64 */
+
+// One conversion of a width pair; fp and level as given on the command line
+typedef void (*pack_fn)(struct intfp_pool *pool, void *dst, const void *src, size_t n,
+                        u8 fp, u8 level);
+
+struct pack_pair {
+    int hbits, lbits;
+    pack_fn pul_enc, pul_dec, log_enc, log_dec;
+};
+
+// Wraps the '_array_mt' conversions of one pair into pack_fn form
+#define PACK_DECL_PAIR(hbits, lbits) \
+static void pack_pul_enc_##hbits##_##lbits(struct intfp_pool *pool, void *dst, \
+        const void *src, size_t n, u8 fp, u8 level) { \
+    (void)level; \
+    u##hbits##_to_pul##lbits##fp_array_mt(pool, dst, src, n, fp); \
+} \
+static void pack_pul_dec_##hbits##_##lbits(struct intfp_pool *pool, void *dst, \
+        const void *src, size_t n, u8 fp, u8 level) { \
+    (void)level; \
+    pul##lbits##fp_to_u##hbits##_array_mt(pool, dst, src, n, fp); \
+} \
+static void pack_log_enc_##hbits##_##lbits(struct intfp_pool *pool, void *dst, \
+        const void *src, size_t n, u8 fp, u8 level) { \
+    u##hbits##fp_to_log##lbits##fp_corr_n_array_mt(pool, dst, src, n, 0, fp, level); \
+} \
+static void pack_log_dec_##hbits##_##lbits(struct intfp_pool *pool, void *dst, \
+        const void *src, size_t n, u8 fp, u8 level) { \
+    log##lbits##fp_to_u##hbits##fp_corr_n_array_mt(pool, dst, src, n, fp, 0, level); \
+}
+#define PACK_PAIR(hbits, lbits) { hbits, lbits, \
+    pack_pul_enc_##hbits##_##lbits, pack_pul_dec_##hbits##_##lbits, \
+    pack_log_enc_##hbits##_##lbits, pack_log_dec_##hbits##_##lbits }
+
+PACK_DECL_PAIR( 8, 8)
+PACK_DECL_PAIR(16, 8)
+PACK_DECL_PAIR(32, 8)
+PACK_DECL_PAIR(64, 8)
+PACK_DECL_PAIR(16,16)
+PACK_DECL_PAIR(32,16)
+PACK_DECL_PAIR(64,16)
+PACK_DECL_PAIR(32,32)
+PACK_DECL_PAIR(64,32)
+PACK_DECL_PAIR(64,64)
+
+static const struct pack_pair pack_pairs[] = {
+    PACK_PAIR( 8, 8), PACK_PAIR(16, 8), PACK_PAIR(32, 8), PACK_PAIR(64, 8),
+    PACK_PAIR(16,16), PACK_PAIR(32,16), PACK_PAIR(64,16),
+    PACK_PAIR(32,32), PACK_PAIR(64,32), PACK_PAIR(64,64),
+};
+
+// Reads value i of an array of bits-wide unsigned integers
+static inline u64 pack_get(const void *p, size_t i, int bits) {
+    switch (bits) {
+        case 8:  return ((const u8 *)p)[i];
+        case 16: return ((const u16 *)p)[i];
+        case 32: return ((const u32 *)p)[i];
+        default: return ((const u64 *)p)[i];
+    }
+}
+
+// The files are little-endian; swap in place on big-endian hosts
+static void pack_to_le(void *p, size_t n, int bits) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = 0; i < n; i++) {
+        switch (bits) {
+            case 16: ((u16 *)p)[i] = __builtin_bswap16(((u16 *)p)[i]); break;
+            case 32: ((u32 *)p)[i] = __builtin_bswap32(((u32 *)p)[i]); break;
+            case 64: ((u64 *)p)[i] = __builtin_bswap64(((u64 *)p)[i]); break;
+        }
+    }
+#else
+    (void)p; (void)n; (void)bits;
+#endif
+}
+
+// Relative error of the decoded values against the originals
+struct pack_err {
+    const void *orig, *dec;
+    int bits;
+    pthread_mutex_t lock;
+    double max, sum;
+};
+
+static void pack_err_block(void *ctx, size_t begin, size_t end) {
+    struct pack_err *e = ctx;
+    double max = 0, sum = 0;
+    for (size_t i = begin; i < end; i++) {
+        u64 v = pack_get(e->orig, i, e->bits);
+        u64 d = pack_get(e->dec, i, e->bits);
+        double rel = v ? fabs((double)d - (double)v) / (double)v : (d != 0);
+        if (rel > max) max = rel;
+        sum += rel;
+    }
+    pthread_mutex_lock(&e->lock);
+    if (max > e->max) e->max = max;
+    e->sum += sum;
+    pthread_mutex_unlock(&e->lock);
+}
+
+static double pack_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Parses a whole decimal option argument in [min, max]; complains if it is not one */
+static bool pack_parse_int(const char *name, const char *arg, long min, long max, int *out) {
+    char *end;
+    errno = 0;
+    long v = strtol(arg, &end, 10);
+    if (end == arg || *end != '\0' || errno == ERANGE || v < min || v > max) {
+        fprintf(stderr, "%s must be an integer between %ld and %ld: %s\n", name, min, max, arg);
+        return false;
+    }
+    *out = (int)v;
+    return true;
+}
+
+void print_usage(const char *prog_name) {
+    printf("Usage: %s [options] IN OUT\n", prog_name);
+    printf("Packs raw little-endian unsigned integers to 'pul'/'log', or unpacks them.\n");
+    printf("IN and OUT may be - for stdin/stdout.\n");
+    printf("Options:\n");
+    printf("  -u, --unpack        Unpack IN to integers (default: pack)\n");
+    printf("  -f, --format FMT    pul (default) or log\n");
+    printf("  -i, --int-bits N    Width of the integers: 8, 16, 32 or 64 (default 64)\n");
+    printf("  -w, --bits N        Width of the packed values, at most -i (default 16)\n");
+    printf("  -p, --fp N          Fraction bits of the packed values (default: max)\n");
+    printf("  -c, --corr N        'log' correction level 0-3 (default 1)\n");
+    printf("  -t, --threads N     Conversion threads (default: all CPUs)\n");
+    printf("  -q, --quiet         Do not print statistics\n");
+    printf("  -h, --help          Show this help message\n");
+}
+
+int main(int argc, char *argv[]) {
+    bool unpack = false, use_log = false, quiet = false;
+    int hbits = 64, lbits = 16, fp = -1, level = 1, threads = 0;
+
+    static struct option long_options[] = {
+        {"unpack", no_argument, NULL, 'u'},
+        {"format", required_argument, NULL, 'f'},
+        {"int-bits", required_argument, NULL, 'i'},
+        {"bits", required_argument, NULL, 'w'},
+        {"fp", required_argument, NULL, 'p'},
+        {"corr", required_argument, NULL, 'c'},
+        {"threads", required_argument, NULL, 't'},
+        {"quiet", no_argument, NULL, 'q'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "uf:i:w:p:c:t:qh", long_options, NULL)) != -1) {
+        switch (c) {
+            case 'u':
+                unpack = true;
+                break;
+            case 'f':
+                if (strcmp(optarg, "log") == 0) {
+                    use_log = true;
+                } else if (strcmp(optarg, "pul") != 0) {
+                    fprintf(stderr, "unknown format: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'i':
+                if (!pack_parse_int("int-bits", optarg, 8, 64, &hbits))
+                    return 1;
+                break;
+            case 'w':
+                if (!pack_parse_int("bits", optarg, 8, 64, &lbits))
+                    return 1;
+                break;
+            case 'p':
+                if (!pack_parse_int("fp", optarg, 1, 63, &fp))
+                    return 1;
+                break;
+            case 'c':
+                if (!pack_parse_int("correction level", optarg, 0, 3, &level))
+                    return 1;
+                break;
+            case 't':
+                if (!pack_parse_int("threads", optarg, 0, 4096, &threads))
+                    return 1;
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const struct pack_pair *pair = NULL;
+    for (size_t i = 0; i < sizeof(pack_pairs) / sizeof(pack_pairs[0]); i++)
+        if (pack_pairs[i].hbits == hbits && pack_pairs[i].lbits == lbits)
+            pair = &pack_pairs[i];
+    if (!pair) {
+        fprintf(stderr, "unsupported widths: %d-bit integers to %d-bit values\n", hbits, lbits);
+        return 1;
+    }
+    int fpmax = use_log ? intfp_log_fpmax(hbits, lbits) : intfp_pul_fpmax(hbits, lbits);
+    if (fp < 0) fp = fpmax;
+    if (fp < 1 || fp > fpmax) {
+        fprintf(stderr, "fp must be between 1 and %d for these widths\n", fpmax);
+        return 1;
+    }
+
+    pack_fn enc = use_log ? pair->log_enc : pair->pul_enc;
+    pack_fn dec = use_log ? pair->log_dec : pair->pul_dec;
+    int ibits = unpack ? lbits : hbits, obits = unpack ? hbits : lbits;
+    const char *in_name = argv[optind], *out_name = argv[optind + 1];
+    FILE *in = strcmp(in_name, "-") ? fopen(in_name, "rb") : stdin;
+    if (!in) {
+        perror(in_name);
+        return 1;
+    }
+    FILE *out = strcmp(out_name, "-") ? fopen(out_name, "wb") : stdout;
+    if (!out) {
+        perror(out_name);
+        return 1;
+    }
+
+    struct intfp_pool *pool = intfp_pool_create((unsigned)threads, INTFP_POOL_PIN);
+    void *ibuf = pool ? intfp_pool_alloc(pool, PACK_CHUNK, sizeof(u64)) : NULL;
+    void *obuf = pool ? intfp_pool_alloc(pool, PACK_CHUNK, sizeof(u64)) : NULL;
+    void *cbuf = pool ? intfp_pool_alloc(pool, PACK_CHUNK, sizeof(u64)) : NULL;
+    if (!ibuf || !obuf || !cbuf) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    struct pack_err err = { ibuf, cbuf, hbits, PTHREAD_MUTEX_INITIALIZER, 0, 0 };
+    u64 count = 0;
+    int status = 0;
+    double t0 = pack_now();
+    for (;;) {
+        size_t got = fread(ibuf, 1, (size_t)PACK_CHUNK * ibits / 8, in);
+        if (got % (ibits / 8)) {
+            fprintf(stderr, "%s: size is not a multiple of %d bytes\n", in_name, ibits / 8);
+            status = 1;
+        }
+        size_t n = got / (ibits / 8);
+        if (n == 0) break;
+        pack_to_le(ibuf, n, ibits);
+        if (unpack) {
+            dec(pool, obuf, ibuf, n, (u8)fp, (u8)level);
+        } else {
+            enc(pool, obuf, ibuf, n, (u8)fp, (u8)level);
+            if (!quiet) {
+                dec(pool, cbuf, obuf, n, (u8)fp, (u8)level);
+                intfp_pool_run(pool, n, PACK_CHUNK / 64, pack_err_block, &err);
+            }
+        }
+        pack_to_le(obuf, n, obits);
+        if (fwrite(obuf, obits / 8, n, out) != n) {
+            perror(out_name);
+            status = 1;
+            break;
+        }
+        count += n;
+    }
+    if (ferror(in)) {
+        perror(in_name);
+        status = 1;
+    }
+    if (fflush(out) != 0) {
+        perror(out_name);
+        status = 1;
+    }
+    double secs = pack_now() - t0;
+
+    if (!quiet) {
+        u64 ibytes = count * (ibits / 8), obytes = count * (obits / 8);
+        fprintf(stderr, "%s: %llu values, %llu -> %llu bytes (ratio %.2f), %.1f MB/s on %u thread(s)\n",
+                unpack ? "unpack" : "pack", (unsigned long long)count,
+                (unsigned long long)ibytes, (unsigned long long)obytes,
+                obytes ? (double)ibytes / obytes : 0.0,
+                secs > 0 ? ibytes / secs / 1e6 : 0.0, pool->nthreads);
+        if (!unpack)
+            fprintf(stderr, "relative error: max %.6f, mean %.6f\n",
+                    err.max, count ? err.sum / count : 0.0);
+    }
+
+    if (in != stdin) fclose(in);
+    if (out != stdout && fclose(out) != 0) {
+        perror(out_name);
+        status = 1;
+    }
+    free(ibuf);
+    free(obuf);
+    free(cbuf);
+    intfp_pool_destroy(pool);
+    return status;
+}
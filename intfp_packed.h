@@ -0,0 +1,393 @@
+#ifndef _INTFP_PACKED_H
+#define _INTFP_PACKED_H
+/*
+ * Integer-based Fixed-Point and Pseudo-Logarithmic Number Library (intfp)
+ * Bit-packed arrays of 'pul'/'log' values of any width
+ * Copyright (C) 2025 Masahito Suzuki
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * @file intfp_packed.h
+ * @brief Arrays of 'pul' or 'log' codes of 4 to 63 bits, packed without gaps.
+ *
+ * @details
+ * A code of width w holds the same exponent and mantissa fields as the
+ * 8/16/32/64-bit formats, with as many mantissa bits as fit: by default
+ * intfp_pul_fpmax(hbits, w) for 'pul' and intfp_log_fpmax(hbits, w) for
+ * 'log'. The codes are those of the 64-bit formats (u64_to_pul64fp(),
+ * u64fp_to_log64fp()) for the same fp, which are equal for every input
+ * width, except that a zero's 'log' code is the most negative w-bit value.
+ *
+ * Element i occupies bits [i * w, i * w + w) of the u64 words, least
+ * significant bit first. The storage has two spare words at the end
+ * (INTFP_PACKED_WORDS()), so every access can read a whole u64 or 16 bytes.
+ *
+ * Bulk unpacking spreads 8 codes of up to 25 bits into vector lanes with
+ * AVX2 byte shuffles, and 2 codes of up to 32 bits with BMI2 pdep; bulk
+ * packing gathers pairs of codes with pext. Both count as the AVX2 level of
+ * intfp_isa_get(), so intfp_isa_set(INTFP_ISA_SCALAR) leaves only the
+ * shifting accumulator.
+ */
+
+#include "intfp.h"
+
+#define INTFP_PACKED_MIN_WIDTH 4
+#define INTFP_PACKED_MAX_WIDTH 63
+/** @brief fp of intfp_packed_init() that selects the most mantissa bits. */
+#define INTFP_PACKED_FPMAX 0xff
+
+/** @brief u64 words of storage for n codes of the given width. */
+#define INTFP_PACKED_WORDS(n, width) ((((u64)(n) * (width) + 63) >> 6) + 2)
+
+/** @brief What the codes are. */
+enum intfp_packed_kind {
+	INTFP_PACKED_PUL = 1,
+	INTFP_PACKED_LOG = 2,
+};
+
+/** @brief A packed array over caller storage. */
+struct intfp_packed {
+	u64 *words;  /**< INTFP_PACKED_WORDS(n, width) words */
+	u64 n;
+	u8 kind, hbits, width, fp;
+};
+
+/*
+ * Converts n u64 values to 64-bit codes (enc) or back, for the 64_64 pair
+ * of `kind`. Returns 0 if that conversion is not generated in this build.
+ */
+static inline int __intfp_packed_conv(u8 kind, int enc, u64 *dst, const u64 *src,
+		size_t n, u8 fp) {
+	(void)dst; (void)src; (void)n; (void)fp; (void)enc;
+	switch (kind) {
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_64)
+	__intfp_if_pul(case INTFP_PACKED_PUL:
+		if (enc) u64_to_pul64fp_array(dst, src, n, fp);
+		else pul64fp_to_u64_array(dst, src, n, fp);
+		return 1;)
+	__intfp_if_log(case INTFP_PACKED_LOG:
+		if (enc) u64fp_to_log64fp_array((s64 *)dst, src, n, 0, fp);
+		else log64fp_to_u64fp_array(dst, (const s64 *)src, n, fp, 0);
+		return 1;)
+#endif
+	}
+	return 0;
+}
+
+/* The scalar form of __intfp_packed_conv() for one value. */
+static inline u64 __intfp_packed_conv1(u8 kind, int enc, u64 v, u8 fp) {
+	(void)v; (void)fp; (void)enc;
+	switch (kind) {
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_64)
+	__intfp_if_pul(case INTFP_PACKED_PUL:
+		return enc ? u64_to_pul64fp(v, fp) : pul64fp_to_u64(v, fp);)
+	__intfp_if_log(case INTFP_PACKED_LOG:
+		return enc ? (u64)u64fp_to_log64fp(v, 0, fp) : log64fp_to_u64fp((s64)v, fp, 0);)
+#endif
+	}
+	return 0;
+}
+
+/**
+ * @brief Sets up a packed array of n codes over words.
+ * @param kind INTFP_PACKED_PUL or INTFP_PACKED_LOG.
+ * @param hbits Width of the values: 8, 16, 32 or 64.
+ * @param width Bits per code, 4 to 63.
+ * @param fp Mantissa bits, 1 to fpmax, or INTFP_PACKED_FPMAX for fpmax itself:
+ *        intfp_pul_fpmax(hbits, width) ('pul') or intfp_log_fpmax(hbits,
+ *        width) ('log'), capped at the 64-bit formats' fpmax.
+ * @return 0, or -1 if the format does not fit the width or is not generated.
+ */
+INTFP_API int intfp_packed_init(struct intfp_packed *a, u64 *words, u64 n, u8 kind,
+		u8 hbits, u8 width, u8 fp) {
+	int fpmax = (kind == INTFP_PACKED_LOG ? width - 1 : width) - intfp_fls32(hbits - 1);
+	int cap = kind == INTFP_PACKED_LOG ? INTFP_LOG_FPMAX(64, 64) : INTFP_PUL_FPMAX(64, 64);
+	if (fpmax > cap) fpmax = cap;
+	if (fp == INTFP_PACKED_FPMAX) fp = (u8)fpmax;
+	if (width < INTFP_PACKED_MIN_WIDTH || width > INTFP_PACKED_MAX_WIDTH ||
+	    (hbits != 8 && hbits != 16 && hbits != 32 && hbits != 64) ||
+	    fpmax < 1 || fp < 1 || fp > fpmax || !__intfp_packed_conv(kind, 1, 0, 0, 0, fp))
+		return -1;
+	a->words = words;
+	a->n = n;
+	a->kind = kind;
+	a->hbits = hbits;
+	a->width = width;
+	a->fp = fp;
+	return 0;
+}
+
+/** @brief Reads code i. */
+INTFP_API u64 intfp_packed_get_code(const struct intfp_packed *a, u64 i) {
+	u64 pos = i * a->width, mask = ((u64)1 << a->width) - 1;
+	const u64 *p = a->words + (pos >> 6);
+	unsigned s = pos & 63;
+	/* The second word is a spare one when the code ends in the first */
+	return (p[0] >> s | (p[1] << 1) << (63 - s)) & mask;
+}
+
+/** @brief Writes code i (its low width bits). */
+INTFP_API void intfp_packed_set_code(struct intfp_packed *a, u64 i, u64 code) {
+	u64 pos = i * a->width, mask = ((u64)1 << a->width) - 1;
+	u64 *p = a->words + (pos >> 6);
+	unsigned s = pos & 63;
+	code &= mask;
+	p[0] = (p[0] & ~(mask << s)) | code << s;
+	if (s + a->width > 64)
+		p[1] = (p[1] & ~(mask >> (64 - s))) | code >> (64 - s);
+}
+
+/* Widens a w-bit code to the 64-bit format's code. */
+static inline u64 __intfp_packed_widen(const struct intfp_packed *a, u64 code) {
+	if (a->kind != INTFP_PACKED_LOG) return code;
+	/* Sign extension: the w-bit zero code becomes a negative, decoded as 0 */
+	return (u64)((s64)(code << (64 - a->width)) >> (64 - a->width));
+}
+
+/* Narrows a 64-bit code to w bits. */
+static inline u64 __intfp_packed_narrow(const struct intfp_packed *a, u64 code) {
+	if (a->kind == INTFP_PACKED_LOG && code == (u64)intfp_log_0(64))
+		return (u64)1 << (a->width - 1);
+	return code;
+}
+
+/* Saturates a decoded value to the array's value width. */
+static inline u64 __intfp_packed_sat(const struct intfp_packed *a, u64 v) {
+	u64 max = a->hbits == 64 ? ~(u64)0 : ((u64)1 << a->hbits) - 1;
+	return v > max ? max : v;
+}
+
+/** @brief Reads value i, decoded. */
+INTFP_API u64 intfp_packed_get(const struct intfp_packed *a, u64 i) {
+	u64 code = __intfp_packed_widen(a, intfp_packed_get_code(a, i));
+	return __intfp_packed_sat(a, __intfp_packed_conv1(a->kind, 0, code, a->fp));
+}
+
+/** @brief Encodes v (saturated to hbits) as value i. */
+INTFP_API void intfp_packed_set(struct intfp_packed *a, u64 i, u64 v) {
+	u64 code = __intfp_packed_conv1(a->kind, 1, __intfp_packed_sat(a, v), a->fp);
+	intfp_packed_set_code(a, i, __intfp_packed_narrow(a, code));
+}
+
+#if defined(__x86_64__) && defined(__GNUC__) && \
+	!defined(__KERNEL__) && !defined(INTFP_NO_SIMD)
+/*
+ * Unpacks whole groups of 8 codes of w <= 25 bits from code `first` (a
+ * multiple of 8, so the group starts on a byte). Each half of the vector
+ * takes 4 codes from its own 16-byte window through pshufb, then shifts
+ * and masks them in 32-bit lanes. Stops before a window passes `bytes`.
+ */
+static inline __attribute__((target("avx2"))) size_t __intfp_avx2_packed_unpack(u64 *codes,
+		const u8 *base, u64 bytes, u8 w, u64 first, size_t n) {
+	u8 ctl[32];
+	u32 sh[8];
+	unsigned hb = (4 * w) >> 3;  /* Start of the upper window */
+	for (unsigned j = 0; j < 8; j++) {
+		unsigned bit = j * w - (j < 4 ? 0 : 8 * hb);
+		for (unsigned b = 0; b < 4; b++)
+			ctl[4 * j + b] = (u8)((bit >> 3) + b);
+		sh[j] = bit & 7;
+	}
+	const __m256i c = _mm256_loadu_si256((const __m256i *)ctl);
+	const __m256i s = _mm256_loadu_si256((const __m256i *)sh);
+	const __m256i mask = _mm256_set1_epi32((int)(((u64)1 << w) - 1));
+	u64 at = first * w / 8;
+	size_t i = 0;
+	for (; i + 8 <= n && at + hb + 16 <= bytes; i += 8, at += w) {
+		__m256i v = _mm256_loadu2_m128i((const __m128i *)(base + at + hb),
+			(const __m128i *)(base + at));
+		v = _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(v, c), s), mask);
+		_mm256_storeu_si256((__m256i *)(codes + i),
+			_mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+		_mm256_storeu_si256((__m256i *)(codes + i + 4),
+			_mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+	}
+	return i;
+}
+
+/* Unpacks pairs of codes of w <= 32 bits: 64 bits at a time, split with pdep. */
+static inline __attribute__((target("bmi2"))) size_t __intfp_bmi2_packed_unpack(u64 *codes,
+		const u64 *words, u8 w, u64 first, size_t n) {
+	const u64 m2 = (((u64)1 << w) - 1) * ((u64)1 << 32 | 1);
+	size_t i = 0;
+	for (u64 pos = first * w; i + 2 <= n; i += 2, pos += 2 * (u64)w) {
+		const u64 *p = words + (pos >> 6);
+		unsigned s = pos & 63;
+		u64 x = _pdep_u64(p[0] >> s | (p[1] << 1) << (63 - s), m2);
+		codes[i] = (u32)x;
+		codes[i + 1] = x >> 32;
+	}
+	return i;
+}
+
+/*
+ * Packs whole groups of 64 codes of w <= 32 bits from code `first` (a
+ * multiple of 64, so each group fills exactly w words). Pairs of codes are
+ * joined with pext, which also drops their bits above w.
+ */
+static inline __attribute__((target("bmi2"))) size_t __intfp_bmi2_packed_pack(u64 *words,
+		u8 w, u64 first, const u64 *codes, size_t n) {
+	const u64 m2 = (((u64)1 << w) - 1) * ((u64)1 << 32 | 1);
+	const unsigned b = 2 * w;
+	u64 *out = words + first * w / 64;
+	size_t i = 0;
+	for (; i + 64 <= n; i += 64) {
+		u64 acc = 0;
+		unsigned nacc = 0;
+		for (size_t k = i; k < i + 64; k += 2) {
+			u64 pair = _pext_u64((u32)codes[k] | codes[k + 1] << 32, m2);
+			acc |= pair << nacc;
+			if (nacc + b >= 64) {
+				*out++ = acc;
+				acc = nacc ? pair >> (64 - nacc) : 0;
+				nacc = nacc + b - 64;
+			} else {
+				nacc += b;
+			}
+		}
+	}
+	return i;
+}
+
+#define __intfp_packed_unpack_simd(a, codes, first, n) ( \
+	(a)->width <= 25 && intfp_isa_get() >= INTFP_ISA_AVX2 && (first) % 8 == 0 ? \
+		__intfp_avx2_packed_unpack(codes, (const u8 *)(a)->words, \
+			8 * INTFP_PACKED_WORDS((a)->n, (a)->width), (a)->width, first, n) : \
+	(a)->width <= 32 && __intfp_isa_has_bmi2() ? \
+		__intfp_bmi2_packed_unpack(codes, (a)->words, (a)->width, first, n) : 0)
+#define __intfp_packed_pack_simd(a, first, codes, n) ( \
+	(a)->width <= 32 && __intfp_isa_has_bmi2() ? \
+		__intfp_bmi2_packed_pack((a)->words, (a)->width, first, codes, n) : 0)
+#else
+#define __intfp_packed_unpack_simd(a, codes, first, n) ((size_t)0)
+#define __intfp_packed_pack_simd(a, first, codes, n) ((size_t)0)
+#endif
+
+/* Limits a range to the array; returns its length. */
+static inline size_t __intfp_packed_clip(const struct intfp_packed *a, u64 first, size_t n) {
+	if (first >= a->n) return 0;
+	return n < a->n - first ? n : (size_t)(a->n - first);
+}
+
+/**
+ * @brief Reads codes [first, first + n) as they are stored (w bits each).
+ * @return The number read, fewer than n at the end of the array.
+ */
+INTFP_API size_t intfp_packed_unpack(const struct intfp_packed *a, u64 *codes, u64 first,
+		size_t n) {
+	n = __intfp_packed_clip(a, first, n);
+	size_t i = 0;
+	/* Up to the next group of 8, then the kernels, then the rest */
+	for (; i < n && (first + i) % 8; i++)
+		codes[i] = intfp_packed_get_code(a, first + i);
+	i += __intfp_packed_unpack_simd(a, codes + i, first + i, n - i);
+	for (; i < n; i++)
+		codes[i] = intfp_packed_get_code(a, first + i);
+	return n;
+}
+
+/**
+ * @brief Writes codes [first, first + n); bits above the width are dropped.
+ * @return The number written, fewer than n at the end of the array.
+ */
+INTFP_API size_t intfp_packed_pack(struct intfp_packed *a, u64 first, const u64 *codes,
+		size_t n) {
+	n = __intfp_packed_clip(a, first, n);
+	size_t i = 0;
+	/* Whole words are written for whole groups of 64 codes */
+	for (; i < n && (first + i) % 64; i++)
+		intfp_packed_set_code(a, first + i, codes[i]);
+	size_t k = __intfp_packed_pack_simd(a, first + i, codes + i, n - i);
+	if (!k) {
+		const u64 mask = ((u64)1 << a->width) - 1;
+		u64 *out = a->words + (first + i) * a->width / 64;
+		for (; k + 64 <= n - i; k += 64) {
+			u64 acc = 0;
+			unsigned nacc = 0;
+			for (size_t j = i + k; j < i + k + 64; j++) {
+				u64 c = codes[j] & mask;
+				acc |= c << nacc;
+				if (nacc + a->width >= 64) {
+					*out++ = acc;
+					acc = nacc ? c >> (64 - nacc) : 0;
+					nacc = nacc + a->width - 64;
+				} else {
+					nacc += a->width;
+				}
+			}
+		}
+	}
+	for (i += k; i < n; i++)
+		intfp_packed_set_code(a, first + i, codes[i]);
+	return n;
+}
+
+/**
+ * @brief Decodes values [first, first + n) into dst, of hbits each.
+ * @return The number decoded, fewer than n at the end of the array.
+ */
+INTFP_API size_t intfp_packed_decode(const struct intfp_packed *a, void *dst, u64 first,
+		size_t n) {
+	u64 codes[256], vals[256];
+	n = __intfp_packed_clip(a, first, n);
+	for (size_t i = 0; i < n; ) {
+		size_t m = (n - i < 256) ? n - i : 256;
+		intfp_packed_unpack(a, codes, first + i, m);
+		for (size_t k = 0; k < m; k++)
+			codes[k] = __intfp_packed_widen(a, codes[k]);
+		__intfp_packed_conv(a->kind, 0, vals, codes, m, a->fp);
+		for (size_t k = 0; k < m; k++, i++) {
+			u64 v = __intfp_packed_sat(a, vals[k]);
+			switch (a->hbits) {
+			case 8: ((u8 *)dst)[i] = (u8)v; break;
+			case 16: ((u16 *)dst)[i] = (u16)v; break;
+			case 32: ((u32 *)dst)[i] = (u32)v; break;
+			default: ((u64 *)dst)[i] = v; break;
+			}
+		}
+	}
+	return n;
+}
+
+/**
+ * @brief Encodes n values of hbits each from src as [first, first + n).
+ * @return The number encoded, fewer than n at the end of the array.
+ */
+INTFP_API size_t intfp_packed_encode(struct intfp_packed *a, u64 first, const void *src,
+		size_t n) {
+	u64 vals[256], codes[256];
+	n = __intfp_packed_clip(a, first, n);
+	for (size_t i = 0; i < n; ) {
+		size_t m = (n - i < 256) ? n - i : 256;
+		for (size_t k = 0; k < m; k++) {
+			switch (a->hbits) {
+			case 8: vals[k] = ((const u8 *)src)[i + k]; break;
+			case 16: vals[k] = ((const u16 *)src)[i + k]; break;
+			case 32: vals[k] = ((const u32 *)src)[i + k]; break;
+			default: vals[k] = ((const u64 *)src)[i + k]; break;
+			}
+		}
+		__intfp_packed_conv(a->kind, 1, codes, vals, m, a->fp);
+		for (size_t k = 0; k < m; k++)
+			codes[k] = __intfp_packed_narrow(a, codes[k]);
+		intfp_packed_pack(a, first + i, codes, m);
+		i += m;
+	}
+	return n;
+}
+
+#endif /* _INTFP_PACKED_H */
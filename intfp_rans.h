@@ -0,0 +1,457 @@
+#ifndef _INTFP_RANS_H
+#define _INTFP_RANS_H
+/*
+ * Integer-based Fixed-Point and Pseudo-Logarithmic Number Library (intfp)
+ * Entropy-coded 'pul' blocks
+ * Copyright (C) 2025 Masahito Suzuki
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * @file intfp_rans.h
+ * @brief A block codec that entropy-codes the exponents of 'pul8'/'pul16'.
+ *
+ * @details
+ * A 'pul' value is `exponent << fp | mantissa`. For u##hbits input the
+ * exponent takes one of hbits values, and on real data a few of them
+ * dominate, while the mantissa bits are close to uniform. The codec stores
+ * the two apart: the exponents with a static rANS coder whose frequencies
+ * are kept in the block, and the mantissas as a plain fp-bit stream. Decoding
+ * gives exactly the values of pul##lbits##fp_to_u##hbits(u##hbits##_to_pul##lbits##fp(v)).
+ *
+ * Block layout (little-endian; every block decodes on its own):
+ *
+ *   0   u32 size          bytes of the whole block
+ *   4   u32 n             values
+ *   8   u8  version (1), lbits, fp, nsym (= hbits)
+ *   12  u16 freq[nsym]    exponent frequencies, summing to 4096 (0 if n == 0)
+ *   ..  u32 state[32]     final coder states
+ *   ..  mantissas         n * fp bits, LSB first
+ *   ..  rANS words        u16, up to size
+ *
+ * rANS: 32-bit states below 2^31, 12-bit probabilities, 16-bit renormalization
+ * (L = 2^15). Value i is coded by state i % 32, so 32 independent chains can
+ * be decoded side by side. On x86-64 with AVX2 they are, as four vectors
+ * whose latencies overlap: a gather from the 4096-entry decode table, a
+ * multiply-add, and a refill of the lanes that fell below L from the next
+ * words, spread with vpermd. The encoder divides through per-symbol
+ * reciprocals.
+ */
+
+#include "intfp.h"
+
+/** @brief Worst-case size of a block of n values (u##hbits -> 'pul'##lbits). */
+#define INTFP_RANS_BOUND(hbits, lbits, n) \
+	(12 + 2 * (hbits) + 128 + ((size_t)(n) * (lbits) + 7) / 8 + 2 * (size_t)(n))
+
+#define __INTFP_RANS_VERSION 1
+#define __INTFP_RANS_PROB_BITS 12
+#define __INTFP_RANS_M (1u << __INTFP_RANS_PROB_BITS)
+#define __INTFP_RANS_L (1u << 15)
+#define __INTFP_RANS_WAYS 32
+#define __INTFP_RANS_CHUNK 1024  /* Values decoded per pass, a multiple of 8 */
+
+static inline u32 __intfp_rans_rd32(const u8 *p) {
+	return p[0] | (u32)p[1] << 8 | (u32)p[2] << 16 | (u32)p[3] << 24;
+}
+static inline void __intfp_rans_wr32(u8 *p, u32 v) {
+	p[0] = (u8)v; p[1] = (u8)(v >> 8); p[2] = (u8)(v >> 16); p[3] = (u8)(v >> 24);
+}
+
+/* Encoder constants of one symbol (reciprocal division, see ryg_rans). */
+struct __intfp_rans_sym {
+	u32 x_max, rcp_freq, bias;
+	u16 cmpl_freq;
+	u8 rcp_shift;
+};
+
+static inline void __intfp_rans_sym_init(struct __intfp_rans_sym *s, u32 cum, u32 freq) {
+	s->x_max = ((__INTFP_RANS_L >> __INTFP_RANS_PROB_BITS) << 16) * freq;
+	s->cmpl_freq = (u16)(__INTFP_RANS_M - freq);
+	if (freq < 2) {
+		s->rcp_freq = ~0u;
+		s->rcp_shift = 0;
+		s->bias = cum + __INTFP_RANS_M - 1;
+	} else {
+		u32 shift = 0;
+		while (freq > (1u << shift)) shift++;
+		s->rcp_freq = (u32)(((1ull << (shift + 31)) + freq - 1) / freq);
+		s->rcp_shift = (u8)(shift - 1);
+		s->bias = cum;
+	}
+}
+
+/*
+ * Encodes one symbol into state x, pushing a word below *pp if needed. The
+ * word is stored either way and only kept by moving *pp, as the branch is
+ * random; the stray store lands where the next word goes.
+ */
+static inline u32 __intfp_rans_put(u32 x, const struct __intfp_rans_sym *s, u8 **pp) {
+	u32 out = x >= s->x_max;
+	(*pp)[-2] = (u8)x;
+	(*pp)[-1] = (u8)(x >> 8);
+	*pp -= 2 * out;
+	x >>= 16 * out;
+	u32 q = (u32)(((u64)x * s->rcp_freq) >> 32) >> s->rcp_shift;
+	return x + s->bias + q * s->cmpl_freq;
+}
+
+/*
+ * Scales symbol counts of n values to frequencies summing to 4096, keeping
+ * every used symbol at 1 or more.
+ */
+static inline void __intfp_rans_norm(const u32 *count, u32 *freq, unsigned nsym, u32 n) {
+	u32 sum = 0;
+	unsigned big = 0;
+	for (unsigned s = 0; s < nsym; s++) {
+		freq[s] = count[s] ? (u32)((u64)count[s] * __INTFP_RANS_M / n) : 0;
+		if (count[s] && !freq[s]) freq[s] = 1;
+		sum += freq[s];
+		if (count[s] > count[big]) big = s;
+	}
+	while (sum > __INTFP_RANS_M) {
+		unsigned top = 0;
+		for (unsigned s = 1; s < nsym; s++)
+			if (freq[s] > freq[top]) top = s;
+		freq[top]--;
+		sum--;
+	}
+	freq[big] += __INTFP_RANS_M - sum;
+}
+
+/*
+ * Decode table entry per slot: symbol | (freq - 1) << 8 | (slot - cum) << 20.
+ * Decoding a state x is then x = freq * (x >> 12) + (slot - cum).
+ */
+static inline void __intfp_rans_table(u32 *tab, const u32 *freq, unsigned nsym) {
+	u32 cum = 0;
+	for (unsigned s = 0; s < nsym; s++) {
+		for (u32 k = 0; k < freq[s]; k++)
+			tab[cum + k] = s | (freq[s] - 1) << 8 | k << 20;
+		cum += freq[s];
+	}
+}
+
+/*
+ * Decodes n symbols (i % 32 picks the state) with the scalar loop. Returns
+ * 0 if the words run out before end.
+ */
+static inline int __intfp_rans_dec_scalar(u8 *sym, size_t n, u32 *x, const u32 *tab,
+		const u8 **pp, const u8 *end) {
+	const u8 *p = *pp;
+	for (size_t i = 0; i < n; i++) {
+		u32 *s = &x[i & (__INTFP_RANS_WAYS - 1)];
+		u32 e = tab[*s & (__INTFP_RANS_M - 1)];
+		sym[i] = (u8)e;
+		*s = ((e >> 8 & 0xfff) + 1) * (*s >> __INTFP_RANS_PROB_BITS) + (e >> 20);
+		/* Branch-free refill, as whether a state needs one is random */
+		if (end - p >= 2) {
+			u32 in = *s < __INTFP_RANS_L;
+			u32 r = *s << 16 | p[0] | (u32)p[1] << 8;
+			*s = in ? r : *s;
+			p += 2 * in;
+		} else if (*s < __INTFP_RANS_L) {
+			return 0;
+		}
+	}
+	*pp = p;
+	return 1;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__) && \
+	!defined(__KERNEL__) && !defined(INTFP_NO_SIMD)
+/* Rank of lane i among the set bits of m: where its refill word sits. */
+#define __intfp_rans_rank(m, i) ( \
+	((i) > 0 && ((m) & 1)) + ((i) > 1 && ((m) & 2)) + ((i) > 2 && ((m) & 4)) + \
+	((i) > 3 && ((m) & 8)) + ((i) > 4 && ((m) & 16)) + ((i) > 5 && ((m) & 32)) + \
+	((i) > 6 && ((m) & 64)))
+#define __intfp_rans_perm1(m) { __intfp_rans_rank(m, 0), __intfp_rans_rank(m, 1), \
+	__intfp_rans_rank(m, 2), __intfp_rans_rank(m, 3), __intfp_rans_rank(m, 4), \
+	__intfp_rans_rank(m, 5), __intfp_rans_rank(m, 6), __intfp_rans_rank(m, 7) }
+#define __intfp_rans_perm4(m) __intfp_rans_perm1(m), __intfp_rans_perm1((m) + 1), \
+	__intfp_rans_perm1((m) + 2), __intfp_rans_perm1((m) + 3)
+#define __intfp_rans_perm16(m) __intfp_rans_perm4(m), __intfp_rans_perm4((m) + 4), \
+	__intfp_rans_perm4((m) + 8), __intfp_rans_perm4((m) + 12)
+#define __intfp_rans_perm64(m) __intfp_rans_perm16(m), __intfp_rans_perm16((m) + 16), \
+	__intfp_rans_perm16((m) + 32), __intfp_rans_perm16((m) + 48)
+
+/* vpermd indices that move the k-th loaded word to the k-th refilled lane. */
+__INTFP_TABLE u8 __intfp_rans_perm[256][8] __intfp_table_init({
+	__intfp_rans_perm64(0), __intfp_rans_perm64(64),
+	__intfp_rans_perm64(128), __intfp_rans_perm64(192)
+});
+
+/* Decodes one vector of 8 states (AVX2) and refills it from *pp. */
+static inline __attribute__((target("avx2,popcnt"))) __m256i __intfp_avx2_rans_step(__m256i x,
+		u8 *sym, const u32 *tab, const u8 **pp) {
+	const __m256i pick = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, 0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	u32 ix[8] __attribute__((aligned(32)));
+	_mm256_store_si256((__m256i *)ix, _mm256_and_si256(x, _mm256_set1_epi32(__INTFP_RANS_M - 1)));
+	__m256i e = _mm256_setr_epi32(tab[ix[0]], tab[ix[1]], tab[ix[2]], tab[ix[3]],
+		tab[ix[4]], tab[ix[5]], tab[ix[6]], tab[ix[7]]);
+	__m256i f = _mm256_add_epi32(_mm256_and_si256(_mm256_srli_epi32(e, 8),
+		_mm256_set1_epi32(0xfff)), _mm256_set1_epi32(1));
+	x = _mm256_add_epi32(_mm256_mullo_epi32(f, _mm256_srli_epi32(x, __INTFP_RANS_PROB_BITS)),
+		_mm256_srli_epi32(e, 20));
+	__m256i b = _mm256_shuffle_epi8(e, pick);
+	u32 lo = (u32)_mm256_cvtsi256_si32(b), hi = (u32)_mm256_extract_epi32(b, 4);
+	__builtin_memcpy(sym, &lo, 4);
+	__builtin_memcpy(sym + 4, &hi, 4);
+	__m256i need = _mm256_cmpgt_epi32(_mm256_set1_epi32(__INTFP_RANS_L), x);
+	int m = _mm256_movemask_ps(_mm256_castsi256_ps(need));
+	__m256i w = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)*pp));
+	w = _mm256_permutevar8x32_epi32(w,
+		_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)__intfp_rans_perm[m])));
+	*pp += 2 * __builtin_popcount(m);
+	return _mm256_blendv_epi8(x, _mm256_or_si256(_mm256_slli_epi32(x, 16), w), need);
+}
+
+/*
+ * AVX2 form of __intfp_rans_dec_scalar() for whole groups of 32, while 64
+ * bytes of words remain. Returns the number of symbols decoded.
+ */
+static inline __attribute__((target("avx2,popcnt"))) size_t __intfp_avx2_rans_dec(u8 *sym,
+		size_t n, u32 *state, const u32 *tab, const u8 **pp, const u8 *end) {
+	__m256i x0 = _mm256_loadu_si256((const __m256i *)state);
+	__m256i x1 = _mm256_loadu_si256((const __m256i *)(state + 8));
+	__m256i x2 = _mm256_loadu_si256((const __m256i *)(state + 16));
+	__m256i x3 = _mm256_loadu_si256((const __m256i *)(state + 24));
+	size_t i = 0;
+	for (; i + 32 <= n && end - *pp >= 64; i += 32) {
+		x0 = __intfp_avx2_rans_step(x0, sym + i, tab, pp);
+		x1 = __intfp_avx2_rans_step(x1, sym + i + 8, tab, pp);
+		x2 = __intfp_avx2_rans_step(x2, sym + i + 16, tab, pp);
+		x3 = __intfp_avx2_rans_step(x3, sym + i + 24, tab, pp);
+	}
+	_mm256_storeu_si256((__m256i *)state, x0);
+	_mm256_storeu_si256((__m256i *)(state + 8), x1);
+	_mm256_storeu_si256((__m256i *)(state + 16), x2);
+	_mm256_storeu_si256((__m256i *)(state + 24), x3);
+	return i;
+}
+/*
+ * Builds the codes sym << fp | mantissa of whole groups of 8 values (AVX2).
+ * A group takes exactly fp bytes from byte `first` on, and is spread to
+ * 32-bit lanes with one pshufb from a 16-byte load, so the loop stops 16
+ * bytes before `avail`. Returns the number of codes written.
+ */
+static inline __attribute__((target("avx2"))) size_t __intfp_avx2_rans_codes(void *codes,
+		int lbits, const u8 *sym, size_t n, const u8 *mant, size_t first, size_t avail, u8 fp) {
+	u8 ctl[32];
+	u32 sh[8];
+	for (int j = 0; j < 8; j++) {
+		for (int b = 0; b < 4; b++)
+			ctl[4 * j + b] = (u8)(((j * fp) >> 3) + b);
+		sh[j] = (u32)(j * fp) & 7;
+	}
+	const __m256i c = _mm256_loadu_si256((const __m256i *)ctl);
+	const __m256i s = _mm256_loadu_si256((const __m256i *)sh);
+	const __m256i mask = _mm256_set1_epi32((1 << fp) - 1);
+	const __m128i up = _mm_cvtsi32_si128(fp);
+	size_t i = 0;
+	for (; i + 8 <= n && first + 16 <= avail; i += 8, first += fp) {
+		__m128i raw = _mm_loadu_si128((const __m128i *)(mant + first));
+		__m256i v = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(raw), c);
+		v = _mm256_and_si256(_mm256_srlv_epi32(v, s), mask);
+		v = _mm256_or_si256(v, _mm256_sll_epi32(
+			_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(sym + i))), up));
+		__m128i r = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+		if (lbits == 16)
+			_mm_storeu_si128((__m128i *)((u16 *)codes + i), r);
+		else
+			_mm_storel_epi64((__m128i *)((u8 *)codes + i), _mm_packus_epi16(r, r));
+	}
+	return i;
+}
+#define __intfp_rans_dec_simd(sym, n, x, tab, pp, end) \
+	(intfp_isa_get() >= INTFP_ISA_AVX2 ? __intfp_avx2_rans_dec(sym, n, x, tab, pp, end) : 0)
+#define __intfp_rans_codes_simd(codes, lbits, sym, n, mant, first, avail, fp) \
+	(intfp_isa_get() >= INTFP_ISA_AVX2 ? \
+		__intfp_avx2_rans_codes(codes, lbits, sym, n, mant, first, avail, fp) : 0)
+#else
+#define __intfp_rans_dec_simd(sym, n, x, tab, pp, end) ((size_t)0)
+#define __intfp_rans_codes_simd(codes, lbits, sym, n, mant, first, avail, fp) ((size_t)0)
+#endif
+
+/* Reads nbits (<= 16) at bit pos of a LSB-first stream of `bytes` bytes. */
+static inline u32 __intfp_rans_bits(const u8 *p, size_t bytes, size_t pos, u8 nbits) {
+	size_t b = pos >> 3;
+	u32 w;
+	if (b + 4 <= bytes) {
+		w = __intfp_rans_rd32(p + b);
+	} else {
+		w = 0;
+		for (size_t k = 0; b + k < bytes; k++)
+			w |= (u32)p[b + k] << (8 * k);
+	}
+	return (w >> (pos & 7)) & ((1u << nbits) - 1);
+}
+
+/**
+ * @brief Generates the entropy-coded block codec of one width pair.
+ */
+#define INTFP_DECL_RANS(hbits, lbits) \
+/** \
+ * @brief Encodes n values as one block of entropy-coded 'pul##lbits' values. \
+ * @param dst Output, at least INTFP_RANS_BOUND(hbits, lbits, n) bytes. \
+ * @param cap Size of dst. \
+ * @param ofp Mantissa bits of the 'pul' values, 1 to intfp_pul_fpmax(hbits, lbits). \
+ * @return The block size in bytes, or 0 if cap is too small, n too large or \
+ *         ofp out of range. \
+ */ \
+INTFP_API size_t u##hbits##_to_pul##lbits##fp_rans(u8 *dst, size_t cap, \
+		const u##hbits *src, size_t n, u8 ofp) { \
+	u32 count[hbits] = { 0 }, freq[hbits]; \
+	u##lbits codes[__INTFP_RANS_CHUNK]; \
+	struct __intfp_rans_sym syms[hbits]; \
+	if (cap < INTFP_RANS_BOUND(hbits, lbits, n) || n > 0xffffffffu || \
+	    ofp == 0 || ofp > INTFP_PUL_FPMAX(hbits, lbits)) \
+		return 0; \
+	u8 *states = dst + 12 + 2 * hbits, *mant = states + 4 * __INTFP_RANS_WAYS, *mp = mant; \
+	u64 acc = 0; \
+	unsigned nacc = 0; \
+	/* Pass 1: exponent histogram and mantissa stream */ \
+	for (size_t i = 0; i < n; i += __INTFP_RANS_CHUNK) { \
+		size_t m = (n - i < __INTFP_RANS_CHUNK) ? n - i : __INTFP_RANS_CHUNK; \
+		u##hbits##_to_pul##lbits##fp_array(codes, src + i, m, ofp); \
+		for (size_t k = 0; k < m; k++) { \
+			count[codes[k] >> ofp]++; \
+			acc |= (u64)(codes[k] & ((1u << ofp) - 1)) << nacc; \
+			nacc += ofp; \
+			if (nacc >= 32) { \
+				__intfp_rans_wr32(mp, (u32)acc); \
+				mp += 4; \
+				acc >>= 32; \
+				nacc -= 32; \
+			} \
+		} \
+	} \
+	for (; nacc > 0; nacc = nacc > 8 ? nacc - 8 : 0, acc >>= 8) \
+		*mp++ = (u8)acc; \
+	u32 cum = 0; \
+	if (n) __intfp_rans_norm(count, freq, hbits, (u32)n); \
+	for (unsigned s = 0; s < hbits; s++) { \
+		u32 f = n ? freq[s] : 0; \
+		dst[12 + 2 * s] = (u8)f; \
+		dst[13 + 2 * s] = (u8)(f >> 8); \
+		__intfp_rans_sym_init(&syms[s], cum, f); \
+		cum += f; \
+	} \
+	/* Pass 2, backwards: rANS words from the end of dst */ \
+	u32 x[__INTFP_RANS_WAYS]; \
+	for (int j = 0; j < __INTFP_RANS_WAYS; j++) \
+		x[j] = __INTFP_RANS_L; \
+	u8 *w = dst + cap; \
+	for (size_t i = n; i > 0; ) { \
+		size_t m = (i % __INTFP_RANS_CHUNK) ? i % __INTFP_RANS_CHUNK : __INTFP_RANS_CHUNK; \
+		i -= m; \
+		u##hbits##_to_pul##lbits##fp_array(codes, src + i, m, ofp); \
+		for (size_t k = m; k-- > 0; ) { \
+			u32 *s = &x[(i + k) & (__INTFP_RANS_WAYS - 1)]; \
+			*s = __intfp_rans_put(*s, &syms[codes[k] >> ofp], &w); \
+		} \
+	} \
+	for (int j = 0; j < __INTFP_RANS_WAYS; j++) \
+		__intfp_rans_wr32(states + 4 * j, x[j]); \
+	size_t words = (size_t)(dst + cap - w); \
+	__builtin_memmove(mp, w, words); \
+	size_t size = (size_t)(mp + words - dst); \
+	__intfp_rans_wr32(dst, (u32)size); \
+	__intfp_rans_wr32(dst + 4, (u32)n); \
+	dst[8] = __INTFP_RANS_VERSION; \
+	dst[9] = lbits; \
+	dst[10] = ofp; \
+	dst[11] = hbits; \
+	return size; \
+} \
+/** \
+ * @brief Decodes one block from u##hbits##_to_pul##lbits##fp_rans(). \
+ * The fp is read from the block. Every length and frequency is checked, \
+ * so a damaged block is refused rather than read past its end. \
+ * @param dst Output for up to max_n values. \
+ * @param src The block; size may extend past it (e.g. a whole stream). \
+ * @return The number of values, or (size_t)-1 for a damaged block, or one \
+ *         of more than max_n values or of another format. \
+ */ \
+INTFP_API size_t pul##lbits##fp_rans_to_u##hbits(u##hbits *dst, size_t max_n, \
+		const u8 *src, size_t size) { \
+	u32 freq[hbits], tab[__INTFP_RANS_M], x[__INTFP_RANS_WAYS]; \
+	u8 sym[__INTFP_RANS_CHUNK]; \
+	u##lbits codes[__INTFP_RANS_CHUNK]; \
+	if (size < 12) return (size_t)-1; \
+	size_t bsize = __intfp_rans_rd32(src), n = __intfp_rans_rd32(src + 4); \
+	u8 fp = src[10]; \
+	if (bsize > size || bsize < 12 || src[8] != __INTFP_RANS_VERSION || src[9] != lbits || \
+	    src[11] != hbits || fp == 0 || fp > INTFP_PUL_FPMAX(hbits, lbits) || n > max_n) \
+		return (size_t)-1; \
+	if (n == 0) return 0; \
+	const u8 *p = src + 12 + 2 * hbits, *end = src + bsize; \
+	size_t mant_bytes = (n * fp + 7) / 8; \
+	if (bsize < 12 + 2 * hbits + 4 * __INTFP_RANS_WAYS + mant_bytes) return (size_t)-1; \
+	u32 sum = 0; \
+	for (unsigned s = 0; s < hbits; s++) { \
+		freq[s] = src[12 + 2 * s] | (u32)src[13 + 2 * s] << 8; \
+		sum += freq[s]; \
+	} \
+	if (sum != __INTFP_RANS_M) return (size_t)-1; \
+	__intfp_rans_table(tab, freq, hbits); \
+	for (int j = 0; j < __INTFP_RANS_WAYS; j++, p += 4) \
+		x[j] = __intfp_rans_rd32(p); \
+	const u8 *mant = p; \
+	p += mant_bytes; \
+	for (size_t i = 0; i < n; i += __INTFP_RANS_CHUNK) { \
+		size_t m = (n - i < __INTFP_RANS_CHUNK) ? n - i : __INTFP_RANS_CHUNK; \
+		size_t k = __intfp_rans_dec_simd(sym, m, x, tab, &p, end); \
+		if (!__intfp_rans_dec_scalar(sym + k, m - k, x, tab, &p, end)) \
+			return (size_t)-1; \
+		k = __intfp_rans_codes_simd(codes, lbits, sym, m, mant, i * fp / 8, \
+			(size_t)(end - mant), fp); \
+		for (; k < m; k++) \
+			codes[k] = (u##lbits)((u32)sym[k] << fp | \
+				__intfp_rans_bits(mant, mant_bytes, (i + k) * fp, fp)); \
+		pul##lbits##fp_to_u##hbits##_array(dst + i, codes, m, fp); \
+	} \
+	/* The encoder started every state at L and used every word */ \
+	for (int j = 0; j < __INTFP_RANS_WAYS; j++) \
+		if (x[j] != __INTFP_RANS_L) return (size_t)-1; \
+	return p == end ? n : (size_t)-1; \
+}
+
+/* Generate the codec for the 'pul8' and 'pul16' width pairs */
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_8_8)
+__intfp_if_pul(INTFP_DECL_RANS( 8, 8))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_8)
+__intfp_if_pul(INTFP_DECL_RANS(16, 8))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_8)
+__intfp_if_pul(INTFP_DECL_RANS(32, 8))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
+__intfp_if_pul(INTFP_DECL_RANS(64, 8))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_16)
+__intfp_if_pul(INTFP_DECL_RANS(16,16))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_16)
+__intfp_if_pul(INTFP_DECL_RANS(32,16))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+__intfp_if_pul(INTFP_DECL_RANS(64,16))
+#endif
+
+#endif /* _INTFP_RANS_H */
@@ -0,0 +1,235 @@
+#ifndef _INTFP_RES_H
+#define _INTFP_RES_H
+/*
+ * Integer-based Fixed-Point and Pseudo-Logarithmic Number Library (intfp)
+ * Lossless 'pul': the codes plus a stream of the bits they drop
+ * Copyright (C) 2025 Masahito Suzuki
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * @file intfp_res.h
+ * @brief Exact reconstruction of 'pul' values from a separate residual stream.
+ *
+ * @details
+ * u##hbits##_to_pul##lbits##fp() keeps the leading 1 and the next fp bits of
+ * a value and truncates the rest, so pul##lbits##fp_to_u##hbits() returns the
+ * value with its low bits cleared. How many bits were dropped follows from
+ * the code alone: its exponent field (the value's bit length - 1) - fp, or
+ * none if that is not positive. The
+ * residual stream holds exactly those bits of each value in turn, LSB first,
+ * with no header or padding. Readers of the approximation use the codes as
+ * before and never touch the residuals; OR-ing each value's residual into
+ * its decoded code gives the value back.
+ *
+ * Because the residual widths come from the codes, the bit offset of value i
+ * is pul##lbits##fp_res_bits() of the codes before it, so a range can be
+ * reconstructed without reading the residuals in front of it.
+ */
+
+#include "intfp.h"
+
+/** @brief Worst-case residual bytes of n hbits-bit values with fp mantissa bits. */
+#define INTFP_RES_BOUND(hbits, n, fp) (((size_t)(n) * ((hbits) - 1 - (fp)) + 7) / 8)
+
+/* Residual bits of a code: those the truncation dropped */
+#define __intfp_res_width(code, fp) \
+	((unsigned)((code) >> (fp)) > (fp) ? (unsigned)((code) >> (fp)) - (fp) : 0)
+
+/* Little-endian words, as single loads and stores where the byte order allows */
+static inline u64 __intfp_res_rd64(const u8 *p) {
+	u64 v = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	__builtin_memcpy(&v, p, 8);
+#else
+	for (int k = 7; k >= 0; k--)
+		v = v << 8 | p[k];
+#endif
+	return v;
+}
+static inline void __intfp_res_wr64(u8 *p, u64 v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	__builtin_memcpy(p, &v, 8);
+#else
+	for (int k = 0; k < 8; k++)
+		p[k] = (u8)(v >> (8 * k));
+#endif
+}
+
+/*
+ * Reads nbits (<= 62) at bit pos of an LSB-first stream of `bytes` bytes:
+ * from two whole words when 16 bytes are left, else byte by byte, as zeros
+ * past the end.
+ */
+static inline u64 __intfp_res_get(const u8 *p, size_t bytes, u64 pos, unsigned nbits) {
+	u64 b = pos >> 3, w;
+	unsigned s = pos & 7;
+	if (b + 16 <= bytes) {
+		w = __intfp_res_rd64(p + b) >> s | (__intfp_res_rd64(p + b + 8) << 1) << (63 - s);
+	} else {
+		w = 0;
+		for (u64 k = 0; k < 9 && b + k < bytes; k++)
+			w |= k < 8 ? (u64)p[b + k] << (8 * k) >> s : ((u64)p[b + k] << 1) << (63 - s);
+	}
+	return w & (((u64)1 << nbits) - 1);
+}
+
+/*
+ * An LSB-first bit writer. The fast put stores a whole word per call and
+ * keeps fewer than 8 bits pending, so it takes up to 56 bits but needs 8
+ * bytes of room; the safe put stores only whole bytes.
+ */
+struct __intfp_res_writer {
+	u8 *p;
+	u64 acc;
+	unsigned nacc;
+};
+
+/*
+ * Appends nbits (<= 56) of r, which has no bits above them, with one store
+ * of a whole u64: there must be 8 bytes of room from w->p.
+ */
+static inline void __intfp_res_put_fast(struct __intfp_res_writer *w, u64 r, unsigned nbits) {
+	w->acc |= r << w->nacc;
+	w->nacc += nbits;
+	__intfp_res_wr64(w->p, w->acc);
+	w->p += w->nacc >> 3;
+	w->acc >>= w->nacc & ~7u;
+	w->nacc &= 7;
+}
+/*
+ * As __intfp_res_put_fast(), a byte at a time and without writing past the
+ * last whole byte: for the end of res, where 8 bytes of room are not left.
+ */
+static inline void __intfp_res_put(struct __intfp_res_writer *w, u64 r, unsigned nbits) {
+	w->acc |= r << w->nacc;
+	w->nacc += nbits;
+	for (; w->nacc >= 8; w->nacc -= 8, w->acc >>= 8)
+		*w->p++ = (u8)w->acc;
+}
+
+#define INTFP_DECL_RES_BITS(lbits) \
+/** \
+ * @brief Counts the residual bits of n 'pul##lbits' codes with fp mantissa bits. \
+ * This is also the bit offset of code n's residual in a stream that starts at code 0. \
+ */ \
+INTFP_API u64 pul##lbits##fp_res_bits(const u##lbits *codes, size_t n, u8 fp) { \
+	u64 bits = 0; \
+	for (size_t i = 0; i < n; i++) \
+		bits += __intfp_res_width(codes[i], fp); \
+	return bits; \
+}
+__intfp_if_pul(INTFP_DECL_RES_BITS(8))
+__intfp_if_pul(INTFP_DECL_RES_BITS(16))
+__intfp_if_pul(INTFP_DECL_RES_BITS(32))
+__intfp_if_pul(INTFP_DECL_RES_BITS(64))
+
+#define INTFP_DECL_RES(hbits, lbits) \
+/** \
+ * @brief Encodes n values as 'pul##lbits' codes and their residual stream. \
+ * @param codes Output, n codes: exactly those of u##hbits##_to_pul##lbits##fp_array(). \
+ * @param res Output, the residual stream. \
+ * @param cap Size of res; INTFP_RES_BOUND(hbits, n, ofp) is always enough. \
+ *        Bytes of res past the returned size may be overwritten. \
+ * @return Bytes of residuals, or (size_t)-1 if ofp is 0 or cap is too small. \
+ */ \
+INTFP_API size_t u##hbits##_to_pul##lbits##fp_res(u##lbits *codes, u8 *res, size_t cap, \
+		const u##hbits *src, size_t n, u8 ofp) { \
+	if (ofp == 0) \
+		return (size_t)-1; \
+	u##hbits##_to_pul##lbits##fp_array(codes, src, n, ofp); \
+	u64 bits = pul##lbits##fp_res_bits(codes, n, ofp); \
+	if ((bits + 7) / 8 > cap) \
+		return (size_t)-1; \
+	struct __intfp_res_writer w = { res, 0, 0 }; \
+	for (size_t i = 0; i < n; i++) { \
+		unsigned nbits = __intfp_res_width(codes[i], ofp); \
+		u64 r = (u64)src[i] & (((u64)1 << nbits) - 1); \
+		if (nbits > 56) { \
+			/* Only 'pul' with fewer than 7 mantissa bits of u64 gets here */ \
+			__intfp_res_put(&w, r & 0xffffffff, 32); \
+			r >>= 32; \
+			nbits -= 32; \
+		} \
+		if (w.p + 8 <= res + cap) \
+			__intfp_res_put_fast(&w, r, nbits); \
+		else \
+			__intfp_res_put(&w, r, nbits); \
+	} \
+	if (w.nacc) \
+		*w.p = (u8)w.acc; \
+	return (size_t)((bits + 7) / 8); \
+} \
+\
+/** \
+ * @brief Reconstructs n values exactly from their codes and residuals. \
+ * @param res The residual stream, of `size` bytes. \
+ * @param pos Bit offset of codes[0]'s residual: 0, or \
+ *        pul##lbits##fp_res_bits() of the codes before it. \
+ * @return 0, or -1 if ifp is 0, the residuals end early, or a code is not \
+ *         one of u##hbits##_to_pul##lbits##fp() (exponent past hbits - 1, or \
+ *         mantissa bits below a small value's lowest bit). \
+ */ \
+INTFP_API int pul##lbits##fp_res_to_u##hbits(u##hbits *dst, const u##lbits *codes, size_t n, \
+		const u8 *res, size_t size, u64 pos, u8 ifp) { \
+	if (ifp == 0) \
+		return -1; \
+	pul##lbits##fp_to_u##hbits##_array(dst, codes, n, ifp); \
+	for (size_t i = 0; i < n; i++) { \
+		u##lbits e = codes[i] >> ifp; \
+		/* Checked before the read: a bad code's width is unbounded */ \
+		if (e > hbits - 1 || (e < ifp && codes[i] != intfp_pul_0(lbits) && \
+		    (codes[i] & (((u##lbits)1 << (ifp - e)) - 1)))) \
+			return -1; \
+		unsigned nbits = __intfp_res_width(codes[i], ifp); \
+		dst[i] |= (u##hbits)__intfp_res_get(res, size, pos, nbits); \
+		pos += nbits; \
+	} \
+	return pos > (u64)size * 8 ? -1 : 0; \
+}
+
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_8_8)
+__intfp_if_pul(INTFP_DECL_RES( 8, 8))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_8)
+__intfp_if_pul(INTFP_DECL_RES(16, 8))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_8)
+__intfp_if_pul(INTFP_DECL_RES(32, 8))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
+__intfp_if_pul(INTFP_DECL_RES(64, 8))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_16)
+__intfp_if_pul(INTFP_DECL_RES(16,16))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_16)
+__intfp_if_pul(INTFP_DECL_RES(32,16))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+__intfp_if_pul(INTFP_DECL_RES(64,16))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_32)
+__intfp_if_pul(INTFP_DECL_RES(32,32))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_32)
+__intfp_if_pul(INTFP_DECL_RES(64,32))
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_64)
+__intfp_if_pul(INTFP_DECL_RES(64,64))
+#endif
+
+#endif /* _INTFP_RES_H */
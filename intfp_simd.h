@@ -0,0 +1,986 @@
+#ifndef _INTFP_SIMD_H
+#define _INTFP_SIMD_H
+/*
+ * Integer-based Fixed-Point and Pseudo-Logarithmic Number Library (intfp)
+ * x86 SIMD batch kernels
+ * Copyright (C) 2025 Masahito Suzuki
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * @file intfp_simd.h
+ * @brief AVX2 and AVX-512 kernels behind the `_array` batch conversions.
+ *
+ * @details
+ * This file is included by intfp.h on x86-64 user-space builds and must not
+ * be included directly. Every kernel is compiled with a per-function target
+ * attribute, so the including translation unit does not need -mavx2; the
+ * widest instruction set supported by the running CPU is selected once
+ * through cpuid (see intfp_isa_get()) and can be lowered for testing with
+ * intfp_isa_set().
+ *
+ * Kernels work on lanes of W = 32 bits (hbits <= 32) or W = 64 bits
+ * (hbits == 64). Narrow inputs are zero/sign-extended into the lanes and
+ * results are truncated back on store, which is exactly the modular
+ * arithmetic the scalar code performs. Normalizing inside a W-bit lane
+ * instead of an hbits-bit one leaves the exponent `hbits-2-clz` unchanged,
+ * so one kernel body serves every width pair.
+ *
+ * Count-leading-zeros:
+ * - AVX-512CD: vplzcntd / vplzcntq.
+ * - AVX2: float-exponent trick. Bits that could make cvtdq2ps round the
+ *   leading one up are cleared first (v & ~(v >> 8)), then
+ *   clz = clamp(158 - biased_exponent, 0, 32). Lanes with bit 31 set convert
+ *   to negative floats, whose sign bit drives the result below zero and is
+ *   clamped to 0. 64-bit lanes combine the clz of both halves.
+ *
+ * Correction LUTs (_corr / _corr_n):
+ * - AVX-512BW: the 512-byte table stays in eight zmm registers for the whole
+ *   call and is read with four vpermi2w and three blends, no memory access.
+ * - AVX2: aligned dword gathers.
+ */
+
+#include <immintrin.h>
+
+#define __intfp_avx2_fn   static inline __attribute__((target("avx2")))
+#define __intfp_avx512_fn static inline __attribute__((target("avx2,avx512f,avx512cd,avx512bw")))
+#define __intfp_avx512vbmi_fn static inline \
+	__attribute__((target("avx2,avx512f,avx512cd,avx512bw,avx512vbmi")))
+
+/* Primitive name for instruction set `isa` and lane width `W`. */
+#define __IV(isa, W, op) __intfp_##isa##_##W##_##op
+
+/* --- AVX2, 32-bit lanes --- */
+typedef __m256i __intfp_avx2_32_v;
+typedef __m256i __intfp_avx2_32_m;
+__intfp_avx2_fn __m256i __intfp_avx2_32_set1(s64 x) { return _mm256_set1_epi32((int)x); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_sub(__m256i a, __m256i b) { return _mm256_sub_epi32(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_and(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_or(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_xor(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_sllv(__m256i a, __m256i n) { return _mm256_sllv_epi32(a, n); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_srlv(__m256i a, __m256i n) { return _mm256_srlv_epi32(a, n); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_slli(__m256i a, int n) { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_srli(__m256i a, int n) { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_cmpeq(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_cmpgt(__m256i a, __m256i b) { return _mm256_cmpgt_epi32(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_blend(__m256i m, __m256i a, __m256i b) { return _mm256_blendv_epi8(a, b, m); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_abs(__m256i a) { return _mm256_abs_epi32(a); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_neg_if(__m256i m, __m256i a) {
+	return _mm256_blendv_epi8(a, _mm256_sub_epi32(_mm256_setzero_si256(), a), m);
+}
+__intfp_avx2_fn __m256i __intfp_avx2_32_clz(__m256i v) {
+	__m256i x = _mm256_andnot_si256(_mm256_srli_epi32(v, 8), v);
+	__m256i e = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(x)), 23);
+	__m256i c = _mm256_sub_epi32(_mm256_set1_epi32(158), e);
+	c = _mm256_max_epi32(c, _mm256_setzero_si256());
+	return _mm256_min_epi32(c, _mm256_set1_epi32(32));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_32_mul(__m256i a, __m256i b) { return _mm256_mullo_epi32(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_mand(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_32_mor(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+/*
+ * Correction LUT lookup of idx (0..255) per lane. AVX2 has no wide enough
+ * in-register permute, so this gathers the aligned dword holding entries
+ * (idx & ~1, idx | 1) and shifts the wanted half down; the read never
+ * leaves the first 256 entries.
+ */
+typedef const u16 *__intfp_avx2_32_lut_t;
+__intfp_avx2_fn const u16 *__intfp_avx2_32_lut_load(const u16 *lut) { return lut; }
+__intfp_avx2_fn __m256i __intfp_avx2_32_lut(const u16 *lut, __m256i idx) {
+	__m256i d = _mm256_i32gather_epi32((const int *)lut, _mm256_srli_epi32(idx, 1), 4);
+	d = _mm256_srlv_epi32(d, _mm256_slli_epi32(_mm256_and_si256(idx, _mm256_set1_epi32(1)), 4));
+	return _mm256_and_si256(d, _mm256_set1_epi32(0xffff));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_32_load_u8(const void *p) {
+	return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_32_load_s8(const void *p) {
+	return _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_32_load_u16(const void *p) {
+	return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_32_load_s16(const void *p) {
+	return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_32_load_u32(const void *p) {
+	return _mm256_loadu_si256((const __m256i *)p);
+}
+#define __intfp_avx2_32_load_s32 __intfp_avx2_32_load_u32
+__intfp_avx2_fn void __intfp_avx2_32_store_8(void *p, __m256i v) {
+	__m256i b = _mm256_and_si256(v, _mm256_set1_epi32(0xff));
+	__m128i w = _mm_packus_epi32(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1));
+	_mm_storel_epi64((__m128i *)p, _mm_packus_epi16(w, w));
+}
+__intfp_avx2_fn void __intfp_avx2_32_store_16(void *p, __m256i v) {
+	__m256i w = _mm256_and_si256(v, _mm256_set1_epi32(0xffff));
+	_mm_storeu_si128((__m128i *)p,
+		_mm_packus_epi32(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1)));
+}
+__intfp_avx2_fn void __intfp_avx2_32_store_32(void *p, __m256i v) {
+	_mm256_storeu_si256((__m256i *)p, v);
+}
+
+/* --- AVX2, 64-bit lanes --- */
+typedef __m256i __intfp_avx2_64_v;
+typedef __m256i __intfp_avx2_64_m;
+__intfp_avx2_fn __m256i __intfp_avx2_64_set1(s64 x) { return _mm256_set1_epi64x(x); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_add(__m256i a, __m256i b) { return _mm256_add_epi64(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_sub(__m256i a, __m256i b) { return _mm256_sub_epi64(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_and(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_or(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_xor(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_sllv(__m256i a, __m256i n) { return _mm256_sllv_epi64(a, n); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_srlv(__m256i a, __m256i n) { return _mm256_srlv_epi64(a, n); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_slli(__m256i a, int n) { return _mm256_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_srli(__m256i a, int n) { return _mm256_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_cmpeq(__m256i a, __m256i b) { return _mm256_cmpeq_epi64(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_cmpgt(__m256i a, __m256i b) { return _mm256_cmpgt_epi64(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_blend(__m256i m, __m256i a, __m256i b) { return _mm256_blendv_epi8(a, b, m); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_neg_if(__m256i m, __m256i a) {
+	return _mm256_blendv_epi8(a, _mm256_sub_epi64(_mm256_setzero_si256(), a), m);
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_abs(__m256i a) {
+	return __intfp_avx2_64_neg_if(_mm256_cmpgt_epi64(_mm256_setzero_si256(), a), a);
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_clz(__m256i v) {
+	__m256i c = __intfp_avx2_32_clz(v);
+	__m256i hi = _mm256_srli_epi64(c, 32);
+	__m256i lo = _mm256_and_si256(c, _mm256_set1_epi64x(0xffffffff));
+	return _mm256_blendv_epi8(hi, _mm256_add_epi64(lo, _mm256_set1_epi64x(32)),
+		_mm256_cmpeq_epi64(hi, _mm256_set1_epi64x(32)));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_mul(__m256i a, __m256i b) { return _mm256_mul_epu32(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_mand(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+__intfp_avx2_fn __m256i __intfp_avx2_64_mor(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+typedef const u16 *__intfp_avx2_64_lut_t;
+__intfp_avx2_fn const u16 *__intfp_avx2_64_lut_load(const u16 *lut) { return lut; }
+__intfp_avx2_fn __m256i __intfp_avx2_64_lut(const u16 *lut, __m256i idx) {
+	__m256i d = _mm256_cvtepu32_epi64(
+		_mm256_i64gather_epi32((const int *)lut, _mm256_srli_epi64(idx, 1), 4));
+	d = _mm256_srlv_epi64(d, _mm256_slli_epi64(_mm256_and_si256(idx, _mm256_set1_epi64x(1)), 4));
+	return _mm256_and_si256(d, _mm256_set1_epi64x(0xffff));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_load_u8(const void *p) {
+	return _mm256_cvtepu8_epi64(_mm_loadu_si32(p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_load_s8(const void *p) {
+	return _mm256_cvtepi8_epi64(_mm_loadu_si32(p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_load_u16(const void *p) {
+	return _mm256_cvtepu16_epi64(_mm_loadl_epi64((const __m128i *)p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_load_s16(const void *p) {
+	return _mm256_cvtepi16_epi64(_mm_loadl_epi64((const __m128i *)p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_load_u32(const void *p) {
+	return _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_load_s32(const void *p) {
+	return _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)p));
+}
+__intfp_avx2_fn __m256i __intfp_avx2_64_load_u64(const void *p) {
+	return _mm256_loadu_si256((const __m256i *)p);
+}
+#define __intfp_avx2_64_load_s64 __intfp_avx2_64_load_u64
+/* Gathers the low dword of each qword into a single xmm. */
+__intfp_avx2_fn __m128i __intfp_avx2_64_narrow32(__m256i v) {
+	return _mm_castps_si128(_mm_shuffle_ps(
+		_mm_castsi128_ps(_mm256_castsi256_si128(v)),
+		_mm_castsi128_ps(_mm256_extracti128_si256(v, 1)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+__intfp_avx2_fn void __intfp_avx2_64_store_8(void *p, __m256i v) {
+	__m128i d = _mm_and_si128(__intfp_avx2_64_narrow32(v), _mm_set1_epi32(0xff));
+	__m128i w = _mm_packus_epi32(d, d);
+	_mm_storeu_si32(p, _mm_packus_epi16(w, w));
+}
+__intfp_avx2_fn void __intfp_avx2_64_store_16(void *p, __m256i v) {
+	__m128i d = _mm_and_si128(__intfp_avx2_64_narrow32(v), _mm_set1_epi32(0xffff));
+	_mm_storel_epi64((__m128i *)p, _mm_packus_epi32(d, d));
+}
+__intfp_avx2_fn void __intfp_avx2_64_store_32(void *p, __m256i v) {
+	_mm_storeu_si128((__m128i *)p, __intfp_avx2_64_narrow32(v));
+}
+__intfp_avx2_fn void __intfp_avx2_64_store_64(void *p, __m256i v) {
+	_mm256_storeu_si256((__m256i *)p, v);
+}
+
+/* --- AVX-512, 32-bit lanes --- */
+typedef __m512i   __intfp_avx512_32_v;
+typedef __mmask16 __intfp_avx512_32_m;
+__intfp_avx512_fn __m512i __intfp_avx512_32_set1(s64 x) { return _mm512_set1_epi32((int)x); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_add(__m512i a, __m512i b) { return _mm512_add_epi32(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_sub(__m512i a, __m512i b) { return _mm512_sub_epi32(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_and(__m512i a, __m512i b) { return _mm512_and_si512(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_or(__m512i a, __m512i b) { return _mm512_or_si512(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_xor(__m512i a, __m512i b) { return _mm512_xor_si512(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_sllv(__m512i a, __m512i n) { return _mm512_sllv_epi32(a, n); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_srlv(__m512i a, __m512i n) { return _mm512_srlv_epi32(a, n); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_slli(__m512i a, int n) { return _mm512_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_srli(__m512i a, int n) { return _mm512_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+__intfp_avx512_fn __mmask16 __intfp_avx512_32_cmpeq(__m512i a, __m512i b) { return _mm512_cmpeq_epi32_mask(a, b); }
+__intfp_avx512_fn __mmask16 __intfp_avx512_32_cmpgt(__m512i a, __m512i b) { return _mm512_cmpgt_epi32_mask(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_blend(__mmask16 m, __m512i a, __m512i b) { return _mm512_mask_blend_epi32(m, a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_abs(__m512i a) { return _mm512_abs_epi32(a); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_neg_if(__mmask16 m, __m512i a) {
+	return _mm512_mask_sub_epi32(a, m, _mm512_setzero_si512(), a);
+}
+__intfp_avx512_fn __m512i __intfp_avx512_32_clz(__m512i v) { return _mm512_lzcnt_epi32(v); }
+__intfp_avx512_fn __m512i __intfp_avx512_32_mul(__m512i a, __m512i b) { return _mm512_mullo_epi32(a, b); }
+__intfp_avx512_fn __mmask16 __intfp_avx512_32_mand(__mmask16 a, __mmask16 b) { return a & b; }
+__intfp_avx512_fn __mmask16 __intfp_avx512_32_mor(__mmask16 a, __mmask16 b) { return a | b; }
+/*
+ * Correction LUT held in registers: the 256 u16 entries fill eight zmm.
+ * vpermi2w picks one word out of a 64-word register pair using the low six
+ * bits of each word of idx, so four of them cover the table and idx bits 6
+ * and 7 select among the results. Only the lowest word of each lane holds
+ * the index (the other words are zero), and only that word is kept.
+ */
+typedef struct { __m512i t[8]; } __intfp_avx512_lut_t;
+typedef __intfp_avx512_lut_t __intfp_avx512_32_lut_t;
+__intfp_avx512_fn __intfp_avx512_lut_t __intfp_avx512_32_lut_load(const u16 *lut) {
+	__intfp_avx512_lut_t r;
+	for (int k = 0; k < 8; k++)
+		r.t[k] = _mm512_loadu_si512(lut + 32 * k);
+	return r;
+}
+__intfp_avx512_fn __m512i __intfp_avx512_32_lut(__intfp_avx512_lut_t l, __m512i idx) {
+	__m512i r0 = _mm512_permutex2var_epi16(l.t[0], idx, l.t[1]);
+	__m512i r1 = _mm512_permutex2var_epi16(l.t[2], idx, l.t[3]);
+	__m512i r2 = _mm512_permutex2var_epi16(l.t[4], idx, l.t[5]);
+	__m512i r3 = _mm512_permutex2var_epi16(l.t[6], idx, l.t[7]);
+	__mmask16 b6 = _mm512_test_epi32_mask(idx, _mm512_set1_epi32(64));
+	__mmask16 b7 = _mm512_test_epi32_mask(idx, _mm512_set1_epi32(128));
+	r0 = _mm512_mask_blend_epi32(b6, r0, r1);
+	r2 = _mm512_mask_blend_epi32(b6, r2, r3);
+	return _mm512_and_si512(_mm512_mask_blend_epi32(b7, r0, r2), _mm512_set1_epi32(0xffff));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_32_load_u8(const void *p) {
+	return _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_32_load_s8(const void *p) {
+	return _mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_32_load_u16(const void *p) {
+	return _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_32_load_s16(const void *p) {
+	return _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_32_load_u32(const void *p) {
+	return _mm512_loadu_si512(p);
+}
+#define __intfp_avx512_32_load_s32 __intfp_avx512_32_load_u32
+__intfp_avx512_fn void __intfp_avx512_32_store_8(void *p, __m512i v) {
+	_mm_storeu_si128((__m128i *)p, _mm512_cvtepi32_epi8(v));
+}
+__intfp_avx512_fn void __intfp_avx512_32_store_16(void *p, __m512i v) {
+	_mm256_storeu_si256((__m256i *)p, _mm512_cvtepi32_epi16(v));
+}
+__intfp_avx512_fn void __intfp_avx512_32_store_32(void *p, __m512i v) {
+	_mm512_storeu_si512(p, v);
+}
+
+/* --- AVX-512, 64-bit lanes --- */
+typedef __m512i  __intfp_avx512_64_v;
+typedef __mmask8 __intfp_avx512_64_m;
+__intfp_avx512_fn __m512i __intfp_avx512_64_set1(s64 x) { return _mm512_set1_epi64(x); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_add(__m512i a, __m512i b) { return _mm512_add_epi64(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_sub(__m512i a, __m512i b) { return _mm512_sub_epi64(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_and(__m512i a, __m512i b) { return _mm512_and_si512(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_or(__m512i a, __m512i b) { return _mm512_or_si512(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_xor(__m512i a, __m512i b) { return _mm512_xor_si512(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_sllv(__m512i a, __m512i n) { return _mm512_sllv_epi64(a, n); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_srlv(__m512i a, __m512i n) { return _mm512_srlv_epi64(a, n); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_slli(__m512i a, int n) { return _mm512_sll_epi64(a, _mm_cvtsi32_si128(n)); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_srli(__m512i a, int n) { return _mm512_srl_epi64(a, _mm_cvtsi32_si128(n)); }
+__intfp_avx512_fn __mmask8 __intfp_avx512_64_cmpeq(__m512i a, __m512i b) { return _mm512_cmpeq_epi64_mask(a, b); }
+__intfp_avx512_fn __mmask8 __intfp_avx512_64_cmpgt(__m512i a, __m512i b) { return _mm512_cmpgt_epi64_mask(a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_blend(__mmask8 m, __m512i a, __m512i b) { return _mm512_mask_blend_epi64(m, a, b); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_abs(__m512i a) { return _mm512_abs_epi64(a); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_neg_if(__mmask8 m, __m512i a) {
+	return _mm512_mask_sub_epi64(a, m, _mm512_setzero_si512(), a);
+}
+__intfp_avx512_fn __m512i __intfp_avx512_64_clz(__m512i v) { return _mm512_lzcnt_epi64(v); }
+__intfp_avx512_fn __m512i __intfp_avx512_64_mul(__m512i a, __m512i b) { return _mm512_mul_epu32(a, b); }
+__intfp_avx512_fn __mmask8 __intfp_avx512_64_mand(__mmask8 a, __mmask8 b) { return a & b; }
+__intfp_avx512_fn __mmask8 __intfp_avx512_64_mor(__mmask8 a, __mmask8 b) { return a | b; }
+typedef __intfp_avx512_lut_t __intfp_avx512_64_lut_t;
+#define __intfp_avx512_64_lut_load __intfp_avx512_32_lut_load
+__intfp_avx512_fn __m512i __intfp_avx512_64_lut(__intfp_avx512_lut_t l, __m512i idx) {
+	__m512i r0 = _mm512_permutex2var_epi16(l.t[0], idx, l.t[1]);
+	__m512i r1 = _mm512_permutex2var_epi16(l.t[2], idx, l.t[3]);
+	__m512i r2 = _mm512_permutex2var_epi16(l.t[4], idx, l.t[5]);
+	__m512i r3 = _mm512_permutex2var_epi16(l.t[6], idx, l.t[7]);
+	__mmask8 b6 = _mm512_test_epi64_mask(idx, _mm512_set1_epi64(64));
+	__mmask8 b7 = _mm512_test_epi64_mask(idx, _mm512_set1_epi64(128));
+	r0 = _mm512_mask_blend_epi64(b6, r0, r1);
+	r2 = _mm512_mask_blend_epi64(b6, r2, r3);
+	return _mm512_and_si512(_mm512_mask_blend_epi64(b7, r0, r2), _mm512_set1_epi64(0xffff));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_64_load_u8(const void *p) {
+	return _mm512_cvtepu8_epi64(_mm_loadl_epi64((const __m128i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_64_load_s8(const void *p) {
+	return _mm512_cvtepi8_epi64(_mm_loadl_epi64((const __m128i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_64_load_u16(const void *p) {
+	return _mm512_cvtepu16_epi64(_mm_loadu_si128((const __m128i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_64_load_s16(const void *p) {
+	return _mm512_cvtepi16_epi64(_mm_loadu_si128((const __m128i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_64_load_u32(const void *p) {
+	return _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_64_load_s32(const void *p) {
+	return _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)p));
+}
+__intfp_avx512_fn __m512i __intfp_avx512_64_load_u64(const void *p) {
+	return _mm512_loadu_si512(p);
+}
+#define __intfp_avx512_64_load_s64 __intfp_avx512_64_load_u64
+__intfp_avx512_fn void __intfp_avx512_64_store_8(void *p, __m512i v) {
+	_mm_storel_epi64((__m128i *)p, _mm512_cvtepi64_epi8(v));
+}
+__intfp_avx512_fn void __intfp_avx512_64_store_16(void *p, __m512i v) {
+	_mm_storeu_si128((__m128i *)p, _mm512_cvtepi64_epi16(v));
+}
+__intfp_avx512_fn void __intfp_avx512_64_store_32(void *p, __m512i v) {
+	_mm256_storeu_si256((__m256i *)p, _mm512_cvtepi64_epi32(v));
+}
+__intfp_avx512_fn void __intfp_avx512_64_store_64(void *p, __m512i v) {
+	_mm512_storeu_si512(p, v);
+}
+
+/**
+ * @brief Generates the batch kernels of one width pair for one instruction set.
+ * Each kernel converts as many whole vectors as fit in `n` and returns the
+ * number of elements done; the caller finishes the tail with scalar code.
+ * @param isa The instruction set (avx2 or avx512).
+ * @param W The lane width (32 or 64).
+ */
+#define __INTFP_SIMD_DECL_PUL_KERNELS(isa, W, hbits, lbits) \
+__intfp_##isa##_fn size_t __intfp_##isa##_u##hbits##_to_pul##lbits( \
+		u##lbits *dst, const u##hbits *src, size_t n, u8 ofp) { \
+	const size_t N = sizeof(__IV(isa, W, v)) / (W / 8); \
+	const __IV(isa, W, v) zero = __IV(isa, W, set1)(0); \
+	const __IV(isa, W, v) one = __IV(isa, W, set1)(1); \
+	size_t i; \
+	for (i = 0; i + N <= n; i += N) { \
+		__IV(isa, W, v) v = __IV(isa, W, load_u##hbits)(src + i); \
+		__IV(isa, W, v) clz = __IV(isa, W, clz)(v); \
+		__IV(isa, W, v) m = __IV(isa, W, srli)(__IV(isa, W, sllv)(v, clz), W - 1 - ofp); \
+		__IV(isa, W, v) e = __IV(isa, W, sub)(__IV(isa, W, set1)(W - 2), clz); \
+		__IV(isa, W, v) r = __IV(isa, W, add)(__IV(isa, W, slli)(e, ofp), m); \
+		/* v=1 falls out of the formula as 0; only v=0 needs patching */ \
+		r = __IV(isa, W, blend)(__IV(isa, W, cmpeq)(v, zero), r, one); \
+		__IV(isa, W, store_##lbits)(dst + i, r); \
+	} \
+	return i; \
+} \
+__intfp_##isa##_fn size_t __intfp_##isa##_pul##lbits##_to_u##hbits( \
+		u##hbits *dst, const u##lbits *src, size_t n, u8 ifp) { \
+	const size_t N = sizeof(__IV(isa, W, v)) / (W / 8); \
+	const __IV(isa, W, v) zero = __IV(isa, W, set1)(0); \
+	const __IV(isa, W, v) one = __IV(isa, W, set1)(1); \
+	const __IV(isa, W, v) mmask = __IV(isa, W, set1)(((s64)1 << ifp) - 1); \
+	const __IV(isa, W, v) lead = __IV(isa, W, set1)((s64)((u64)1 << (W - 1))); \
+	size_t i; \
+	for (i = 0; i + N <= n; i += N) { \
+		__IV(isa, W, v) v = __IV(isa, W, load_u##lbits)(src + i); \
+		__IV(isa, W, v) e = __IV(isa, W, srli)(v, ifp); \
+		__IV(isa, W, v) m = __IV(isa, W, and)(v, mmask); \
+		__IV(isa, W, v) norm = __IV(isa, W, or)(lead, __IV(isa, W, slli)(m, W - 1 - ifp)); \
+		__IV(isa, W, v) r = __IV(isa, W, srlv)(norm, \
+			__IV(isa, W, sub)(__IV(isa, W, set1)(W - 1), e)); \
+		r = __IV(isa, W, blend)(__IV(isa, W, cmpgt)(e, \
+			__IV(isa, W, set1)(hbits - 1)), r, __IV(isa, W, set1)(-1)); \
+		r = __IV(isa, W, blend)(__IV(isa, W, cmpeq)(v, one), r, zero); \
+		__IV(isa, W, store_##hbits)(dst + i, r); \
+	} \
+	return i; \
+}
+
+#define __INTFP_SIMD_DECL_LOG_KERNELS(isa, W, hbits, lbits) \
+__intfp_##isa##_fn size_t __intfp_##isa##_u##hbits##fp_to_log##lbits( \
+		s##lbits *dst, const u##hbits *src, size_t n, u8 ifp, u8 ofp) { \
+	const size_t N = sizeof(__IV(isa, W, v)) / (W / 8); \
+	const __IV(isa, W, v) zero = __IV(isa, W, set1)(0); \
+	const __IV(isa, W, v) log0 = __IV(isa, W, set1)(intfp_log_0(lbits)); \
+	size_t i; \
+	for (i = 0; i + N <= n; i += N) { \
+		__IV(isa, W, v) v = __IV(isa, W, load_u##hbits)(src + i); \
+		__IV(isa, W, v) clz = __IV(isa, W, clz)(v); \
+		__IV(isa, W, v) m = __IV(isa, W, srli)(__IV(isa, W, sllv)(v, clz), W - 1 - ofp); \
+		__IV(isa, W, v) e = __IV(isa, W, sub)(__IV(isa, W, set1)(W - 2 - ifp), clz); \
+		__IV(isa, W, v) r = __IV(isa, W, add)(__IV(isa, W, slli)(e, ofp), m); \
+		r = __IV(isa, W, blend)(__IV(isa, W, cmpeq)(v, zero), r, log0); \
+		__IV(isa, W, store_##lbits)(dst + i, r); \
+	} \
+	return i; \
+} \
+__intfp_##isa##_fn size_t __intfp_##isa##_log##lbits##_to_u##hbits##fp( \
+		u##hbits *dst, const s##lbits *src, size_t n, u8 ifp, u8 ofp) { \
+	const size_t N = sizeof(__IV(isa, W, v)) / (W / 8); \
+	const __IV(isa, W, v) zero = __IV(isa, W, set1)(0); \
+	const __IV(isa, W, v) log0 = __IV(isa, W, set1)(intfp_log_0(lbits)); \
+	const __IV(isa, W, v) mmask = __IV(isa, W, set1)(((s64)1 << ifp) - 1); \
+	const __IV(isa, W, v) lead = __IV(isa, W, set1)((s64)((u64)1 << (W - 1))); \
+	size_t i; \
+	for (i = 0; i + N <= n; i += N) { \
+		__IV(isa, W, v) v = __IV(isa, W, load_s##lbits)(src + i); \
+		__IV(isa, W, v) m = __IV(isa, W, and)(v, mmask); \
+		/* Signed exponent floor(v / 2^ifp): v - m is a multiple of 2^ifp, so \
+		 * its magnitude shifts exactly (no 64-bit arithmetic shift on AVX2) */ \
+		__IV(isa, W, v) e = __IV(isa, W, add)(__IV(isa, W, neg_if)( \
+			__IV(isa, W, cmpgt)(zero, v), \
+			__IV(isa, W, srli)(__IV(isa, W, abs)(__IV(isa, W, sub)(v, m)), ifp)), \
+			__IV(isa, W, set1)(ofp)); \
+		__IV(isa, W, v) norm = __IV(isa, W, or)(lead, __IV(isa, W, slli)(m, W - 1 - ifp)); \
+		/* Underflow (e < 0) makes the count exceed W-1, which shifts to 0 */ \
+		__IV(isa, W, v) r = __IV(isa, W, srlv)(norm, \
+			__IV(isa, W, sub)(__IV(isa, W, set1)(W - 1), e)); \
+		r = __IV(isa, W, blend)(__IV(isa, W, cmpgt)(e, \
+			__IV(isa, W, set1)(hbits - 1)), r, __IV(isa, W, set1)(-1)); \
+		r = __IV(isa, W, blend)(__IV(isa, W, cmpeq)(v, log0), r, zero); \
+		__IV(isa, W, store_##hbits)(dst + i, r); \
+	} \
+	return i; \
+}
+
+#define __INTFP_SIMD_DECL_CORR_KERNELS(isa, W, hbits, lbits) \
+/* Corrected encode, level 1 (polynomial LUT) .. 3 (exact LUT + interpolation) */ \
+__intfp_##isa##_fn size_t __intfp_##isa##_u##hbits##fp_to_log##lbits##_corr( \
+		s##lbits *dst, const u##hbits *src, size_t n, u8 ifp, u8 ofp, u8 level) { \
+	const size_t N = sizeof(__IV(isa, W, v)) / (W / 8); \
+	const __IV(isa, W, v) zero = __IV(isa, W, set1)(0); \
+	const __IV(isa, W, v) b8 = __IV(isa, W, set1)(0xff); \
+	const __IV(isa, W, v) log0 = __IV(isa, W, set1)(intfp_log_0(lbits)); \
+	const __IV(isa, W, v) smax = __IV(isa, W, set1)(intfp_signed_max(lbits)); \
+	const __IV(isa, W, v) mfmask = __IV(isa, W, set1)(((s64)1 << ofp) - 1); \
+	/* The scalar `ofp >= 8` / `ofp <= 16` selections become shift pairs */ \
+	const int ir = (ofp >= 8) ? ofp - 8 : 0, il = (ofp >= 8) ? 0 : 8 - ofp; \
+	const int fr = (ofp >= 16) ? ofp - 16 : 0, fl = (ofp >= 16) ? 0 : 16 - ofp; \
+	const int cr = (ofp <= 16) ? 16 - ofp : 0, cl = (ofp <= 16) ? 0 : ofp - 16; \
+	const bool interp = level >= 3 && ofp >= 8; \
+	const __IV(isa, W, lut_t) lut = __IV(isa, W, lut_load)((level >= 2) ? \
+		__intfp_enc_corr_exact_lut : __intfp_enc_corr_lut); \
+	size_t i; \
+	for (i = 0; i + N <= n; i += N) { \
+		__IV(isa, W, v) v = __IV(isa, W, load_u##hbits)(src + i); \
+		__IV(isa, W, v) clz = __IV(isa, W, clz)(v); \
+		__IV(isa, W, v) m = __IV(isa, W, srli)(__IV(isa, W, sllv)(v, clz), W - 1 - ofp); \
+		__IV(isa, W, v) mf = __IV(isa, W, and)(m, mfmask); \
+		__IV(isa, W, v) idx = __IV(isa, W, and)(__IV(isa, W, slli)( \
+			__IV(isa, W, srli)(mf, ir), il), b8); \
+		__IV(isa, W, v) c = __IV(isa, W, lut)(lut, idx); \
+		if (interp) { \
+			/* c + ((c1 - c) * frac >> 8), kept non-negative: lut[256] == lut[0] == 0 */ \
+			__IV(isa, W, v) frac = __IV(isa, W, and)(__IV(isa, W, slli)( \
+				__IV(isa, W, srli)(mf, fr), fl), b8); \
+			__IV(isa, W, v) c1 = __IV(isa, W, lut)(lut, __IV(isa, W, and)( \
+				__IV(isa, W, add)(idx, __IV(isa, W, set1)(1)), b8)); \
+			c = __IV(isa, W, srli)(__IV(isa, W, add)( \
+				__IV(isa, W, mul)(c, __IV(isa, W, sub)(__IV(isa, W, set1)(256), frac)), \
+				__IV(isa, W, mul)(c1, frac)), 8); \
+		} \
+		m = __IV(isa, W, add)(m, __IV(isa, W, slli)(__IV(isa, W, srli)(c, cr), cl)); \
+		__IV(isa, W, v) e = __IV(isa, W, sub)(__IV(isa, W, set1)(W - 2 - ifp), clz); \
+		__IV(isa, W, v) r = __IV(isa, W, add)(__IV(isa, W, slli)(e, ofp), m); \
+		/* Clamp when a non-negative exponent wraps into the sign bit of s##lbits */ \
+		r = __IV(isa, W, blend)(__IV(isa, W, mand)( \
+			__IV(isa, W, cmpgt)(e, __IV(isa, W, set1)(-1)), \
+			__IV(isa, W, cmpgt)(zero, __IV(isa, W, slli)(r, W - lbits))), r, smax); \
+		r = __IV(isa, W, blend)(__IV(isa, W, cmpeq)(v, zero), r, log0); \
+		__IV(isa, W, store_##lbits)(dst + i, r); \
+	} \
+	return i; \
+} \
+/* Corrected decode, level 1 (polynomial LUT) .. 3 (exact LUT + interpolation) */ \
+__intfp_##isa##_fn size_t __intfp_##isa##_log##lbits##_to_u##hbits##fp_corr( \
+		u##hbits *dst, const s##lbits *src, size_t n, u8 ifp, u8 ofp, u8 level) { \
+	const size_t N = sizeof(__IV(isa, W, v)) / (W / 8); \
+	const __IV(isa, W, v) zero = __IV(isa, W, set1)(0); \
+	const __IV(isa, W, v) b8 = __IV(isa, W, set1)(0xff); \
+	const __IV(isa, W, v) log0 = __IV(isa, W, set1)(intfp_log_0(lbits)); \
+	const __IV(isa, W, v) mmask = __IV(isa, W, set1)(((s64)1 << ifp) - 1); \
+	const __IV(isa, W, v) lead = __IV(isa, W, set1)((s64)((u64)1 << (W - 1))); \
+	/* Q0.16 correction scaled to an hbits-wide norm, then lifted to W bits */ \
+	const int cr = ((hbits-1) <= 16) ? 16 - (hbits-1) : 0; \
+	const int cl = (((hbits-1) <= 16) ? 0 : (hbits-1) - 16) + (W - hbits); \
+	const bool interp = level >= 3 && (hbits-1) >= 8; \
+	const __IV(isa, W, lut_t) lut = __IV(isa, W, lut_load)((level >= 2) ? \
+		__intfp_dec_corr_exact_lut : __intfp_dec_corr_lut); \
+	size_t i; \
+	for (i = 0; i + N <= n; i += N) { \
+		__IV(isa, W, v) v = __IV(isa, W, load_s##lbits)(src + i); \
+		__IV(isa, W, v) m = __IV(isa, W, and)(v, mmask); \
+		__IV(isa, W, v) e = __IV(isa, W, add)(__IV(isa, W, neg_if)( \
+			__IV(isa, W, cmpgt)(zero, v), \
+			__IV(isa, W, srli)(__IV(isa, W, abs)(__IV(isa, W, sub)(v, m)), ifp)), \
+			__IV(isa, W, set1)(ofp)); \
+		__IV(isa, W, v) norm = __IV(isa, W, or)(lead, __IV(isa, W, slli)(m, W - 1 - ifp)); \
+		/* Index and interpolation weight are the fraction bits below the leading 1 */ \
+		__IV(isa, W, v) idx = __IV(isa, W, and)(__IV(isa, W, srli)(norm, W - 9), b8); \
+		__IV(isa, W, v) c = __IV(isa, W, lut)(lut, idx); \
+		if (interp) { \
+			__IV(isa, W, v) frac = __IV(isa, W, and)(__IV(isa, W, srli)(norm, W - 17), b8); \
+			__IV(isa, W, v) c1 = __IV(isa, W, lut)(lut, __IV(isa, W, and)( \
+				__IV(isa, W, add)(idx, __IV(isa, W, set1)(1)), b8)); \
+			c = __IV(isa, W, srli)(__IV(isa, W, add)( \
+				__IV(isa, W, mul)(c, __IV(isa, W, sub)(__IV(isa, W, set1)(256), frac)), \
+				__IV(isa, W, mul)(c1, frac)), 8); \
+		} \
+		norm = __IV(isa, W, sub)(norm, __IV(isa, W, slli)(__IV(isa, W, srli)(c, cr), cl)); \
+		__IV(isa, W, v) r = __IV(isa, W, srlv)(norm, \
+			__IV(isa, W, sub)(__IV(isa, W, set1)(W - 1), e)); \
+		r = __IV(isa, W, blend)(__IV(isa, W, cmpgt)(e, \
+			__IV(isa, W, set1)(hbits - 1)), r, __IV(isa, W, set1)(-1)); \
+		r = __IV(isa, W, blend)(__IV(isa, W, cmpeq)(v, log0), r, zero); \
+		__IV(isa, W, store_##hbits)(dst + i, r); \
+	} \
+	return i; \
+}
+
+/* Per-ISA entry point; families left out by INTFP_SELECT report 0 elements done */
+#define __INTFP_SIMD_DECL_KERNELS(isa, W, hbits, lbits) \
+__intfp_if_pul(__INTFP_SIMD_DECL_PUL_KERNELS(isa, W, hbits, lbits)) \
+__intfp_if_log(__INTFP_SIMD_DECL_LOG_KERNELS(isa, W, hbits, lbits)) \
+__intfp_if_corr(__INTFP_SIMD_DECL_CORR_KERNELS(isa, W, hbits, lbits)) \
+__intfp_##isa##_fn size_t __intfp_##isa##_batch_##hbits##_##lbits(enum __intfp_batch_op op, \
+		void *dst, const void *src, size_t n, u8 ifp, u8 ofp, u8 level) { \
+	(void)level; /* Unused without INTFP_WITH_CORR */ \
+	switch (op) { \
+	case __INTFP_BATCH_TO_PUL: \
+		__intfp_if_pul(return __intfp_##isa##_u##hbits##_to_pul##lbits( \
+			(u##lbits *)dst, (const u##hbits *)src, n, ofp);) \
+		break; \
+	case __INTFP_BATCH_FROM_PUL: \
+		__intfp_if_pul(return __intfp_##isa##_pul##lbits##_to_u##hbits( \
+			(u##hbits *)dst, (const u##lbits *)src, n, ifp);) \
+		break; \
+	case __INTFP_BATCH_TO_LOG: \
+		__intfp_if_corr(if (level) \
+			return __intfp_##isa##_u##hbits##fp_to_log##lbits##_corr( \
+				(s##lbits *)dst, (const u##hbits *)src, n, ifp, ofp, level);) \
+		__intfp_if_log(return __intfp_##isa##_u##hbits##fp_to_log##lbits( \
+			(s##lbits *)dst, (const u##hbits *)src, n, ifp, ofp);) \
+		break; \
+	case __INTFP_BATCH_FROM_LOG: \
+		__intfp_if_corr(if (level) \
+			return __intfp_##isa##_log##lbits##_to_u##hbits##fp_corr( \
+				(u##hbits *)dst, (const s##lbits *)src, n, ifp, ofp, level);) \
+		__intfp_if_log(return __intfp_##isa##_log##lbits##_to_u##hbits##fp( \
+			(u##hbits *)dst, (const s##lbits *)src, n, ifp, ofp);) \
+		break; \
+	} \
+	return 0; \
+}
+
+/**
+ * @brief Generates the kernels and the run-time dispatcher of one width pair.
+ * @param W The lane width used for this pair (32 if hbits <= 32, else 64).
+ */
+#define __INTFP_SIMD_DECL_HBITS_LBITS(W, hbits, lbits) \
+__INTFP_SIMD_DECL_KERNELS(avx2, W, hbits, lbits) \
+__INTFP_SIMD_DECL_KERNELS(avx512, W, hbits, lbits) \
+static inline size_t __intfp_simd_##hbits##_##lbits(enum __intfp_batch_op op, \
+		void *dst, const void *src, size_t n, u8 ifp, u8 ofp, u8 level) { \
+	switch (intfp_isa_get()) { \
+	case INTFP_ISA_AVX512_VBMI: \
+	case INTFP_ISA_AVX512: \
+		return __intfp_avx512_batch_##hbits##_##lbits(op, dst, src, n, ifp, ofp, level); \
+	case INTFP_ISA_AVX2: \
+		return __intfp_avx2_batch_##hbits##_##lbits(op, dst, src, n, ifp, ofp, level); \
+	default: \
+		return 0; \
+	} \
+}
+
+/**
+ * @brief Generates the saturating 'log' mul/div kernel of one width.
+ * Narrow types are sign-extended into W-bit lanes, where the sum cannot
+ * wrap and is clamped; at bits == W, overflow is detected from the signs
+ * as in the scalar __builtin_add_overflow()/__builtin_sub_overflow().
+ */
+#define __INTFP_SIMD_DECL_LOG_ARITH_KERNELS(isa, W, bits) \
+__intfp_##isa##_fn size_t __intfp_##isa##_log##bits##_arith( \
+		s##bits *dst, const s##bits *a, const s##bits *b, size_t n, bool div) { \
+	const size_t N = sizeof(__IV(isa, W, v)) / (W / 8); \
+	const __IV(isa, W, v) zero = __IV(isa, W, set1)(0); \
+	const __IV(isa, W, v) log0 = __IV(isa, W, set1)(intfp_log_0(bits)); \
+	const __IV(isa, W, v) max = __IV(isa, W, set1)(intfp_signed_max(bits)); \
+	size_t i; \
+	for (i = 0; i + N <= n; i += N) { \
+		__IV(isa, W, v) x = __IV(isa, W, load_s##bits)(a + i); \
+		__IV(isa, W, v) y = __IV(isa, W, load_s##bits)(b + i); \
+		__IV(isa, W, v) r = div ? __IV(isa, W, sub)(x, y) : __IV(isa, W, add)(x, y); \
+		__IV(isa, W, m) xz = __IV(isa, W, cmpeq)(x, log0); \
+		__IV(isa, W, m) yz = __IV(isa, W, cmpeq)(y, log0); \
+		if (bits < W) { \
+			r = __IV(isa, W, blend)(__IV(isa, W, cmpgt)(r, max), r, max); \
+			r = __IV(isa, W, blend)(__IV(isa, W, cmpgt)(log0, r), r, log0); \
+		} else { \
+			__IV(isa, W, v) o = div ? \
+				__IV(isa, W, and)(__IV(isa, W, xor)(x, y), __IV(isa, W, xor)(x, r)) : \
+				__IV(isa, W, and)(__IV(isa, W, xor)(x, r), __IV(isa, W, xor)(y, r)); \
+			r = __IV(isa, W, blend)(__IV(isa, W, cmpgt)(zero, o), r, \
+				__IV(isa, W, blend)(__IV(isa, W, cmpgt)(zero, x), max, log0)); \
+		} \
+		if (div) { \
+			r = __IV(isa, W, blend)(yz, r, max); \
+			r = __IV(isa, W, blend)(xz, r, log0); \
+		} else { \
+			r = __IV(isa, W, blend)(__IV(isa, W, mor)(xz, yz), r, log0); \
+		} \
+		__IV(isa, W, store_##bits)(dst + i, r); \
+	} \
+	return i; \
+}
+
+/**
+ * @brief Generates the kernels and the run-time dispatcher of one 'log' width.
+ * @param W The lane width used for this width (32 if bits <= 32, else 64).
+ */
+#define __INTFP_SIMD_DECL_LOG_ARITH(W, bits) \
+__INTFP_SIMD_DECL_LOG_ARITH_KERNELS(avx2, W, bits) \
+__INTFP_SIMD_DECL_LOG_ARITH_KERNELS(avx512, W, bits) \
+static inline size_t __intfp_simd_log##bits##_arith(s##bits *dst, const s##bits *a, \
+		const s##bits *b, size_t n, bool div) { \
+	switch (intfp_isa_get()) { \
+	case INTFP_ISA_AVX512_VBMI: \
+	case INTFP_ISA_AVX512: \
+		return __intfp_avx512_log##bits##_arith(dst, a, b, n, div); \
+	case INTFP_ISA_AVX2: \
+		return __intfp_avx2_log##bits##_arith(dst, a, b, n, div); \
+	default: \
+		return 0; \
+	} \
+}
+
+/**
+ * @brief The instruction set level selected for the batch kernels.
+ * Detected with cpuid on first use (or at load time through the constructor
+ * below); -1 means not yet detected. Weak, so that every translation unit
+ * shares one level and intfp_isa_set() applies program-wide even though the
+ * functions themselves are static.
+ */
+int __attribute__((weak)) __intfp_isa_level = -1;
+/* Whether the CPU has BMI2 (pdep/pext), recorded by the same detection */
+int __attribute__((weak)) __intfp_isa_bmi2 = -1;
+
+static inline enum intfp_isa __intfp_isa_detect(void) {
+	__builtin_cpu_init();
+	__intfp_isa_bmi2 = __builtin_cpu_supports("bmi2") != 0;
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd") &&
+	    __builtin_cpu_supports("avx512bw"))
+		return __builtin_cpu_supports("avx512vbmi") ? INTFP_ISA_AVX512_VBMI : INTFP_ISA_AVX512;
+	if (__builtin_cpu_supports("avx2"))
+		return INTFP_ISA_AVX2;
+	return INTFP_ISA_SCALAR;
+}
+
+static void __attribute__((constructor, unused)) __intfp_isa_init(void) {
+	if (__intfp_isa_level < 0)
+		__intfp_isa_level = __intfp_isa_detect();
+}
+
+/**
+ * @brief Returns the instruction set used by the `_array` batch conversions.
+ */
+INTFP_API enum intfp_isa intfp_isa_get(void) {
+	if (__intfp_isa_level < 0)
+		__intfp_isa_level = __intfp_isa_detect();
+	return (enum intfp_isa)__intfp_isa_level;
+}
+
+/*
+ * The BMI2 kernels count as part of the AVX2 level, so that lowering it to
+ * INTFP_ISA_SCALAR turns them off with the rest.
+ */
+static inline int __intfp_isa_has_bmi2(void) {
+	return intfp_isa_get() >= INTFP_ISA_AVX2 && __intfp_isa_bmi2 > 0;
+}
+
+/**
+ * @brief Restricts the batch conversions to at most the given instruction set.
+ * Requests above what the CPU supports are clamped, so this can only lower
+ * the level (e.g. to compare kernels against the scalar fallback).
+ * @param isa The highest instruction set to use.
+ * @return The instruction set actually selected.
+ */
+INTFP_API enum intfp_isa intfp_isa_set(enum intfp_isa isa) {
+	enum intfp_isa max = __intfp_isa_detect();
+	__intfp_isa_level = (isa < max) ? isa : max;
+	return (enum intfp_isa)__intfp_isa_level;
+}
+
+/* Generate batch kernels for the width pairs of INTFP_DECL_HBITS_LBITS */
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_8_8)
+__INTFP_SIMD_DECL_HBITS_LBITS(32,  8, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_8)
+__INTFP_SIMD_DECL_HBITS_LBITS(32, 16, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_8)
+__INTFP_SIMD_DECL_HBITS_LBITS(32, 32, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_8)
+__INTFP_SIMD_DECL_HBITS_LBITS(64, 64, 8)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_16_16)
+__INTFP_SIMD_DECL_HBITS_LBITS(32, 16,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_16)
+__INTFP_SIMD_DECL_HBITS_LBITS(32, 32,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+__INTFP_SIMD_DECL_HBITS_LBITS(64, 64,16)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_32_32)
+__INTFP_SIMD_DECL_HBITS_LBITS(32, 32,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_32)
+__INTFP_SIMD_DECL_HBITS_LBITS(64, 64,32)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_64)
+__INTFP_SIMD_DECL_HBITS_LBITS(64, 64,64)
+#endif
+
+#define __intfp_simd_batch(hbits, lbits, op, dst, src, n, ifp, ofp, level) \
+	__intfp_simd_##hbits##_##lbits(op, dst, src, n, ifp, ofp, level)
+
+/* Generate saturating 'log' mul/div kernels for 8, 16, 32, and 64-bit 'log' */
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_LOG)
+__INTFP_SIMD_DECL_LOG_ARITH(32,  8)
+__INTFP_SIMD_DECL_LOG_ARITH(32, 16)
+__INTFP_SIMD_DECL_LOG_ARITH(32, 32)
+__INTFP_SIMD_DECL_LOG_ARITH(64, 64)
+#endif
+
+#define __intfp_simd_log_arith(bits, dst, a, b, n, div) \
+	__intfp_simd_log##bits##_arith(dst, a, b, n, div)
+
+/*
+ * Full-table lookups, dst[i] = lut[src[i]], behind the 8-bit decode tables
+ * and the u8/u16 power-law tables.
+ *
+ * 8-bit codes, pshufb (AVX2, AVX-512): pshufb reads a 16-byte table with the
+ * low nibble of each index, and gives zero where the index has bit 7 set.
+ * The 256-byte table is walked in 16 blocks: before block k the indices are
+ * lowered by 16 * k and added to 0x70 with unsigned saturation, which keeps
+ * the low nibble of the indices inside the block and sets bit 7 of every
+ * other one. OR-ing the 16 results leaves exactly one hit per byte.
+ *
+ * 8-bit codes, vpermi2b (AVX-512 VBMI): one vpermi2b looks up 128 entries,
+ * so two and a blend on bit 7 cover a table. 16-bit values are split into a
+ * low and a high byte plane once per call, looked up separately and
+ * interleaved again by unpacking.
+ *
+ * 8-bit codes to 32- and 64-bit values: dword/qword gathers, on every level.
+ * With more byte planes, the unpacks and lookups saturate the shuffle port
+ * and lose to the gathers. 16-bit values without VBMI stay in the scalar
+ * loop: two pshufb walks per vector are slower than it.
+ *
+ * u16 codes: dword gathers at the index (scale 2), keeping the low half.
+ * Index 65535 would read two bytes past the table, so it is masked out of
+ * the gather and filled in from a register.
+ */
+__intfp_avx2_fn size_t __intfp_avx2_lut8(void *dst, const u8 *src, size_t n,
+		const void *lut, u8 bytes) {
+	size_t i;
+	if (bytes == 4) {
+		for (i = 0; i + 8 <= n; i += 8) {
+			__m256i x = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + i)));
+			_mm256_storeu_si256((__m256i *)((u32 *)dst + i),
+				_mm256_i32gather_epi32((const int *)lut, x, 4));
+		}
+		return i;
+	}
+	if (bytes == 8) {
+		for (i = 0; i + 8 <= n; i += 8) {
+			__m256i x = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + i)));
+			_mm256_storeu_si256((__m256i *)((u64 *)dst + i), _mm256_i32gather_epi64(
+				(const long long *)lut, _mm256_castsi256_si128(x), 8));
+			_mm256_storeu_si256((__m256i *)((u64 *)dst + i + 4), _mm256_i32gather_epi64(
+				(const long long *)lut, _mm256_extracti128_si256(x, 1), 8));
+		}
+		return i;
+	}
+	if (bytes != 1)
+		return 0;
+	__m256i t[16];
+	for (int k = 0; k < 16; k++)
+		t[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)((const u8 *)lut + 16 * k)));
+	const __m256i c16 = _mm256_set1_epi8(16), c70 = _mm256_set1_epi8(0x70);
+	for (i = 0; i + 32 <= n; i += 32) {
+		__m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+		__m256i r = _mm256_setzero_si256();
+		for (int k = 0; k < 16; k++) {
+			r = _mm256_or_si256(r, _mm256_shuffle_epi8(t[k], _mm256_adds_epu8(x, c70)));
+			x = _mm256_sub_epi8(x, c16);
+		}
+		_mm256_storeu_si256((__m256i *)((u8 *)dst + i), r);
+	}
+	return i;
+}
+
+/* 32- and 64-bit values are gathered from the table instead (also with VBMI) */
+__intfp_avx512_fn size_t __intfp_avx512_lut8_gather(void *dst, const u8 *src, size_t n,
+		const void *lut, u8 bytes) {
+	size_t i;
+	for (i = 0; i + 16 <= n; i += 16) {
+		__m512i x = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+		if (bytes == 4) {
+			_mm512_storeu_si512((u32 *)dst + i, _mm512_i32gather_epi32(x, lut, 4));
+		} else {
+			_mm512_storeu_si512((u64 *)dst + i,
+				_mm512_i32gather_epi64(_mm512_castsi512_si256(x), lut, 8));
+			_mm512_storeu_si512((u64 *)dst + i + 8,
+				_mm512_i32gather_epi64(_mm512_extracti64x4_epi64(x, 1), lut, 8));
+		}
+	}
+	return i;
+}
+
+__intfp_avx512_fn size_t __intfp_avx512_lut8(void *dst, const u8 *src, size_t n,
+		const void *lut, u8 bytes) {
+	if (bytes >= 4)
+		return __intfp_avx512_lut8_gather(dst, src, n, lut, bytes);
+	if (bytes != 1)
+		return 0;
+	__m512i t[16];
+	for (int k = 0; k < 16; k++)
+		t[k] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)((const u8 *)lut + 16 * k)));
+	const __m512i c16 = _mm512_set1_epi8(16), c70 = _mm512_set1_epi8(0x70);
+	size_t i;
+	for (i = 0; i + 64 <= n; i += 64) {
+		__m512i x = _mm512_loadu_si512(src + i);
+		__m512i r = _mm512_setzero_si512();
+		for (int k = 0; k < 16; k++) {
+			r = _mm512_or_si512(r, _mm512_shuffle_epi8(t[k], _mm512_adds_epu8(x, c70)));
+			x = _mm512_sub_epi8(x, c16);
+		}
+		_mm512_storeu_si512((u8 *)dst + i, r);
+	}
+	return i;
+}
+
+__intfp_avx512vbmi_fn size_t __intfp_avx512vbmi_lut8(void *dst, const u8 *src, size_t n,
+		const void *lut, u8 bytes) {
+	if (bytes >= 4)
+		return __intfp_avx512_lut8_gather(dst, src, n, lut, bytes);
+	__m512i t[8];
+	if (bytes == 1) {
+		for (int q = 0; q < 4; q++)
+			t[q] = _mm512_loadu_si512((const u8 *)lut + 64 * q);
+	} else {
+		/* Split the 16-bit entries into a low (t[0-3]) and a high (t[4-7]) byte plane */
+		u8 even[64];
+		for (int j = 0; j < 64; j++)
+			even[j] = (u8)(2 * j);
+		const __m512i lo = _mm512_loadu_si512(even), hi = _mm512_add_epi8(lo, _mm512_set1_epi8(1));
+		for (int q = 0; q < 4; q++) {
+			__m512i a = _mm512_loadu_si512((const u16 *)lut + 64 * q);
+			__m512i b = _mm512_loadu_si512((const u16 *)lut + 64 * q + 32);
+			t[q] = _mm512_permutex2var_epi8(a, lo, b);
+			t[q + 4] = _mm512_permutex2var_epi8(a, hi, b);
+		}
+	}
+	/*
+	 * Unpacking the two planes interleaves the low eight bytes of each
+	 * 128-bit lane into the first output vector and the high eight into the
+	 * second, so qword k of the permuted indices is qword 4 * (k % 2) + k / 2.
+	 */
+	const __m512i perm = _mm512_set_epi64(7, 3, 6, 2, 5, 1, 4, 0);
+	size_t i;
+	for (i = 0; i + 64 <= n; i += 64) {
+		__m512i x = _mm512_loadu_si512(src + i);
+		if (bytes == 2)
+			x = _mm512_permutexvar_epi64(perm, x);
+		__mmask64 m = _mm512_movepi8_mask(x);
+		__m512i l = _mm512_mask_blend_epi8(m, _mm512_permutex2var_epi8(t[0], x, t[1]),
+			_mm512_permutex2var_epi8(t[2], x, t[3]));
+		if (bytes == 1) {
+			_mm512_storeu_si512((u8 *)dst + i, l);
+			continue;
+		}
+		__m512i h = _mm512_mask_blend_epi8(m, _mm512_permutex2var_epi8(t[4], x, t[5]),
+			_mm512_permutex2var_epi8(t[6], x, t[7]));
+		_mm512_storeu_si512((u16 *)dst + i, _mm512_unpacklo_epi8(l, h));
+		_mm512_storeu_si512((u16 *)dst + i + 32, _mm512_unpackhi_epi8(l, h));
+	}
+	return i;
+}
+
+static inline size_t __intfp_simd_lut8(void *dst, const u8 *src, size_t n,
+		const void *lut, u8 bytes) {
+	switch (intfp_isa_get()) {
+	case INTFP_ISA_AVX512_VBMI:
+		return __intfp_avx512vbmi_lut8(dst, src, n, lut, bytes);
+	case INTFP_ISA_AVX512:
+		return __intfp_avx512_lut8(dst, src, n, lut, bytes);
+	case INTFP_ISA_AVX2:
+		return __intfp_avx2_lut8(dst, src, n, lut, bytes);
+	default:
+		return 0;
+	}
+}
+
+#if !defined(INTFP_SELECT) || (defined(INTFP_WITH_POW) && defined(INTFP_WITH_64_32))
+__intfp_avx2_fn size_t __intfp_avx2_lut16(u16 *dst, const u16 *src, size_t n, const u16 *lut) {
+	const __m256i last = _mm256_set1_epi32(0xffff), fill = _mm256_set1_epi32(lut[0xffff]);
+	size_t i;
+	for (i = 0; i + 8 <= n; i += 8) {
+		__m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+		__m256i ok = _mm256_xor_si256(_mm256_cmpeq_epi32(x, last), _mm256_set1_epi32(-1));
+		__m256i r = _mm256_mask_i32gather_epi32(fill, (const int *)lut, x, ok, 2);
+		r = _mm256_and_si256(r, last);
+		_mm_storeu_si128((__m128i *)(dst + i),
+			_mm_packus_epi32(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1)));
+	}
+	return i;
+}
+
+__intfp_avx512_fn size_t __intfp_avx512_lut16(u16 *dst, const u16 *src, size_t n, const u16 *lut) {
+	const __m512i last = _mm512_set1_epi32(0xffff), fill = _mm512_set1_epi32(lut[0xffff]);
+	size_t i;
+	for (i = 0; i + 16 <= n; i += 16) {
+		__m512i x = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)(src + i)));
+		__mmask16 ok = _mm512_cmpneq_epi32_mask(x, last);
+		__m512i r = _mm512_mask_i32gather_epi32(fill, ok, x, lut, 2);
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm512_cvtepi32_epi16(r));
+	}
+	return i;
+}
+
+static inline size_t __intfp_simd_lut16(u16 *dst, const u16 *src, size_t n, const u16 *lut) {
+	switch (intfp_isa_get()) {
+	case INTFP_ISA_AVX512_VBMI:
+	case INTFP_ISA_AVX512:
+		return __intfp_avx512_lut16(dst, src, n, lut);
+	case INTFP_ISA_AVX2:
+		return __intfp_avx2_lut16(dst, src, n, lut);
+	default:
+		return 0;
+	}
+}
+#endif
+
+#endif /* _INTFP_SIMD_H */
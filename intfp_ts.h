@@ -0,0 +1,418 @@
+#ifndef _INTFP_TS_H
+#define _INTFP_TS_H
+/*
+ * Integer-based Fixed-Point and Pseudo-Logarithmic Number Library (intfp)
+ * Time-series codec for 'log'/'pul' values
+ * Copyright (C) 2025 Masahito Suzuki
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * @file intfp_ts.h
+ * @brief A delta-of-delta codec for slowly varying series of 'log'/'pul' codes.
+ *
+ * @details
+ * The codec works on the integer codes themselves: a series of u64 samples
+ * becomes 'log32' codes (u64_to_log32fpmax_corr) or 'pul16' codes
+ * (u64_to_pul16fpmax), and only the codes are delta coded, so decoding
+ * gives exactly the samples' round trip through the format. Any other
+ * 32-bit codes can be stored as INTFP_TS_RAW.
+ *
+ * A stream is a concatenation of blocks, each decodable on its own. All
+ * fields are little-endian:
+ *
+ *   0   u32 size          bytes of the whole block
+ *   4   u32 n             values
+ *   8   u64 first         series index of the first value (the seek point)
+ *   16  u8  version (1), u8 kind (enum intfp_ts_kind), u16 reserved (0)
+ *   20  u32 v0            first code
+ *   24  u32 d0            second code - first code (0 if n < 2)
+ *   28  groups            the other n - 2 values, 32 per group
+ *
+ * A group is one width byte w (0..32) and the 32 zigzag-coded second
+ * differences in w bits each, LSB first (4 * w bytes; a short last group is
+ * padded with zeros). Differences wrap modulo 2^32, so every series is exact.
+ *
+ * The writer only appends: a block is written once, when it is full or
+ * flushed, and the bytes before intfp_ts_writer.len never change.
+ */
+
+#include "intfp.h"
+
+#define INTFP_TS_VERSION 1
+#define INTFP_TS_HEADER_SIZE 28
+#define INTFP_TS_GROUP 32
+#define INTFP_TS_BLOCK_LEN 1024  /**< Default values per block */
+#define INTFP_TS_BLOCK_MAX 4096  /**< Most values per block that intfp_ts_scan() reads */
+
+/** @brief Largest encoding of one block of n values. */
+#define INTFP_TS_BOUND(n) \
+	(INTFP_TS_HEADER_SIZE + ((size_t)(n) + INTFP_TS_GROUP - 1) / INTFP_TS_GROUP * \
+	 (1 + 4 * INTFP_TS_GROUP))
+
+/** @brief What the codes of a stream are. */
+enum intfp_ts_kind {
+	INTFP_TS_RAW = 0,    /**< Any 32-bit codes; no u64 conversion. */
+	INTFP_TS_LOG32 = 1,  /**< u64_to_log32fpmax_corr() codes. */
+	INTFP_TS_PUL16 = 2,  /**< u64_to_pul16fpmax() codes. */
+};
+
+/** @brief An append-only writer into a caller's buffer. */
+struct intfp_ts_writer {
+	u8 *buf;
+	size_t cap;
+	size_t len;      /**< Bytes of finished blocks, a valid stream */
+	u64 count;       /**< Values appended, including the open block */
+	u32 block_len;   /**< Values per block */
+	u8 kind;
+	/* The open block */
+	u32 n, prev, delta;
+	size_t pos;      /**< End of its finished groups */
+	u32 ndd;
+	u32 dd[INTFP_TS_GROUP];
+};
+
+/** @brief A seek point: where the block holding value `first` starts. */
+struct intfp_ts_point {
+	u64 first;
+	u64 offset;
+	u32 n;
+	u8 kind;
+};
+
+static inline u32 __intfp_ts_rd32(const u8 *p) {
+	return p[0] | (u32)p[1] << 8 | (u32)p[2] << 16 | (u32)p[3] << 24;
+}
+static inline void __intfp_ts_wr32(u8 *p, u32 v) {
+	p[0] = (u8)v; p[1] = (u8)(v >> 8); p[2] = (u8)(v >> 16); p[3] = (u8)(v >> 24);
+}
+static inline u64 __intfp_ts_rd64(const u8 *p) {
+	return __intfp_ts_rd32(p) | (u64)__intfp_ts_rd32(p + 4) << 32;
+}
+
+/* Zigzag: small differences of either sign become small unsigned values. */
+static inline u32 __intfp_ts_zig(u32 d) { return d << 1 ^ (u32)((s32)d >> 31); }
+static inline u32 __intfp_ts_unzig(u32 z) { return z >> 1 ^ (0u - (z & 1)); }
+
+/* Writes one group of zigzag values at p; returns its size. */
+static inline size_t __intfp_ts_put_group(u8 *p, const u32 *zz, u32 m) {
+	u32 any = 0;
+	for (u32 k = 0; k < m; k++)
+		any |= zz[k];
+	u8 w = any ? (u8)(32 - __builtin_clz(any)) : 0;
+	u64 acc = 0;
+	unsigned nacc = 0;
+	u8 *q = p + 1;
+	*p = w;
+	for (u32 k = 0; k < INTFP_TS_GROUP; k++) {
+		acc |= (u64)(k < m ? zz[k] : 0) << nacc;
+		nacc += w;
+		if (nacc >= 32) {
+			__intfp_ts_wr32(q, (u32)acc);
+			q += 4;
+			acc >>= 32;
+			nacc -= 32;
+		}
+	}
+	return 1 + 4 * (size_t)w;
+}
+
+/*
+ * Reads the 32 zigzag values of a group of width w from p, which has avail
+ * bytes after it. With 8 bytes to spare every value is one independent
+ * unaligned load; otherwise the bits are streamed.
+ */
+static inline void __intfp_ts_get_group(u32 *zz, const u8 *p, u8 w, size_t avail) {
+	u64 acc = 0, mask = ((u64)1 << w) - 1;
+	unsigned nacc = 0;
+	if (avail >= 4 * (size_t)w + 8) {
+		for (u32 k = 0, pos = 0; k < INTFP_TS_GROUP; k++, pos += w)
+			zz[k] = (u32)(__intfp_ts_rd64(p + (pos >> 3)) >> (pos & 7) & mask);
+		return;
+	}
+	for (u32 k = 0; k < INTFP_TS_GROUP; k++) {
+		if (nacc < w) {
+			acc |= (u64)__intfp_ts_rd32(p) << nacc;
+			p += 4;
+			nacc += 32;
+		}
+		zz[k] = (u32)(acc & mask);
+		acc >>= w;
+		nacc -= w;
+	}
+}
+
+/**
+ * @brief Starts a writer on buf.
+ * @param kind What the codes are (enum intfp_ts_kind).
+ * @param block_len Values per block (seek granularity), up to INTFP_TS_BLOCK_MAX;
+ *        0 for INTFP_TS_BLOCK_LEN.
+ */
+INTFP_API void intfp_ts_writer_init(struct intfp_ts_writer *w, void *buf, size_t cap,
+		u8 kind, u32 block_len) {
+	w->buf = (u8 *)buf;
+	w->cap = cap;
+	w->len = 0;
+	w->count = 0;
+	w->block_len = !block_len ? INTFP_TS_BLOCK_LEN :
+		block_len > INTFP_TS_BLOCK_MAX ? INTFP_TS_BLOCK_MAX : block_len;
+	w->kind = kind;
+	w->n = 0;
+	w->ndd = 0;
+}
+
+/**
+ * @brief Finishes the open block, if any. Afterwards buf[0, len) is a
+ *        complete stream, and the next value starts a new block.
+ * @return len.
+ */
+INTFP_API size_t intfp_ts_flush(struct intfp_ts_writer *w) {
+	if (!w->n) return w->len;
+	u8 *h = w->buf + w->len;
+	if (w->ndd)
+		w->pos += __intfp_ts_put_group(w->buf + w->pos, w->dd, w->ndd);
+	__intfp_ts_wr32(h, (u32)(w->pos - w->len));
+	__intfp_ts_wr32(h + 4, w->n);
+	__intfp_ts_wr32(h + 8, (u32)(w->count - w->n));
+	__intfp_ts_wr32(h + 12, (u32)((w->count - w->n) >> 32));
+	h[16] = INTFP_TS_VERSION;
+	h[17] = w->kind;
+	h[18] = h[19] = 0;
+	if (w->n < 2) __intfp_ts_wr32(h + 24, 0);
+	w->len = w->pos;
+	w->n = 0;
+	w->ndd = 0;
+	return w->len;
+}
+
+/**
+ * @brief Appends codes to the series.
+ * @return The number appended; fewer than n once the buffer is full. Room
+ *         is reserved ahead, so a full buffer never loses appended values.
+ */
+INTFP_API size_t intfp_ts_append(struct intfp_ts_writer *w, const u32 *codes, size_t n) {
+	const size_t group = 1 + 4 * INTFP_TS_GROUP;
+	for (size_t i = 0; i < n; i++) {
+		u32 v = codes[i];
+		if (w->n == 0) {
+			if (w->cap - w->len < INTFP_TS_HEADER_SIZE + group) return i;
+			__intfp_ts_wr32(w->buf + w->len + 20, v);
+			w->pos = w->len + INTFP_TS_HEADER_SIZE;
+		} else if (w->n == 1) {
+			w->delta = v - w->prev;
+			__intfp_ts_wr32(w->buf + w->len + 24, w->delta);
+		} else {
+			/* A full group is written now, and the next one may follow */
+			if (w->ndd == INTFP_TS_GROUP - 1 && w->cap - w->pos < 2 * group) return i;
+			u32 d = v - w->prev;
+			w->dd[w->ndd++] = __intfp_ts_zig(d - w->delta);
+			w->delta = d;
+			if (w->ndd == INTFP_TS_GROUP) {
+				w->pos += __intfp_ts_put_group(w->buf + w->pos, w->dd, INTFP_TS_GROUP);
+				w->ndd = 0;
+			}
+		}
+		w->prev = v;
+		w->n++;
+		w->count++;
+		if (w->n == w->block_len) intfp_ts_flush(w);
+	}
+	return n;
+}
+
+/**
+ * @brief Converts u64 samples to the writer's kind of codes and appends them.
+ * @return The number appended, or 0 for INTFP_TS_RAW and kinds not
+ *         generated in this build.
+ */
+INTFP_API size_t intfp_ts_append_u64(struct intfp_ts_writer *w, const u64 *src, size_t n) {
+	u32 codes[256];
+	u16 pul[256];
+	(void)pul;
+	size_t done = 0;
+	while (done < n) {
+		size_t m = (n - done < 256) ? n - done : 256;
+		switch (w->kind) {
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_32)
+		__intfp_if_corr(case INTFP_TS_LOG32:
+			u64_to_log32fpmax_corr_array((s32 *)codes, src + done, m);
+			break;)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+		__intfp_if_pul(case INTFP_TS_PUL16:
+			u64_to_pul16fpmax_array(pul, src + done, m);
+			for (size_t k = 0; k < m; k++)
+				codes[k] = pul[k];
+			break;)
+#endif
+		default:
+			return 0;
+		}
+		size_t got = intfp_ts_append(w, codes, m);
+		done += got;
+		if (got < m) break;
+	}
+	return done;
+}
+
+/**
+ * @brief Checks the block at src and reads its seek point.
+ * @return 1 if it is a whole, well-formed block of a known kind within size
+ *         bytes, else 0.
+ */
+INTFP_API int intfp_ts_block_info(const u8 *src, size_t size, struct intfp_ts_point *pt) {
+	if (size < INTFP_TS_HEADER_SIZE) return 0;
+	u32 bsize = __intfp_ts_rd32(src), n = __intfp_ts_rd32(src + 4);
+	size_t groups = n > 2 ? (n - 2 + INTFP_TS_GROUP - 1) / INTFP_TS_GROUP : 0;
+	if (bsize > size || bsize < INTFP_TS_HEADER_SIZE + groups || n == 0 ||
+	    src[16] != INTFP_TS_VERSION || src[17] > INTFP_TS_PUL16)
+		return 0;
+	pt->first = __intfp_ts_rd64(src + 8);
+	pt->offset = 0;
+	pt->n = n;
+	pt->kind = src[17];
+	return 1;
+}
+
+/**
+ * @brief Decodes the codes of one block.
+ * @param dst Output for up to max_n codes.
+ * @return The number of codes, or (size_t)-1 for a damaged block or one of
+ *         more than max_n values.
+ */
+INTFP_API size_t intfp_ts_block_decode(u32 *dst, size_t max_n, const u8 *src, size_t size) {
+	struct intfp_ts_point pt;
+	u32 zz[INTFP_TS_GROUP];
+	if (!intfp_ts_block_info(src, size, &pt) || pt.n > max_n) return (size_t)-1;
+	const u8 *p = src + INTFP_TS_HEADER_SIZE, *end = src + __intfp_ts_rd32(src);
+	u32 v = __intfp_ts_rd32(src + 20), d = __intfp_ts_rd32(src + 24);
+	dst[0] = v;
+	if (pt.n > 1) dst[1] = v += d;
+	for (u32 i = 2; i < pt.n; i += INTFP_TS_GROUP) {
+		if (p == end) return (size_t)-1;  /* More values than groups */
+		u8 w = *p;
+		if (w > 32 || (size_t)(end - p) < 1 + 4 * (size_t)w) return (size_t)-1;
+		__intfp_ts_get_group(zz, p + 1, w, (size_t)(end - p) - 1);
+		p += 1 + 4 * (size_t)w;
+		u32 m = (pt.n - i < INTFP_TS_GROUP) ? pt.n - i : INTFP_TS_GROUP;
+		for (u32 k = 0; k < m; k++) {
+			d += __intfp_ts_unzig(zz[k]);
+			dst[i + k] = v += d;
+		}
+	}
+	return p == end ? pt.n : (size_t)-1;
+}
+
+/**
+ * @brief Lists the seek points of a stream.
+ * @param pts Output for up to max points, one per block, or NULL to count.
+ * @return The number of blocks, stopping at the first damaged or cut block.
+ */
+INTFP_API size_t intfp_ts_index(const u8 *src, size_t size, struct intfp_ts_point *pts,
+		size_t max) {
+	size_t nb = 0, off = 0;
+	struct intfp_ts_point pt;
+	while (intfp_ts_block_info(src + off, size - off, &pt)) {
+		if (pts && nb < max) {
+			pts[nb] = pt;
+			pts[nb].offset = off;
+		}
+		nb++;
+		off += __intfp_ts_rd32(src + off);
+	}
+	return nb;
+}
+
+/* intfp_ts_scan(), also stopping at a block not of `kind` unless it is -1 */
+static inline size_t __intfp_ts_scan(u32 *dst, const u8 *src, size_t size,
+		const struct intfp_ts_point *pts, size_t npts, u64 first, size_t n, int kind) {
+	u32 codes[INTFP_TS_BLOCK_MAX];
+	size_t lo = 0, hi = npts, done = 0;
+	/* The last block starting at or before first */
+	while (hi - lo > 1) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (pts[mid].first <= first) lo = mid;
+		else hi = mid;
+	}
+	for (size_t b = lo; b < npts && done < n; b++) {
+		const struct intfp_ts_point *pt = &pts[b];
+		u64 at = first + done;
+		if (at < pt->first || at >= pt->first + pt->n) break;
+		u32 *out = codes;
+		if (at == pt->first && n - done >= pt->n) out = dst + done;
+		else if (pt->n > INTFP_TS_BLOCK_MAX) break;
+		if (intfp_ts_block_decode(out, pt->n, src + pt->offset, size - pt->offset) != pt->n ||
+		    (kind >= 0 && src[pt->offset + 17] != kind))
+			break;
+		size_t skip = (size_t)(at - pt->first), m = pt->n - skip;
+		if (m > n - done) m = n - done;
+		if (out == codes)
+			for (size_t k = 0; k < m; k++)
+				dst[done + k] = codes[skip + k];
+		done += m;
+	}
+	return done;
+}
+
+/**
+ * @brief Decodes the codes of values [first, first + n) of a stream.
+ * @param pts The stream's seek points from intfp_ts_index().
+ * @return The number of codes decoded: fewer than n where the stream ends
+ *         or a block is damaged.
+ */
+INTFP_API size_t intfp_ts_scan(u32 *dst, const u8 *src, size_t size,
+		const struct intfp_ts_point *pts, size_t npts, u64 first, size_t n) {
+	return __intfp_ts_scan(dst, src, size, pts, npts, first, n, -1);
+}
+
+/**
+ * @brief Decodes values [first, first + n) of a stream to u64 samples.
+ * @param kind The stream's kind; INTFP_TS_LOG32 or INTFP_TS_PUL16.
+ * @return As intfp_ts_scan(), also stopping at a block of another kind; 0
+ *         for other kinds.
+ */
+INTFP_API size_t intfp_ts_scan_u64(u64 *dst, const u8 *src, size_t size,
+		const struct intfp_ts_point *pts, size_t npts, u64 first, size_t n, u8 kind) {
+	u32 codes[INTFP_TS_BLOCK_MAX];
+	u16 pul[INTFP_TS_BLOCK_MAX];
+	(void)pul;
+	size_t done = 0;
+	while (done < n) {
+		size_t m = (n - done < INTFP_TS_BLOCK_MAX) ? n - done : INTFP_TS_BLOCK_MAX;
+		size_t got = __intfp_ts_scan(codes, src, size, pts, npts, first + done, m, kind);
+		switch (kind) {
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_32)
+		__intfp_if_corr(case INTFP_TS_LOG32:
+			log32fpmax_to_u64_corr_array(dst + done, (const s32 *)codes, got);
+			break;)
+#endif
+#if !defined(INTFP_SELECT) || defined(INTFP_WITH_64_16)
+		__intfp_if_pul(case INTFP_TS_PUL16:
+			for (size_t k = 0; k < got; k++)
+				pul[k] = (u16)codes[k];
+			pul16fpmax_to_u64_array(dst + done, pul, got);
+			break;)
+#endif
+		default:
+			return 0;
+		}
+		done += got;
+		if (got < m) break;
+	}
+	return done;
+}
+
+#endif /* _INTFP_TS_H */
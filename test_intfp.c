@@ -22,7 +22,21 @@ typedef int16_t   s16;
 typedef int32_t   s32;
 typedef int64_t   s64;
 
-#include "intfp.h"
+// Tables are defined once, in test_intfp_link.c
+#define INTFP_SHARED_TABLES
+#include "intfp_mt.h"
+#include "intfp_col.h"
+#include "intfp_rans.h"
+#include "intfp_ts.h"
+#include "intfp_packed.h"
+#include "intfp_bfp.h"
+#include "intfp_res.h"
+
+// Implemented in test_intfp_link.c, a second unit including intfp.h
+s32 link_u64_to_log32fpmax_corr(u64 v);
+u64 link_log32fpmax_to_u64_corr(s32 v);
+const u16 *link_enc_corr_lut(void);
+enum intfp_isa link_isa_get(void);
 
 // Test result structure
 typedef struct {
@@ -45,6 +59,26 @@ void print_usage(const char *prog_name) {
     printf("  -l                  Run log arithmetic test\n");
     printf("  -p                  Run precision test\n");
     printf("  -r                  Run radix conversion test\n");
+    printf("  -a                  Run batch (array) conversion test\n");
+    printf("  -k                  Run multi-unit linkage test\n");
+    printf("  -f                  Run fixed-format variant test\n");
+    printf("  -n                  Run branch-free variant test\n");
+    printf("  -g                  Run log-domain addition test\n");
+    printf("  -s                  Run signed log (slog) test\n");
+    printf("  -m                  Run saturating log arithmetic test\n");
+    printf("  -d                  Run approximate muldiv test\n");
+    printf("  -q                  Run exact division test\n");
+    printf("  -t                  Run integer root test\n");
+    printf("  -w                  Run fractional power test\n");
+    printf("  -i                  Run power-law table test\n");
+    printf("  -j                  Run 8-bit table decode test\n");
+    printf("  -x                  Run multithreaded batch conversion test\n");
+    printf("  -o                  Run columnar container test\n");
+    printf("  -u                  Run entropy-coded block test\n");
+    printf("  -y                  Run time-series codec test\n");
+    printf("  -z                  Run bit-packed array test\n");
+    printf("  -B                  Run block floating point test\n");
+    printf("  -R                  Run lossless residual test\n");
     printf("  -v, --verbose       Verbose output\n");
     printf("  -h, --help          Show this help message\n");
 }
@@ -68,6 +102,7 @@ void print_percentage_error(unsigned long long original, unsigned long long reco
 }
 
 void print_final_summary(void) {
+
     printf("\n========================================");
     printf("\nTest Summary:");
     printf("\n  Tests Run: %d", tests_run);
@@ -262,6 +297,17 @@ int test_log_arithmetic(bool verbose) {
         passed = false;
     }
 
+    // Values below 1.0 (negative log values) round trip through every decoder
+    for (u64 v = 1; v < (1ULL << 16); v += 7) {
+        s32 l = u64fp_to_log32fp(v, 16, 24);
+        if (log32fp_to_u64fp(l, 24, 16) != v || log32fp_to_u64fp_bf(l, 24, 16) != v) {
+            printf("  FAIL: Q16 %llu -> log %d -> %llu\n", (unsigned long long)v, l,
+                   (unsigned long long)log32fp_to_u64fp(l, 24, 16));
+            passed = false;
+            break;
+        }
+    }
+
     if (passed) tests_passed++;
     else tests_failed++;
 
@@ -390,6 +436,12 @@ int test_precision(bool verbose) {
         u64 dec_one = log32fpmax_to_u64_corr(log_one);
         if (dec_one == 0 || dec_one > 2) boundary_ok = false;
 
+        // Fixed-point values below 1.0 must stay negative (not clamp to max)
+        for (u8 lv = 1; lv <= 3; lv++) {
+            s32 log_frac = u32fp_to_log32fp_corr_n(3, 16, 20, lv);
+            if (log_frac >= 0) boundary_ok = false;
+        }
+
         // Powers of 2 should have minimal error
         for (int p = 1; p < 40; p++) {
             u64 val = 1ULL << p;
@@ -499,6 +551,1902 @@ int test_radix_conversion(bool verbose) {
     return passed ? 1 : 0;
 }
 
+// Small deterministic PRNG for randomized tests (xorshift64*)
+static u64 test_rng_state = 0x9E3779B97F4A7C15ULL;
+static u64 test_rand64(void) {
+    test_rng_state ^= test_rng_state >> 12;
+    test_rng_state ^= test_rng_state << 25;
+    test_rng_state ^= test_rng_state >> 27;
+    return test_rng_state * 0x2545F4914F6CDD1DULL;
+}
+// Random value with a uniformly distributed bit length (exercises every exponent)
+static u64 test_rand_bits(u8 bits) {
+    u8 len = test_rand64() % (bits + 1);
+    return len ? test_rand64() >> (64 - len) : 0;
+}
+
+static const char *isa_name(enum intfp_isa isa) {
+    switch (isa) {
+        case INTFP_ISA_AVX512_VBMI: return "avx512vbmi";
+        case INTFP_ISA_AVX512:      return "avx512";
+        case INTFP_ISA_AVX2:        return "avx2";
+        default:                    return "scalar";
+    }
+}
+
+#define BATCH_TEST_N 203  /* Not a multiple of any vector width: exercises the scalar tail */
+
+/*
+ * Compares every '_array' conversion of one width pair against the scalar
+ * function, element by element. Inputs cover random magnitudes plus the
+ * special encodings of 0 and 1.
+ */
+#define TEST_BATCH_PAIR(hbits, lbits) do { \
+    static u##hbits h_src[BATCH_TEST_N], h_dst[BATCH_TEST_N]; \
+    static u##lbits p_src[BATCH_TEST_N], p_dst[BATCH_TEST_N]; \
+    static s##lbits l_src[BATCH_TEST_N], l_dst[BATCH_TEST_N]; \
+    int errs = 0; \
+    for (int i = 0; i < BATCH_TEST_N; i++) { \
+        h_src[i] = (u##hbits)test_rand_bits(hbits); \
+        p_src[i] = (u##lbits)test_rand64(); \
+        l_src[i] = (s##lbits)test_rand64() >> (test_rand64() % lbits); \
+    } \
+    h_src[0] = 0; h_src[1] = 1; h_src[2] = intfp_unsigned_max(hbits); \
+    p_src[0] = intfp_pul_0(lbits); p_src[1] = 0; \
+    l_src[0] = intfp_log_0(lbits); l_src[1] = 0; l_src[2] = -1; \
+    for (u8 fp = 1; fp <= intfp_pul_fpmax(hbits, lbits); fp++) { \
+        u##hbits##_to_pul##lbits##fp_array(p_dst, h_src, BATCH_TEST_N, fp); \
+        for (int i = 0; i < BATCH_TEST_N; i++) \
+            errs += p_dst[i] != u##hbits##_to_pul##lbits##fp(h_src[i], fp); \
+        pul##lbits##fp_to_u##hbits##_array(h_dst, p_src, BATCH_TEST_N, fp); \
+        for (int i = 0; i < BATCH_TEST_N; i++) \
+            errs += h_dst[i] != pul##lbits##fp_to_u##hbits(p_src[i], fp); \
+    } \
+    for (u8 fp = 1; fp <= intfp_log_fpmax(hbits, lbits); fp++) { \
+        u8 xfp = fp % (hbits / 2); \
+        u##hbits##fp_to_log##lbits##fp_array(l_dst, h_src, BATCH_TEST_N, xfp, fp); \
+        for (int i = 0; i < BATCH_TEST_N; i++) \
+            errs += l_dst[i] != u##hbits##fp_to_log##lbits##fp(h_src[i], xfp, fp); \
+        log##lbits##fp_to_u##hbits##fp_array(h_dst, l_src, BATCH_TEST_N, fp, xfp); \
+        for (int i = 0; i < BATCH_TEST_N; i++) \
+            errs += h_dst[i] != log##lbits##fp_to_u##hbits##fp(l_src[i], fp, xfp); \
+        for (u8 lv = 1; lv <= 3; lv++) { \
+            u##hbits##fp_to_log##lbits##fp_corr_n_array(l_dst, h_src, BATCH_TEST_N, xfp, fp, lv); \
+            for (int i = 0; i < BATCH_TEST_N; i++) \
+                errs += l_dst[i] != u##hbits##fp_to_log##lbits##fp_corr_n(h_src[i], xfp, fp, lv); \
+            log##lbits##fp_to_u##hbits##fp_corr_n_array(h_dst, l_src, BATCH_TEST_N, fp, xfp, lv); \
+            for (int i = 0; i < BATCH_TEST_N; i++) \
+                errs += h_dst[i] != log##lbits##fp_to_u##hbits##fp_corr_n(l_src[i], fp, xfp, lv); \
+        } \
+    } \
+    if (verbose || errs) \
+        printf("  %-10s u%-2d <-> pul/log%-2d: %d mismatches\n", \
+               isa_name(intfp_isa_get()), hbits, lbits, errs); \
+    if (errs) passed = false; \
+} while (0)
+
+// Test: Batch (array) conversions on every available instruction set
+int test_batch_conversion(bool verbose) {
+    tests_run++;
+    int passed = true;
+
+    if (verbose) {
+        printf("\n=== Testing Batch Conversions ===\n");
+    }
+
+    enum intfp_isa max_isa = intfp_isa_get();
+    for (int isa = INTFP_ISA_SCALAR; isa <= (int)max_isa; isa++) {
+        intfp_isa_set((enum intfp_isa)isa);
+        TEST_BATCH_PAIR( 8, 8);
+        TEST_BATCH_PAIR(16, 8);
+        TEST_BATCH_PAIR(32, 8);
+        TEST_BATCH_PAIR(64, 8);
+        TEST_BATCH_PAIR(16,16);
+        TEST_BATCH_PAIR(32,16);
+        TEST_BATCH_PAIR(64,16);
+        TEST_BATCH_PAIR(32,32);
+        TEST_BATCH_PAIR(64,32);
+        TEST_BATCH_PAIR(64,64);
+    }
+    intfp_isa_set(max_isa);
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Batch Conversion", passed);
+
+    return passed ? 1 : 0;
+}
+
+// Fixed-format variants exercised by test_fixed_format()
+INTFP_DECL_PUL_FP(64, 16, 10)
+INTFP_DECL_PUL_FP(32, 8, 3)
+INTFP_DECL_LOG_FP(64, 32, 20)
+INTFP_DECL_LOG_FP(32, 16, 6)
+INTFP_DECL_LOG_FP(16, 8, 4)
+
+// Compares a fixed-format encoder/decoder pair against the generic functions
+#define TEST_FIXED_LOG(hbits, lbits, nfp) do { \
+    for (int i = 0; i < 2000; i++) { \
+        u##hbits v = (u##hbits)test_rand_bits(hbits); \
+        s##lbits l = u##hbits##_to_log##lbits##fp(v, nfp); \
+        s##lbits c = u##hbits##_to_log##lbits##fp_corr(v, nfp); \
+        if (u##hbits##_to_log##lbits##fp##nfp(v) != l || \
+            log##lbits##fp##nfp##_to_u##hbits(l) != log##lbits##fp_to_u##hbits(l, nfp) || \
+            u##hbits##_to_log##lbits##fp##nfp##_corr(v) != c || \
+            log##lbits##fp##nfp##_to_u##hbits##_corr(c) != log##lbits##fp_to_u##hbits##_corr(c, nfp)) \
+            errs++; \
+        for (u8 lv = 0; lv <= 3; lv++) \
+            if (u##hbits##_to_log##lbits##fp##nfp##_corr_n(v, lv) != \
+                    u##hbits##_to_log##lbits##fp_corr_n(v, nfp, lv) || \
+                log##lbits##fp##nfp##_to_u##hbits##_corr_n(c, lv) != \
+                    log##lbits##fp_to_u##hbits##_corr_n(c, nfp, lv)) \
+                errs++; \
+    } \
+} while (0)
+
+#define TEST_FIXED_PUL(hbits, lbits, nfp) do { \
+    for (int i = 0; i < 2000; i++) { \
+        u##hbits v = (u##hbits)test_rand_bits(hbits); \
+        u##lbits p = u##hbits##_to_pul##lbits##fp(v, nfp); \
+        if (u##hbits##_to_pul##lbits##fp##nfp(v) != p || \
+            pul##lbits##fp##nfp##_to_u##hbits(p) != pul##lbits##fp_to_u##hbits(p, nfp)) \
+            errs++; \
+    } \
+} while (0)
+
+// Test: Fixed-format variants and constant-expression fpmax macros
+int test_fixed_format(bool verbose) {
+    tests_run++;
+    int passed = true;
+    int errs = 0;
+
+    if (verbose) {
+        printf("\n=== Testing Fixed-Format Variants ===\n");
+    }
+
+    // The macros are constant expressions and match the functions
+    static const u8 log_fpmax_64_32 = INTFP_LOG_FPMAX(64, 32);
+    if (log_fpmax_64_32 != intfp_log_fpmax(64, 32)) errs++;
+    for (int h = 8; h <= 64; h *= 2) {
+        for (int l = 8; l <= h; l *= 2) {
+            if (INTFP_PUL_FPMAX(h, l) != intfp_pul_fpmax(h, l) ||
+                INTFP_LOG_FPMAX(h, l) != intfp_log_fpmax(h, l)) {
+                printf("  FAIL: fpmax macro mismatch for %d/%d\n", h, l);
+                errs++;
+            }
+        }
+    }
+
+    TEST_FIXED_PUL(64, 16, 10);
+    TEST_FIXED_PUL(32, 8, 3);
+    TEST_FIXED_LOG(64, 32, 20);
+    TEST_FIXED_LOG(32, 16, 6);
+    TEST_FIXED_LOG(16, 8, 4);
+
+    if (errs) {
+        printf("  FAIL: %d fixed-format results differ from the generic functions\n", errs);
+        passed = false;
+    } else if (verbose) {
+        printf("  pul16fp10, pul8fp3, log32fp20, log16fp6, log8fp4 match the generic functions\n");
+    }
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Fixed-Format Variants", passed);
+
+    return passed ? 1 : 0;
+}
+
+/*
+ * Compares the branch-free variants of one width pair against the branching
+ * ones: random integers, the 0/1 special cases, and raw random codes, which
+ * hit the zero, underflow and saturation paths of the decoders.
+ */
+#define TEST_BF_PAIR(hbits, lbits) do { \
+    const u8 pfp = intfp_pul_fpmax(hbits, lbits); \
+    const u8 lfp = intfp_log_fpmax(hbits, lbits); \
+    for (int i = 0; i < 3000; i++) { \
+        u##hbits v = (i < 2) ? (u##hbits)i : (u##hbits)test_rand_bits(hbits); \
+        u##lbits pc = (u##lbits)test_rand64(); \
+        s##lbits lc = (i < 2) ? intfp_log_0(lbits) : (s##lbits)test_rand64(); \
+        u8 nfp = (u8)(test_rand64() % hbits); \
+        if (u##hbits##_to_pul##lbits##fp_bf(v, pfp) != u##hbits##_to_pul##lbits##fp(v, pfp) || \
+            u##hbits##_to_pul##lbits##fpmax_bf(v) != u##hbits##_to_pul##lbits##fpmax(v) || \
+            pul##lbits##fp_to_u##hbits##_bf(pc, pfp) != pul##lbits##fp_to_u##hbits(pc, pfp) || \
+            pul##lbits##fpmax_to_u##hbits##_bf(pc) != pul##lbits##fpmax_to_u##hbits(pc) || \
+            u##hbits##fp_to_log##lbits##fp_bf(v, nfp, lfp) != \
+                u##hbits##fp_to_log##lbits##fp(v, nfp, lfp) || \
+            u##hbits##_to_log##lbits##fpmax_bf(v) != u##hbits##_to_log##lbits##fpmax(v) || \
+            log##lbits##fp_to_u##hbits##fp_bf(lc, lfp, nfp) != \
+                log##lbits##fp_to_u##hbits##fp(lc, lfp, nfp) || \
+            log##lbits##fpmax_to_u##hbits##_bf(lc) != log##lbits##fpmax_to_u##hbits(lc)) { \
+            if (verbose && errs < 8) \
+                printf("  FAIL: %d/%d v=%llu pul=%llu log=%lld fp=%u\n", hbits, lbits, \
+                       (unsigned long long)v, (unsigned long long)pc, (long long)lc, nfp); \
+            errs++; \
+        } \
+    } \
+} while (0)
+
+// Test: Branch-free variants return the same results as the branching ones
+int test_branch_free(bool verbose) {
+    tests_run++;
+    int passed = true;
+    int errs = 0;
+
+    if (verbose) {
+        printf("\n=== Testing Branch-Free Variants ===\n");
+    }
+
+    TEST_BF_PAIR(8, 8);
+    TEST_BF_PAIR(16, 8);
+    TEST_BF_PAIR(32, 8);
+    TEST_BF_PAIR(64, 8);
+    TEST_BF_PAIR(16, 16);
+    TEST_BF_PAIR(32, 16);
+    TEST_BF_PAIR(64, 16);
+    TEST_BF_PAIR(32, 32);
+    TEST_BF_PAIR(64, 32);
+    TEST_BF_PAIR(64, 64);
+
+    if (errs) {
+        printf("  FAIL: %d branch-free results differ from the branching functions\n", errs);
+        passed = false;
+    } else if (verbose) {
+        printf("  pul/log encode and decode _bf variants match for every width pair\n");
+    }
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Branch-Free Variants", passed);
+
+    return passed ? 1 : 0;
+}
+
+/*
+ * Compares log-domain addition/subtraction of one width against libm on
+ * random operands with fp fractional bits; tol is in log2 units on top of
+ * the result's own rounding.
+ */
+#define TEST_LOG_ADD_BITS(bits, fp, tol) do { \
+    double sc_ = ldexp(1.0, fp), max_add_ = 0, max_sub_ = 0; \
+    for (int i = 0; i < 20000; i++) { \
+        /* Operands up to 2^(bits-fp-3), differences mostly below 20 */ \
+        s##bits a = (s##bits)(test_rand64() >> (64 - (bits - 3))); \
+        s##bits d = (s##bits)(test_rand64() >> (64 - (fp + ((i & 1) ? 5 : 1)))); \
+        s##bits b = a - d; \
+        double A = ldexp((double)a, -(fp)), B = ldexp((double)b, -(fp)); \
+        double add = fmax(A, B) + log2(1.0 + exp2(-fabs(A - B))); \
+        double r = ldexp((double)log##bits##fp_add(a, b, fp), -(fp)); \
+        if (fabs(r - add) > max_add_) max_add_ = fabs(r - add); \
+        if (A > B) { \
+            double sub = A + log2(-expm1((B - A) * log(2.0))); \
+            r = ldexp((double)log##bits##fp_sub(a, b, fp), -(fp)); \
+            if (fabs(r - sub) > max_sub_) max_sub_ = fabs(r - sub); \
+        } \
+    } \
+    if (max_add_ > (tol) + 0.5 / sc_ || max_sub_ > (tol) + 0.5 / sc_) { \
+        printf("  FAIL: log%d (fp %d) max error add %.3g, sub %.3g\n", \
+               bits, fp, max_add_, max_sub_); \
+        passed = false; \
+    } else if (verbose) { \
+        printf("  log%d (fp %d): max error add %.3g, sub %.3g (log2 units)\n", \
+               bits, fp, max_add_, max_sub_); \
+    } \
+} while (0)
+
+// Test: Log-domain addition and subtraction (Gaussian logarithm)
+int test_log_add(bool verbose) {
+    tests_run++;
+    int passed = true;
+
+    if (verbose) {
+        printf("\n=== Testing Log-Domain Addition/Subtraction ===\n");
+    }
+
+    TEST_LOG_ADD_BITS(16, 8, 2.5e-4);
+    TEST_LOG_ADD_BITS(32, 25, 2.5e-4);
+    TEST_LOG_ADD_BITS(64, 40, 2.5e-4);
+    TEST_LOG_ADD_BITS(64, 57, 2.5e-4);
+
+    // Zero is the identity, a - b clamps at zero, sums saturate
+    const s32 l0 = intfp_log_0(32);
+    s32 x = u64_to_log32fpmax(12345);
+    if (log32fp_add(x, l0, 25) != x || log32fp_add(l0, x, 25) != x ||
+        log32fp_add(l0, l0, 25) != l0 || log32fp_sub(x, l0, 25) != x ||
+        log32fp_sub(x, x, 25) != l0 || log32fp_sub(l0, x, 25) != l0 ||
+        log32fp_add(intfp_signed_max(32), intfp_signed_max(32), 25) != intfp_signed_max(32) ||
+        log8fp_add(intfp_signed_max(8), 120, 2) != intfp_signed_max(8) ||
+        log8fp_sub(-126, -127, 1) != intfp_log_0(8)) {
+        printf("  FAIL: zero, clamping or saturation\n");
+        passed = false;
+    }
+
+    // A sum of products stays in 'log' form: sum(v[i] * w[i])
+    u64 v[] = { 1000, 250000, 42, 7777777, 31 };
+    u64 w[] = { 3, 17, 100000, 2, 999 };
+    u64 exact = 0;
+    s32 acc = l0;
+    for (int i = 0; i < 5; i++) {
+        exact += v[i] * w[i];
+        acc = log32fp_add(acc, u64_to_log32fp_corr_n(v[i], 25, 3) +
+                               u64_to_log32fp_corr_n(w[i], 25, 3), 25);
+    }
+    u64 sum = log32fp_to_u64_corr_n(acc, 25, 3);
+    double err = fabs((double)sum - (double)exact) / (double)exact;
+    if (err > 0.001) {
+        printf("  FAIL: weighted sum %llu, expected %llu\n",
+               (unsigned long long)sum, (unsigned long long)exact);
+        passed = false;
+    } else if (verbose) {
+        printf("  Weighted sum in log form: %llu (exact %llu, error %.4f%%)\n",
+               (unsigned long long)sum, (unsigned long long)exact, err * 100);
+    }
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Log-Domain Addition", passed);
+
+    return passed ? 1 : 0;
+}
+
+// Test: Signed log number system (slog)
+int test_slog(bool verbose) {
+    tests_run++;
+    int passed = true;
+    int errs = 0;
+
+    if (verbose) {
+        printf("\n=== Testing Signed Log (slog) ===\n");
+    }
+
+    // Round trips keep the sign and the 'log' precision of the magnitude
+    for (int i = 0; i < 10000; i++) {
+        s64 v = (s64)test_rand64() >> (test_rand64() & 63);
+        s32 l = s64_to_slog32fpmax(v);
+        s64 r = slog32fpmax_to_s64(l);
+        s64 rc = slog32fpmax_to_s64_corr(s64_to_slog32fpmax_corr(v));
+        bool sign_ok = (v < 0) == (r < 0) && (v < 0) == (rc < 0) && (v == 0) == (r == 0);
+        double ev = fabs((double)r - (double)v), evc = fabs((double)rc - (double)v);
+        if (!sign_ok || ev > fabs((double)v) * 0.07 + 1 || evc > fabs((double)v) * 0.01 + 1) {
+            if (errs++ < 5) {
+                printf("  FAIL: s64 %lld -> slog32 -> %lld / _corr %lld\n",
+                       (long long)v, (long long)r, (long long)rc);
+            }
+        }
+        s16 v16 = (s16)v;
+        s16 r16 = slog16fp_to_s16fp(s16fp_to_slog16fp(v16, 0, INTFP_SLOG_FPMAX(16, 16)),
+                                    INTFP_SLOG_FPMAX(16, 16), 0);
+        if ((v16 < 0) != (r16 < 0) ||
+            fabs((double)r16 - (double)v16) > fabs((double)v16) * 0.07 + 1) {
+            if (errs++ < 5) {
+                printf("  FAIL: s16 %d -> slog16 -> %d\n", v16, r16);
+            }
+        }
+    }
+    // Zero and the most negative integers
+    if (s32_to_slog16fpmax(0) != intfp_slog_0(16) ||
+        slog16fpmax_to_s32(intfp_slog_0(16)) != 0 ||
+        slog64fpmax_to_s64(s64_to_slog64fpmax(INT64_MIN)) != INT64_MIN ||
+        slog32fpmax_to_s32(s32_to_slog32fpmax(INT32_MIN)) != INT32_MIN ||
+        slog8fpmax_to_s8(s8_to_slog8fpmax(-128)) != -128 ||
+        slog8fpmax_to_s8(s8_to_slog8fpmax(-1)) != -1) {
+        printf("  FAIL: zero or minimum integer round trip\n");
+        errs++;
+    }
+
+    // Multiply/divide against exact signed results
+    for (int i = 0; i < 10000; i++) {
+        s32 a = (s32)test_rand64() >> (test_rand64() & 31);
+        s32 b = (s32)test_rand64() >> (test_rand64() & 31);
+        if (a == 0 || b == 0) continue;
+        s32 la = s64_to_slog32fpmax_corr(a), lb = s64_to_slog32fpmax_corr(b);
+        double p = (double)slog32fpmax_to_s64_corr(slog32_mul(la, lb));
+        double q = ldexp((double)slog32fp_to_s64fp_corr(slog32_div(la, lb),
+                         INTFP_SLOG_FPMAX(64, 32), 16), -16);
+        double ep = (double)a * b, eq = (double)a / b;
+        if (fabs(p - ep) > fabs(ep) * 0.03 + 1 ||
+            fabs(q - eq) > fabs(eq) * 0.03 + ldexp(1.0, -16)) {
+            if (errs++ < 5) {
+                printf("  FAIL: %d * %d = %.0f (got %.0f), %d / %d = %g (got %g)\n",
+                       a, b, ep, p, a, b, eq, q);
+            }
+        }
+    }
+
+    // Zero propagation, saturation, neg/abs
+    const s16 z = intfp_slog_0(16);
+    s16 m = s32_to_slog16fpmax(-300), big = intfp_signed_max(16);
+    s16 tiny = intfp_slog_0(16) + 2;  // smallest nonzero magnitude, positive
+    if (slog16_mul(m, z) != z || slog16_mul(z, m) != z || slog16_div(z, m) != z ||
+        slog16_div(m, z) != (big | 1) || slog16_div(z, z) != z ||
+        slog16_mul(big, big) != (s16)(big & ~1) ||
+        slog16_mul(big & ~1, big | 1) != big ||
+        slog16_mul(tiny, tiny) != z || slog16_div(tiny, big) != z ||
+        slog16_div(big, tiny) != big ||
+        slog16_neg(z) != z || slog16_neg(slog16_neg(m)) != m ||
+        slog16fpmax_to_s32(slog16_neg(m)) != -slog16fpmax_to_s32(m) ||
+        slog16_abs(m) != s32_to_slog16fpmax(300) ||
+        slog16_mul(m, m) != slog16_mul(slog16_abs(m), slog16_abs(m))) {
+        printf("  FAIL: zero propagation, saturation or neg/abs\n");
+        errs++;
+    }
+
+    if (errs) {
+        passed = false;
+    } else if (verbose) {
+        printf("  Round trips, signed mul/div, zero and saturation OK\n");
+    }
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Signed Log (slog)", passed);
+
+    return passed ? 1 : 0;
+}
+
+// Saturating reference for a + b in [lo, hi]; a, b lie in that range too
+static s64 ref_sat_add(s64 a, s64 b, s64 lo, s64 hi) {
+    if (b > 0 && a > hi - b) return hi;
+    if (b < 0 && a < lo - b) return lo;
+    return a + b;
+}
+
+// Draws a 'log' operand: zero, the extremes or up to 2 steps inside them, or
+// random bits of random length
+#define TEST_LOG_OPERAND(bits) \
+    ((test_rand64() % 8 == 0) ? \
+        ((test_rand64() & 1) ? (s##bits)(intfp_log_0(bits) + (s##bits)(test_rand64() % 3)) : \
+            (s##bits)(intfp_signed_max(bits) - (s##bits)(test_rand64() % 3))) : \
+        (s##bits)((s64)test_rand64() >> (64 - bits + test_rand64() % bits)))
+
+// Compares saturating mul/div/pow of one width and its arrays against a reference
+#define TEST_LOG_ARITH_BITS(bits) do { \
+    const s64 lo_ = intfp_log_0(bits), hi_ = intfp_signed_max(bits); \
+    for (int i = 0; i < 50000; i++) { \
+        s##bits a = TEST_LOG_OPERAND(bits), b = TEST_LOG_OPERAND(bits); \
+        s32 k = (s32)(test_rand64() % 141) - 70; \
+        s64 m = (a == lo_ || b == lo_) ? lo_ : ref_sat_add(a, b, lo_, hi_); \
+        s64 d = (a == lo_) ? lo_ : (b == lo_) ? hi_ : ref_sat_add(a, -(s64)b, lo_, hi_); \
+        s64 p; \
+        double pd = (double)a * k; \
+        if (a == lo_) p = (k > 0) ? lo_ : (k < 0) ? hi_ : 0; \
+        else if (pd >= (double)hi_) p = hi_; \
+        else if (pd <= (double)lo_) p = lo_; \
+        else p = (s64)a * k; \
+        bool near_ = fabs(fabs(pd) - (double)hi_) < 4096.0; /* double is inexact here */ \
+        if (log##bits##_mul(a, b) != m || log##bits##_div(a, b) != d || \
+            (!near_ && log##bits##_pow(a, k) != p)) { \
+            if (errs++ < 5) \
+                printf("  FAIL: log%d a=%lld b=%lld k=%d: mul %lld/%lld div %lld/%lld pow %lld/%lld\n", \
+                       bits, (long long)a, (long long)b, k, \
+                       (long long)log##bits##_mul(a, b), (long long)m, \
+                       (long long)log##bits##_div(a, b), (long long)d, \
+                       (long long)log##bits##_pow(a, k), (long long)p); \
+        } \
+    } \
+    static s##bits xa_[1003], xb_[1003], xm_[1003], xd_[1003]; \
+    for (int i = 0; i < 1003; i++) { \
+        xa_[i] = TEST_LOG_OPERAND(bits); \
+        xb_[i] = TEST_LOG_OPERAND(bits); \
+    } \
+    enum intfp_isa max_isa_ = intfp_isa_get(); \
+    for (int isa = INTFP_ISA_SCALAR; isa <= (int)max_isa_; isa++) { \
+        intfp_isa_set((enum intfp_isa)isa); \
+        log##bits##_mul_array(xm_, xa_, xb_, 1003); \
+        log##bits##_div_array(xd_, xa_, xb_, 1003); \
+        for (int i = 0; i < 1003; i++) { \
+            if (xm_[i] != log##bits##_mul(xa_[i], xb_[i]) || \
+                xd_[i] != log##bits##_div(xa_[i], xb_[i])) { \
+                if (errs++ < 5) \
+                    printf("  FAIL: log%d_mul/div_array [%s] element %d\n", \
+                           bits, isa_name((enum intfp_isa)isa), i); \
+                break; \
+            } \
+        } \
+    } \
+    intfp_isa_set(max_isa_); \
+} while (0)
+
+// Test: Saturating log-domain arithmetic
+int test_log_saturation(bool verbose) {
+    tests_run++;
+    int passed = true;
+    int errs = 0;
+
+    if (verbose) {
+        printf("\n=== Testing Saturating Log Arithmetic ===\n");
+    }
+
+    TEST_LOG_ARITH_BITS(8);
+    TEST_LOG_ARITH_BITS(16);
+    TEST_LOG_ARITH_BITS(32);
+    TEST_LOG_ARITH_BITS(64);
+
+    // A plain sum turns zero into a huge value; _mul keeps it zero
+    s32 l0 = intfp_log_0(32), x = u64_to_log32fpmax(1000);
+    if (log32fpmax_to_u64(log32_mul(l0, x)) != 0 ||
+        log32fpmax_to_u64(log32_mul(x, x)) != log32fpmax_to_u64(x + x)) {
+        printf("  FAIL: zero propagation through log32_mul\n");
+        errs++;
+    }
+
+    // Mixed widths: log16 (10 fractional bits) by log32 (25 fractional bits)
+    for (int i = 0; i < 10000; i++) {
+        u64 u = test_rand64() >> 40, v = test_rand64() >> 50;
+        s32 a = u64_to_log32fp(u, 25);
+        s16 b = u64_to_log16fp(v, 10);
+        s32 bw = (b == intfp_log_0(16)) ? intfp_log_0(32) : (s32)b * (1 << 15);
+        s64 c = u64_to_log64fp(u, 7);  /* fewer fractional bits than a */
+        s64 aw = (a == intfp_log_0(32)) ? intfp_log_0(64) : (s64)a >> 18;
+        if (log32fp_mul_log16fp(a, b, 25, 10) != log32_mul(a, bw) ||
+            log32fp_div_log16fp(a, b, 25, 10) != log32_div(a, bw) ||
+            log16fp_div_log32fp(b, a, 10, 25) != log32_div(bw, a) ||
+            log64fp_mul_log32fp(c, a, 7, 25) != log64_mul(c, aw) ||
+            log64fp_div_log32fp(c, a, 7, 25) != log64_div(c, aw)) {
+            if (errs++ < 5)
+                printf("  FAIL: mixed width u=%llu v=%llu\n",
+                       (unsigned long long)u, (unsigned long long)v);
+        }
+    }
+    // Rescaling saturates instead of wrapping
+    if (log16fp_rescale(intfp_signed_max(16) / 2, 4, 6) != intfp_signed_max(16) ||
+        log16fp_rescale(-20000, 4, 6) != intfp_log_0(16) ||
+        log16fp_rescale(intfp_log_0(16), 4, 2) != intfp_log_0(16) ||
+        log16fp_rescale(-5, 2, 0) != -2) {
+        printf("  FAIL: log16fp_rescale saturation\n");
+        errs++;
+    }
+
+    if (errs) {
+        passed = false;
+    } else if (verbose) {
+        printf("  mul/div/pow saturate and keep zero at every width, mixed widths\n");
+        printf("  and _array kernels match the scalar functions\n");
+    }
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Saturating Log Arithmetic", passed);
+
+    return passed ? 1 : 0;
+}
+
+// Relative error of u64/u32 muldiv at one correction level, results >= 2^16
+#define TEST_MULDIV_LEVEL(level, bound) do { \
+    double max64_ = 0, max32_ = 0; \
+    for (int i = 0; i < 100000; i++) { \
+        u64 a = test_rand_bits(64), b = test_rand_bits(64), c = test_rand_bits(64); \
+        if (c == 0) continue; \
+        /* Exact quotient from a 128-bit product */ \
+        unsigned __int128 e = (unsigned __int128)a * b / c; \
+        if (e >= (1u << 16) && e <= UINT64_MAX) { \
+            double err = fabs((double)u64_muldiv_corr_n(a, b, c, level) - (double)e) / (double)e; \
+            if (err > max64_) max64_ = err; \
+        } \
+        u32 a3 = (u32)test_rand_bits(32), b3 = (u32)test_rand_bits(32), c3 = (u32)test_rand_bits(32); \
+        u64 e3 = c3 ? (u64)a3 * b3 / c3 : 0; \
+        if (e3 >= (1u << 16) && e3 <= UINT32_MAX) { \
+            double err = fabs((double)u32_muldiv_corr_n(a3, b3, c3, level) - (double)e3) / (double)e3; \
+            if (err > max32_) max32_ = err; \
+        } \
+    } \
+    if (max64_ > (bound) || max32_ > (bound)) { \
+        printf("  FAIL: level %d max error u64 %.3g, u32 %.3g (bound %g)\n", \
+               level, max64_, max32_, (double)(bound)); \
+        passed = false; \
+    } else if (verbose) { \
+        printf("  level %d: max error u64 %.3g%%, u32 %.3g%% (bound %g%%)\n", \
+               level, max64_ * 100, max32_ * 100, (double)(bound) * 100); \
+    } \
+} while (0)
+
+// Test: Approximate a * b / c
+int test_muldiv(bool verbose) {
+    tests_run++;
+    int passed = true;
+
+    if (verbose) {
+        printf("\n=== Testing Approximate muldiv ===\n");
+    }
+
+    TEST_MULDIV_LEVEL(0, 0.1255);
+    TEST_MULDIV_LEVEL(1, 0.018);
+    TEST_MULDIV_LEVEL(2, 0.0028);
+    TEST_MULDIV_LEVEL(3, 0.00005);
+
+    // Zero operands, division by zero, saturation, results below 1
+    if (u64_muldiv(0, 5, 3) != 0 || u64_muldiv(5, 0, 3) != 0 ||
+        u64_muldiv(5, 3, 0) != UINT64_MAX || u32_muldiv_corr(7, 9, 0) != UINT32_MAX ||
+        u64_muldiv_corr(UINT64_MAX, UINT64_MAX, 3) != UINT64_MAX ||
+        u32_muldiv(1u << 31, 1u << 31, 1u << 30) != UINT32_MAX ||
+        u64_muldiv_corr_n(3, 5, 1000, 3) != 0 ||
+        u16_muldiv_corr_n(1000, 60000, 1000, 3) < 59000 ||
+        u64_muldiv(1ULL << 40, 1ULL << 20, 1ULL << 30) != 1ULL << 30) {
+        printf("  FAIL: zero, division by zero, saturation or small results\n");
+        passed = false;
+    }
+
+    // The scheduler's delta * NICE_0_LOAD / weight
+    u64 delta = 3999871, w = 1991;
+    u64 exact = delta * 1024 / w, approx = u64_muldiv_corr_n(delta, 1024, w, 3);
+    if (fabs((double)approx - (double)exact) > exact * 0.00005) {
+        printf("  FAIL: %llu * 1024 / %llu = %llu, got %llu\n", (unsigned long long)delta,
+               (unsigned long long)w, (unsigned long long)exact, (unsigned long long)approx);
+        passed = false;
+    }
+
+    // The array form matches the scalar one on every instruction set
+    static u64 a64[1000], b64[1000], c64[1000], d64[1000];
+    static u32 a32[1000], b32[1000], c32[1000], d32[1000];
+    for (int i = 0; i < 1000; i++) {
+        a64[i] = test_rand_bits(64); b64[i] = test_rand_bits(64); c64[i] = test_rand_bits(64);
+        a32[i] = (u32)a64[i]; b32[i] = (u32)b64[i]; c32[i] = (u32)c64[i];
+    }
+    a64[0] = a32[0] = 0; c64[1] = c32[1] = 0;
+    enum intfp_isa max_isa = intfp_isa_get();
+    for (int isa = INTFP_ISA_SCALAR; isa <= (int)max_isa; isa++) {
+        intfp_isa_set((enum intfp_isa)isa);
+        int errs = 0;
+        for (u8 lv = 0; lv <= 3; lv++) {
+            u64_muldiv_corr_n_array(d64, a64, b64, c64, 1000, lv);
+            u32_muldiv_corr_n_array(d32, a32, b32, c32, 1000, lv);
+            for (int i = 0; i < 1000; i++) {
+                errs += d64[i] != u64_muldiv_corr_n(a64[i], b64[i], c64[i], lv);
+                errs += d32[i] != u32_muldiv_corr_n(a32[i], b32[i], c32[i], lv);
+            }
+        }
+        if (verbose || errs)
+            printf("  %-10s muldiv arrays: %d mismatches\n", isa_name(intfp_isa_get()), errs);
+        if (errs) passed = false;
+    }
+    intfp_isa_set(max_isa);
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Approximate muldiv", passed);
+
+    return passed ? 1 : 0;
+}
+
+// Checks one width of exact division: the reciprocal itself, then quotients
+#define TEST_DIV_BITS(bits, wide_t) do { \
+    int errs_ = 0; \
+    for (int i = 0; i < 200000; i++) { \
+        u##bits b = (u##bits)test_rand_bits(bits), a = (u##bits)test_rand_bits(bits); \
+        /* Powers of two and their neighbours, the extremes of m */ \
+        if (i < 3 * bits) b = ((u##bits)1 << (i / 3)) + (i % 3) - 1; \
+        if (b == 0) b = 1; \
+        struct u##bits##_recip r = u##bits##_recip_init(b); \
+        u##bits bn = b << __builtin_clzll((u64)b << (64 - bits)); \
+        wide_t m = ((wide_t)1 << (2 * bits - 1)) / bn; \
+        if (m > intfp_unsigned_max(bits)) m = intfp_unsigned_max(bits); \
+        errs_ += r.m != m; \
+        errs_ += u##bits##_div_recip(a, &r) != a / b; \
+        errs_ += u##bits##_div_recip(intfp_unsigned_max(bits), &r) != intfp_unsigned_max(bits) / b; \
+        errs_ += u##bits##_div_exact(a, b) != a / b; \
+    } \
+    if (verbose || errs_) \
+        printf("  u%d: %d mismatches against hardware division\n", bits, errs_); \
+    if (errs_) passed = false; \
+} while (0)
+
+// Test: Exact division through a 'log'-seeded reciprocal
+int test_div(bool verbose) {
+    tests_run++;
+    int passed = true;
+
+    if (verbose) {
+        printf("\n=== Testing Exact Division ===\n");
+    }
+
+    TEST_DIV_BITS(32, u64);
+    TEST_DIV_BITS(64, unsigned __int128);
+
+    // Division by zero saturates, zero divides to zero
+    struct u64_recip z = u64_recip_init(0);
+    if (u64_div_recip(5, &z) != UINT64_MAX || u32_div_exact(0, 0) != UINT32_MAX ||
+        u64_div_exact(0, 7) != 0 || u32_div_exact(UINT32_MAX, 1) != UINT32_MAX ||
+        u64_div_exact(UINT64_MAX, UINT64_MAX) != 1) {
+        printf("  FAIL: division by zero, by one or of zero\n");
+        passed = false;
+    }
+
+    // A column divided by one weight
+    u64 col[100], q[100];
+    struct u64_recip w = u64_recip_init(1991);
+    for (int i = 0; i < 100; i++)
+        col[i] = test_rand_bits(64);
+    u64_div_recip_array(q, col, 100, &w);
+    for (int i = 0; i < 100; i++) {
+        if (q[i] != col[i] / 1991) {
+            printf("  FAIL: array quotient %d\n", i);
+            passed = false;
+            break;
+        }
+    }
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Exact Division", passed);
+
+    return passed ? 1 : 0;
+}
+
+// Bit-by-bit reference roots
+static u64 ref_isqrt(u64 v) {
+    u64 r = 0, b = 1ULL << 62;
+    while (b > v) b >>= 2;
+    for (; b; b >>= 2) {
+        if (v >= r + b) { v -= r + b; r = (r >> 1) + b; }
+        else r >>= 1;
+    }
+    return r;
+}
+
+static u64 ref_icbrt(u64 v) {
+    u64 y = 0;
+    for (int s = 63; s >= 0; s -= 3) {
+        y <<= 1;
+        u64 b = 3 * y * (y + 1) + 1;
+        if ((v >> s) >= b) { v -= b << s; y++; }
+    }
+    return y;
+}
+
+// Test: Exact and approximate integer roots
+int test_root(bool verbose) {
+    tests_run++;
+    int passed = true;
+    int errs = 0;
+    double max_sqrt = 0, max_cbrt = 0;
+
+    if (verbose) {
+        printf("\n=== Testing Integer Roots ===\n");
+    }
+
+    for (int i = 0; i < 200000; i++) {
+        u64 v = test_rand_bits(64);
+        // Perfect squares and cubes and their neighbours
+        if (i % 4 == 1) { u64 k = test_rand_bits(32); v = k * k - (i % 3) + 1; }
+        if (i % 4 == 2) { u64 k = test_rand_bits(21) % 2642246; v = k * k * k - (i % 3) + 1; }
+        u32 w = (u32)v;
+        errs += u64_isqrt(v) != ref_isqrt(v) || u64_icbrt(v) != ref_icbrt(v);
+        errs += u32_isqrt(w) != ref_isqrt(w) || u32_icbrt(w) != ref_icbrt(w);
+        u64 rs = ref_isqrt(v), rc = ref_icbrt(v);
+        if (rs >= 256) {
+            double e = fabs((double)u64_isqrt_approx(v) - (double)rs) / (double)rs;
+            if (e > max_sqrt) max_sqrt = e;
+        }
+        if (rc >= 256) {
+            double e = fabs((double)u64_icbrt_approx(v) - (double)rc) / (double)rc;
+            if (e > max_cbrt) max_cbrt = e;
+        }
+    }
+    errs += u64_isqrt(UINT64_MAX) != 0xffffffff || u64_icbrt(UINT64_MAX) != 2642245;
+    errs += u32_isqrt(UINT32_MAX) != 0xffff || u32_icbrt(UINT32_MAX) != 1625;
+    errs += u64_isqrt(0) != 0 || u64_icbrt(0) != 0 || u64_isqrt_approx(0) != 0 ||
+            u32_icbrt_approx(0) != 0 || u32_isqrt(1) != 1 || u64_icbrt(7) != 1;
+    if (errs) {
+        printf("  FAIL: %d exact roots differ from the bit-by-bit reference\n", errs);
+        passed = false;
+    }
+    if (max_sqrt > 0.012 || max_cbrt > 0.012) {
+        printf("  FAIL: approximate roots off by %.3g%% (sqrt), %.3g%% (cbrt)\n",
+               max_sqrt * 100, max_cbrt * 100);
+        passed = false;
+    }
+    if (verbose)
+        printf("  %d exact mismatches; approximate max error sqrt %.3g%%, cbrt %.3g%%\n",
+               errs, max_sqrt * 100, max_cbrt * 100);
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Integer Roots", passed);
+
+    return passed ? 1 : 0;
+}
+
+// Largest relative error of one fixed-point power function against libm
+#define TEST_POW_ERR(call, ref, min_ref) do { \
+    double max_ = 0; \
+    for (int i = 0; i < 20000; i++) { \
+        u32 v = (u32)test_rand_bits(32); \
+        double r_ = (ref); \
+        if (v == 0 || r_ < (min_ref) || r_ >= 4294967295.0) continue; \
+        double e_ = fabs((double)(call) - r_) / r_; \
+        if (e_ > max_) max_ = e_; \
+    } \
+    if (max_ > bound) { \
+        printf("  FAIL: %s max error %.3g%% (bound %.3g%%)\n", #call, max_ * 100, bound * 100); \
+        passed = false; \
+    } else if (verbose) { \
+        printf("  %-36s max error %.3g%%\n", #call, max_ * 100); \
+    } \
+} while (0)
+
+// Test: Fractional powers, roots and reciprocals in the 'log' domain
+int test_pow(bool verbose) {
+    tests_run++;
+    int passed = true;
+    int errs = 0;
+
+    if (verbose) {
+        printf("\n=== Testing Fractional Powers ===\n");
+    }
+
+    // 'log' level: rounded products, against exact arithmetic
+    for (int i = 0; i < 100000; i++) {
+        s32 a = (s32)test_rand64() >> (test_rand64() % 32);
+        s32 e = (s32)test_rand64() >> (test_rand64() % 32);
+        u8 q = (u8)(test_rand64() % 31);
+        if (a == intfp_log_0(32)) continue;
+        s64 p = (s64)((((__int128)a * e) + ((__int128)1 << q >> 1)) >> q);
+        s32 want = p > INT32_MAX ? INT32_MAX : p <= INT32_MIN ? intfp_log_0(32) : (s32)p;
+        errs += log32_pow_q(a, e, q) != want;
+        s64 a64 = (s64)test_rand64() >> (test_rand64() % 64);
+        __int128 p64 = (((__int128)a64 * e) + ((__int128)1 << q >> 1)) >> q;
+        s64 want64 = p64 > INT64_MAX ? INT64_MAX : p64 <= INT64_MIN ? intfp_log_0(64) : (s64)p64;
+        errs += a64 != intfp_log_0(64) && log64_pow_q(a64, e, q) != want64;
+    }
+    // Zero, 0^0, 0^-x, identity, roots and reciprocals
+    errs += log32_pow_q(intfp_log_0(32), 1 << 15, 16) != intfp_log_0(32);
+    errs += log32_pow_q(intfp_log_0(32), 0, 16) != 0;
+    errs += log16_pow_q(intfp_log_0(16), -1, 0) != INT16_MAX;
+    errs += log64_pow_q(INT64_MAX / 2, 1 << 16, 16) != INT64_MAX / 2;
+    errs += log32_root(100, 3) != 33 || log32_root(-100, 3) != -33 || log32_root(101, 2) != 51;
+    errs += log8_root(intfp_log_0(8), 2) != intfp_log_0(8);
+    errs += log32_recip(intfp_log_0(32)) != INT32_MAX || log32_recip(-7) != 7;
+    errs += log16_rsqrt(-100) != 50 || log64_rsqrt(intfp_log_0(64)) != INT64_MAX;
+    if (errs) {
+        printf("  FAIL: %d 'log' power results differ from exact arithmetic\n", errs);
+        passed = false;
+    }
+
+    // Value level against libm, at level 3 and level 1 (results >= 2^20, so
+    // that the truncation to an integer stays below 0.0001%)
+    double bound = 0.0001;
+    TEST_POW_ERR(u32fp_pow_q(v, 16, 29789, 16, 3), pow(v / 65536.0, 29789 / 65536.0) * 65536, 1 << 20);
+    TEST_POW_ERR(u32fp_pow_q(v, 16, 144179, 16, 3), pow(v / 65536.0, 144179 / 65536.0) * 65536, 1 << 20);
+    TEST_POW_ERR(u64fp_pow_q(v, 0, 3 << 14, 16, 3), pow(v, 0.75), 1 << 20);
+    TEST_POW_ERR(u64fp_root(v, 32, 5, 3), pow(v / 4294967296.0, 0.2) * 4294967296.0, 1 << 20);
+    TEST_POW_ERR(u64fp_recip(v, 0, 60, 3), 1152921504606846976.0 / v, 1 << 20);
+    TEST_POW_ERR(u64fp_rsqrt(v, 0, 40, 3), 1099511627776.0 / sqrt(v), 1 << 20);
+    bound = 0.008;
+    TEST_POW_ERR(u32fp_pow_q(v, 16, 29789, 16, 1), pow(v / 65536.0, 29789 / 65536.0) * 65536, 1 << 20);
+    // u16 through log16 (11 fractional bits)
+    bound = 0.001;
+    TEST_POW_ERR(u16fp_pow_q((u16)v, 12, 29789, 16, 3), pow((u16)v / 4096.0, 29789 / 65536.0) * 4096, 1 << 12);
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Fractional Powers", passed);
+
+    return passed ? 1 : 0;
+}
+
+// Test: Power-law tables for full-scale u8/u16 samples
+int test_pow_lut(bool verbose) {
+    tests_run++;
+    int passed = true;
+    static struct u8_pow_lut l8;
+    static struct u16_pow_lut l16;
+    static u8 a8[5001], d8[5001];
+    static u16 a16[5001], d16[5001];
+    const s32 exps[] = { 29789, 144179, 39322, 3 << 16 };  /* 1/2.2, 2.2, 0.6, 3 in Q16 */
+
+    if (verbose) {
+        printf("\n=== Testing Power-Law Tables ===\n");
+    }
+
+    for (int i = 0; i < 5001; i++) {
+        a8[i] = (u8)test_rand64();
+        a16[i] = (u16)test_rand64();
+    }
+    for (size_t k = 0; k < sizeof(exps) / sizeof(exps[0]); k++) {
+        double e = exps[k] / 65536.0;
+        int err8 = 0, err16 = 0;
+
+        // Every entry against libm: within 1 LSB for u8 and 3 LSB for u16
+        u8_pow_lut_init(&l8, exps[k], 16);
+        u16_pow_lut_init(&l16, exps[k], 16);
+        for (int v = 0; v < 256; v++) {
+            int d = abs((int)l8.t[v] - (int)lround(pow(v / 255.0, e) * 255));
+            err8 = d > err8 ? d : err8;
+        }
+        for (int v = 0; v < 65536; v++) {
+            int d = abs((int)l16.t[v] - (int)lround(pow(v / 65535.0, e) * 65535));
+            err16 = d > err16 ? d : err16;
+        }
+        if (verbose)
+            printf("  e = %.4f: max error %d LSB (u8), %d LSB (u16)\n", e, err8, err16);
+        if (err8 > 1 || err16 > 3 || l8.t[0] || l8.t[255] != 255 || l16.t[0] || l16.t[65535] != 65535) {
+            printf("  FAIL: e = %.4f: error %d LSB (u8), %d LSB (u16), ends %u..%u, %u..%u\n", e,
+                   err8, err16, l8.t[0], l8.t[255], l16.t[0], l16.t[65535]);
+            passed = false;
+        }
+
+        // The array form matches the table on every instruction set, in place too
+        enum intfp_isa max_isa = intfp_isa_get();
+        for (int isa = INTFP_ISA_SCALAR; isa <= (int)max_isa; isa++) {
+            intfp_isa_set((enum intfp_isa)isa);
+            int errs = 0;
+            u8_pow_lut_array(d8, a8, 5001, &l8);
+            u16_pow_lut_array(d16, a16, 5001, &l16);
+            for (int i = 0; i < 5001; i++)
+                errs += d8[i] != l8.t[a8[i]] || d16[i] != l16.t[a16[i]];
+            memcpy(d16, a16, sizeof(d16));
+            d16[0] = 65535;
+            u16_pow_lut_array(d16, d16, 5001, &l16);
+            errs += d16[0] != 65535;
+            for (int i = 1; i < 5001; i++)
+                errs += d16[i] != l16.t[a16[i]];
+            if (verbose || errs)
+                printf("  %-10s pow_lut arrays: %d mismatches\n", isa_name(intfp_isa_get()), errs);
+            if (errs) passed = false;
+        }
+        intfp_isa_set(max_isa);
+    }
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Power-Law Tables", passed);
+
+    return passed ? 1 : 0;
+}
+
+// Checks every code of one 8-bit decode table, then the array form on every ISA
+#define TEST_LUT8_DECODE(hbits, what, init, scalar, array, dst_t, src_t) do { \
+    static struct u##hbits##_lut8 lut_; \
+    static dst_t d_[1001]; \
+    init; \
+    for (int v = 0; v < 256; v++) { \
+        src_t c = (src_t)v; \
+        errs += (dst_t)lut_.t[v] != (scalar); \
+    } \
+    enum intfp_isa max_isa_ = intfp_isa_get(); \
+    for (int isa = INTFP_ISA_SCALAR; isa <= (int)max_isa_; isa++) { \
+        intfp_isa_set((enum intfp_isa)isa); \
+        array(d_, (const src_t *)codes, 1001, &lut_); \
+        int e_ = 0; \
+        for (int i = 0; i < 1001; i++) { \
+            src_t c = (src_t)codes[i]; \
+            e_ += d_[i] != (scalar); \
+        } \
+        if (verbose || e_) \
+            printf("  %-10s %-5s -> %-3s: %d mismatches\n", isa_name(intfp_isa_get()), what, \
+                   #hbits, e_); \
+        errs += e_; \
+    } \
+    intfp_isa_set(max_isa_); \
+} while (0)
+
+// Test: Table-driven decoding of the 8-bit formats
+int test_lut8(bool verbose) {
+    tests_run++;
+    int errs = 0;
+    static u8 codes[1001];
+
+    if (verbose) {
+        printf("\n=== Testing 8-bit Table Decoding ===\n");
+    }
+
+    for (int i = 0; i < 1001; i++)
+        codes[i] = (u8)test_rand64();
+    codes[0] = 0; codes[1] = 0x80; codes[2] = 0xff; codes[3] = 1;
+
+    TEST_LUT8_DECODE(8, "pul8", pul8fp_to_u8_lut8_init(&lut_, 5),
+                     pul8fp_to_u8(c, 5), pul8fp_to_u8_lut8_array, u8, u8);
+    TEST_LUT8_DECODE(16, "pul8", pul8fp_to_u16_lut8_init(&lut_, 4),
+                     pul8fp_to_u16(c, 4), pul8fp_to_u16_lut8_array, u16, u8);
+    TEST_LUT8_DECODE(32, "pul8", pul8fp_to_u32_lut8_init(&lut_, 3),
+                     pul8fp_to_u32(c, 3), pul8fp_to_u32_lut8_array, u32, u8);
+    TEST_LUT8_DECODE(64, "pul8", pul8fp_to_u64_lut8_init(&lut_, INTFP_PUL_FPMAX(64, 8)),
+                     pul8fp_to_u64(c, INTFP_PUL_FPMAX(64, 8)), pul8fp_to_u64_lut8_array, u64, u8);
+    TEST_LUT8_DECODE(8, "log8", log8fp_to_u8fp_lut8_init(&lut_, 4, 2),
+                     log8fp_to_u8fp(c, 4, 2), log8fp_to_u8fp_lut8_array, u8, s8);
+    TEST_LUT8_DECODE(16, "log8", log8fp_to_u16fp_lut8_init(&lut_, 3, 4),
+                     log8fp_to_u16fp(c, 3, 4), log8fp_to_u16fp_lut8_array, u16, s8);
+    TEST_LUT8_DECODE(32, "log8", log8fp_to_u32fp_corr_n_lut8_init(&lut_, 2, 16, 3),
+                     log8fp_to_u32fp_corr_n(c, 2, 16, 3), log8fp_to_u32fp_lut8_array, u32, s8);
+    TEST_LUT8_DECODE(64, "log8", log8fp_to_u64fp_corr_n_lut8_init(&lut_, 1, 8, 1),
+                     log8fp_to_u64fp_corr_n(c, 1, 8, 1), log8fp_to_u64fp_lut8_array, u64, s8);
+    TEST_LUT8_DECODE(16, "slog8", slog8fp_to_s16fp_lut8_init(&lut_, 3, 2),
+                     slog8fp_to_s16fp(c, 3, 2), slog8fp_to_s16fp_lut8_array, s16, s8);
+    TEST_LUT8_DECODE(64, "slog8", slog8fp_to_s64fp_lut8_init(&lut_, 2, 20),
+                     slog8fp_to_s64fp(c, 2, 20), slog8fp_to_s64fp_lut8_array, s64, s8);
+
+    // Every fp of the pul8 -> u64 tables
+    for (u8 fp = 1; fp <= INTFP_PUL_FPMAX(64, 8); fp++) {
+        static struct u64_lut8 lut;
+        pul8fp_to_u64_lut8_init(&lut, fp);
+        for (int v = 0; v < 256; v++)
+            errs += lut.t[v] != pul8fp_to_u64((u8)v, fp);
+    }
+
+    if (errs) printf("  FAIL: %d table decodes differ from the scalar decoders\n", errs);
+    if (!errs) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("8-bit Table Decoding", !errs);
+
+    return errs ? 0 : 1;
+}
+
+// Checks one '_array_mt' conversion against its '_array' form on every pool
+#define TEST_MT_CONV(what, array, dst_t, src, ...) do { \
+    array((dst_t *)ref, src, TEST_MT_N, __VA_ARGS__); \
+    for (int p_ = 0; p_ < 4; p_++) { \
+        memset(out, 0xa5, TEST_MT_N * sizeof(dst_t)); \
+        array##_mt(pools[p_], (dst_t *)out, src, TEST_MT_N, __VA_ARGS__); \
+        int e_ = memcmp(out, ref, TEST_MT_N * sizeof(dst_t)) != 0; \
+        if (verbose || e_) \
+            printf("  %-36s %u thread(s): %s\n", what, \
+                   pools[p_] ? pools[p_]->nthreads : 1, e_ ? "MISMATCH" : "ok"); \
+        errs += e_; \
+    } \
+} while (0)
+
+static void test_mt_count(void *ctx, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+        __atomic_fetch_add(&((u32 *)ctx)[i], 1, __ATOMIC_RELAXED);
+}
+
+// Test: Multithreaded batch conversion
+#define TEST_MT_N 300007  /* Not a multiple of any block size */
+int test_mt(bool verbose) {
+    tests_run++;
+    int errs = 0;
+    u64 *in = malloc(TEST_MT_N * sizeof(u64));
+    u64 *enc = malloc(TEST_MT_N * sizeof(u64));
+    u64 *ref = malloc(TEST_MT_N * sizeof(u64));
+    u64 *out = malloc(TEST_MT_N * sizeof(u64));
+    struct intfp_pool *pools[4] = {
+        NULL, intfp_pool_create(1, 0), intfp_pool_create(4, 0),
+        intfp_pool_create(7, INTFP_POOL_PIN)
+    };
+
+    if (verbose) {
+        printf("\n=== Testing Multithreaded Batch Conversion ===\n");
+    }
+    if (!in || !enc || !ref || !out || !pools[1] || !pools[2] || !pools[3]) {
+        printf("  FAIL: out of memory\n");
+        errs++;
+        goto done;
+    }
+
+    for (size_t i = 0; i < TEST_MT_N; i++)
+        in[i] = test_rand_bits(64);
+
+    // Every family, on a narrow and a wide pair
+    TEST_MT_CONV("u64_to_pul16fp_array", u64_to_pul16fp_array, u16, in, 10);
+    memcpy(enc, ref, TEST_MT_N * sizeof(u16));
+    TEST_MT_CONV("pul16fp_to_u64_array", pul16fp_to_u64_array, u64, (const u16 *)enc, 10);
+    TEST_MT_CONV("u8_to_pul8fp_array", u8_to_pul8fp_array, u8, (const u8 *)in, 4);
+    TEST_MT_CONV("u32fp_to_log16fp_array", u32fp_to_log16fp_array, s16,
+                 (const u32 *)in, 8, 11);
+    memcpy(enc, ref, TEST_MT_N * sizeof(s16));
+    TEST_MT_CONV("log16fp_to_u32fp_array", log16fp_to_u32fp_array, u32,
+                 (const s16 *)enc, 11, 8);
+    TEST_MT_CONV("u64fp_to_log32fp_corr_n_array", u64fp_to_log32fp_corr_n_array, s32,
+                 in, 0, 26, 3);
+    memcpy(enc, ref, TEST_MT_N * sizeof(s32));
+    TEST_MT_CONV("log32fp_to_u64fp_corr_n_array", log32fp_to_u64fp_corr_n_array, u64,
+                 (const s32 *)enc, 26, 0, 3);
+    TEST_MT_CONV("u64fp_to_log64fp_array", u64fp_to_log64fp_array, s64, in, 0, 57);
+
+    // The pool calls every index once, and nothing for n = 0
+    for (int p = 0; p < 4; p++) {
+        static u32 count[10007];
+        memset(count, 0, sizeof(count));
+        intfp_pool_run(pools[p], 10007, 1, test_mt_count, count);
+        intfp_pool_run(pools[p], 10007, 333, test_mt_count, count);
+        intfp_pool_run(pools[p], 0, 64, test_mt_count, count);
+        int e = 0;
+        for (int i = 0; i < 10007; i++)
+            e += count[i] != 2;
+        if (e) printf("  FAIL: %d indices not run exactly once per call\n", e);
+        errs += e;
+    }
+
+    // First-touch allocation comes back zeroed; overflow is refused
+    {
+        u32 *buf = intfp_pool_alloc(pools[3], TEST_MT_N, sizeof(u32));
+        int e = !buf;
+        for (size_t i = 0; buf && i < TEST_MT_N; i++)
+            e += buf[i] != 0;
+        free(buf);
+        e += intfp_pool_alloc(pools[2], (size_t)-1 / 2, 4) != NULL;
+        if (e) printf("  FAIL: intfp_pool_alloc\n");
+        errs += e;
+    }
+
+done:
+    for (int p = 0; p < 4; p++)
+        intfp_pool_destroy(pools[p]);
+    free(in);
+    free(enc);
+    free(ref);
+    free(out);
+
+    if (errs) printf("  FAIL: %d multithreaded checks failed\n", errs);
+    if (!errs) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Multithreaded Batch Conversion", !errs);
+
+    return errs ? 0 : 1;
+}
+
+// Test: Memory-mappable columnar container
+int test_col(bool verbose) {
+    tests_run++;
+    int errs = 0;
+    enum { N = 70000 };  /* Two chunks of 2^15 and a short one */
+    static u64 in[N], enc[N], out[N], ref[N];
+    static u64 buf[(N * 4 + 4096) / 8];  /* 8-byte aligned, like a mapping */
+    struct intfp_col col;
+
+    if (verbose) {
+        printf("\n=== Testing Columnar Container ===\n");
+    }
+
+    for (int i = 0; i < N; i++)
+        in[i] = test_rand_bits(64);
+
+    // u64 -> pul16 and u64 -> log32 (level 3) round trips, in two pieces
+    static const struct { u8 kind, hbits, lbits, fp, level; } fmts[] = {
+        { INTFP_COL_PUL, 64, 16, INTFP_PUL_FPMAX(64, 16), 0 },
+        { INTFP_COL_LOG, 64, 32, 25, 3 },
+        { INTFP_COL_LOG, 32, 16, 9, 1 },
+        { INTFP_COL_PUL, 8, 8, 4, 0 },
+    };
+    for (size_t f = 0; f < sizeof(fmts) / sizeof(fmts[0]); f++) {
+        u64 size = intfp_col_size(fmts[f].lbits, N, 15);
+        int st = intfp_col_create(&col, buf, size, fmts[f].kind, fmts[f].hbits,
+                                  fmts[f].lbits, fmts[f].fp, fmts[f].level, N, 15);
+        if (st != INTFP_COL_OK || size > sizeof(buf)) {
+            printf("  FAIL: create %u/%u returned %d\n", fmts[f].hbits, fmts[f].lbits, st);
+            errs++;
+            continue;
+        }
+        u64 half = 40000 * (fmts[f].hbits / 8);
+        errs += intfp_col_encode(&col, 0, in, 40000) != 40000;
+        errs += intfp_col_encode(&col, 40000, (const u8 *)in + half, N) != N - 40000;
+
+        // Reopen read-only, as a reader of the file would
+        struct intfp_col rd;
+        errs += intfp_col_open(&rd, buf, size) != INTFP_COL_OK;
+        errs += intfp_col_decode(&rd, out, 0, N + 5) != N;
+        int e = 0;
+        switch (fmts[f].hbits * 100 + fmts[f].lbits) {
+            case 6416:
+                u64_to_pul16fp_array((u16 *)enc, in, N, fmts[f].fp);
+                pul16fp_to_u64_array(ref, (const u16 *)enc, N, fmts[f].fp);
+                break;
+            case 6432:
+                u64fp_to_log32fp_corr_n_array((s32 *)enc, in, N, 0, 25, 3);
+                log32fp_to_u64fp_corr_n_array(ref, (const s32 *)enc, N, 25, 0, 3);
+                break;
+            case 3216:
+                u32fp_to_log16fp_corr_n_array((s16 *)enc, (const u32 *)in, N, 0, 9, 1);
+                log16fp_to_u32fp_corr_n_array((u32 *)ref, (const s16 *)enc, N, 9, 0, 1);
+                break;
+            case 808:
+                u8_to_pul8fp_array((u8 *)enc, (const u8 *)in, N, 4);
+                pul8fp_to_u8_array((u8 *)ref, (const u8 *)enc, N, 4);
+                break;
+        }
+        e += memcmp(out, ref, (size_t)N * (fmts[f].hbits / 8)) != 0;
+
+        // Random access, including across chunk boundaries
+        for (int k = 0; k < 1000; k++) {
+            u64 i = (k < 6) ? (u64[]){ 0, 32767, 32768, 65535, 65536, N - 1 }[k]
+                            : test_rand64() % N;
+            u64 want = fmts[f].hbits == 64 ? ref[i] : fmts[f].hbits == 32 ?
+                       ((const u32 *)ref)[i] : ((const u8 *)ref)[i];
+            e += intfp_col_get(&rd, i) != want;
+            e += (const u8 *)intfp_col_at(&rd, i) - (const u8 *)buf !=
+                 (ptrdiff_t)(rd.chunks[i >> 15] + (i & 32767) * (fmts[f].lbits / 8));
+        }
+        errs += intfp_col_decode(&rd, out, 32760, 20) != 20;
+        e += memcmp(out, (const u8 *)ref + 32760 * (fmts[f].hbits / 8),
+                    20 * (fmts[f].hbits / 8)) != 0;
+        errs += intfp_col_decode(&rd, out, N, 1) != 0;
+        if (verbose || e)
+            printf("  u%-2u -> %s%-2u: %d mismatches, %llu bytes\n", fmts[f].hbits,
+                   fmts[f].kind == INTFP_COL_PUL ? "pul" : "log", fmts[f].lbits, e,
+                   (unsigned long long)size);
+        errs += e;
+    }
+
+    // Damaged or foreign containers are refused
+    {
+        u64 size = intfp_col_size(16, N, 15);
+        struct intfp_col_header *h = (struct intfp_col_header *)buf;
+        u64 *table = (u64 *)(h + 1);
+        struct { const char *what; int want; } cases[] = {
+            { "truncated", INTFP_COL_ERANGE }, { "magic", INTFP_COL_EMAGIC },
+            { "byte order", INTFP_COL_EENDIAN }, { "version", INTFP_COL_EVERSION },
+            { "fp", INTFP_COL_EFORMAT }, { "widths", INTFP_COL_EFORMAT },
+            { "count", INTFP_COL_ERANGE }, { "offset", INTFP_COL_ERANGE },
+            { "alignment", INTFP_COL_ERANGE }, { "short", INTFP_COL_EMAGIC },
+            { "fp 0", INTFP_COL_EFORMAT }, { "hbits 1", INTFP_COL_EFORMAT },
+        };
+        for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+            u64 sz = size;
+            intfp_col_create(&col, buf, size, INTFP_COL_PUL, 64, 16, 10, 0, N, 15);
+            switch (c) {
+                case 0: sz = size - 1; break;
+                case 1: h->magic[0] = 'X'; break;
+                case 2: h->byte_order = __builtin_bswap32(h->byte_order); break;
+                case 3: h->version = 2; break;
+                case 4: h->fp = 11; break;
+                case 5: h->lbits = 24; break;
+                case 6: h->count = ~(u64)0; break;
+                case 7: table[1] = size; break;
+                case 8: table[1] += 8; break;
+                case 9: sz = 63; break;
+                case 10: h->fp = 0; break;
+                case 11: h->hbits = 1; break;
+            }
+            int st = intfp_col_open(&col, buf, sz);
+            if (verbose || st != cases[c].want)
+                printf("  %-10s -> %d (want %d)\n", cases[c].what, st, cases[c].want);
+            errs += st != cases[c].want;
+        }
+    }
+
+    if (errs) printf("  FAIL: %d container checks failed\n", errs);
+    if (!errs) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Columnar Container", !errs);
+
+    return errs ? 0 : 1;
+}
+
+// Test: Entropy-coded 'pul' blocks decode to the plain 'pul' round trip
+#define TEST_RANS_FMT(hbits, lbits, fp) do { \
+    static u##hbits src_[TEST_RANS_N], ref_[TEST_RANS_N], out_[TEST_RANS_N]; \
+    static u##lbits codes_[TEST_RANS_N]; \
+    for (size_t i = 0; i < TEST_RANS_N; i++) \
+        src_[i] = (u##hbits)in[i]; \
+    u##hbits##_to_pul##lbits##fp_array(codes_, src_, TEST_RANS_N, fp); \
+    pul##lbits##fp_to_u##hbits##_array(ref_, codes_, TEST_RANS_N, fp); \
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) { \
+        size_t n_ = sizes[s]; \
+        size_t size_ = u##hbits##_to_pul##lbits##fp_rans(blk, sizeof(blk), src_, n_, fp); \
+        int e_ = size_ == 0 || size_ > INTFP_RANS_BOUND(hbits, lbits, n_); \
+        for (int isa = INTFP_ISA_SCALAR; isa <= (int)max_isa; isa++) { \
+            intfp_isa_set((enum intfp_isa)isa); \
+            memset(out_, 0xa5, sizeof(out_)); \
+            e_ += pul##lbits##fp_rans_to_u##hbits(out_, n_, blk, sizeof(blk)) != n_; \
+            e_ += memcmp(out_, ref_, n_ * sizeof(u##hbits)) != 0; \
+        } \
+        intfp_isa_set(max_isa); \
+        if (verbose || e_) \
+            printf("  %-7s u%-2u -> pul%-2u fp %-2u n %-5zu: %6zu bytes (plain %6zu), %d errors\n", \
+                   what, hbits, lbits, fp, n_, size_, n_ * (lbits / 8), e_); \
+        errs += e_; \
+    } \
+} while (0)
+
+int test_rans(bool verbose) {
+    tests_run++;
+    int errs = 0;
+    enum { TEST_RANS_N = 20011 };
+    static const size_t sizes[] = { 0, 1, 7, 8, 1024, 1031, TEST_RANS_N };
+    static u64 in[TEST_RANS_N], out[TEST_RANS_N];
+    static u8 blk[INTFP_RANS_BOUND(64, 16, TEST_RANS_N)];
+    enum intfp_isa max_isa = intfp_isa_get();
+
+    if (verbose) {
+        printf("\n=== Testing Entropy-Coded Blocks ===\n");
+    }
+
+    // Every exponent, a skewed sensor-like signal, and one single symbol
+    for (int d = 0; d < 3; d++) {
+        const char *what = (const char *[]){ "uniform", "skewed", "const" }[d];
+        for (size_t i = 0; i < TEST_RANS_N; i++)
+            in[i] = d == 0 ? test_rand_bits(64) :
+                    d == 1 ? 3000 + (test_rand64() % 2048) * (1 + (i % 97 == 0) * 500) :
+                    200 + test_rand64() % 50;
+        TEST_RANS_FMT(64, 16, INTFP_PUL_FPMAX(64, 16));
+        TEST_RANS_FMT(64, 16, 6);
+        TEST_RANS_FMT(32, 16, 11);
+        TEST_RANS_FMT(16, 8, 4);
+        TEST_RANS_FMT( 8, 8, 1);
+
+        // Skewed data: the exponents take well under 6 bits, so pul16 shrinks
+        if (d == 1) {
+            size_t size = u64_to_pul16fp_rans(blk, sizeof(blk), in, TEST_RANS_N, 10);
+            if (verbose || size >= TEST_RANS_N * 2 * 7 / 8)
+                printf("  skewed pul16: %zu of %zu bytes\n", size, (size_t)TEST_RANS_N * 2);
+            errs += size >= TEST_RANS_N * 2 * 7 / 8;
+        }
+    }
+
+    // Refused encodes
+    errs += u64_to_pul16fp_rans(blk, INTFP_RANS_BOUND(64, 16, 100) - 1, in, 100, 10) != 0;
+    errs += u64_to_pul16fp_rans(blk, sizeof(blk), in, 100, 11) != 0;
+    errs += u64_to_pul16fp_rans(blk, sizeof(blk), in, 100, 0) != 0;
+
+    // Damaged or foreign blocks are refused
+    for (size_t i = 0; i < TEST_RANS_N; i++)
+        in[i] = test_rand_bits(40);
+    size_t size = u64_to_pul16fp_rans(blk, sizeof(blk), in, TEST_RANS_N, 10);
+    static const char *what[] = {
+        "truncated", "size", "version", "widths", "fp", "max_n", "freqs", "states", "words",
+        "fp 0",
+    };
+    for (int c = 0; c < 10; c++) {
+        static u8 bad[sizeof(blk)];
+        size_t sz = size, max_n = TEST_RANS_N;
+        memcpy(bad, blk, size);
+        switch (c) {
+            case 0: sz = size - 1; break;
+            case 1: bad[0] = (u8)(bad[0] - 2); break;
+            case 2: bad[8] = 2; break;
+            case 3: bad[9] = 32; break;
+            case 4: bad[10] = 11; break;
+            case 5: max_n = TEST_RANS_N - 1; break;
+            case 6: bad[12] ^= 1; break;
+            case 7: bad[12 + 64 + 5] ^= 0x10; break;
+            case 8: bad[size - 2] ^= 0x40; break;
+            case 9: bad[10] = 0; break;
+        }
+        int e = 0;
+        for (int isa = INTFP_ISA_SCALAR; isa <= (int)max_isa; isa++) {
+            intfp_isa_set((enum intfp_isa)isa);
+            e += pul16fp_rans_to_u64(out, max_n, bad, sz) != (size_t)-1;
+        }
+        intfp_isa_set(max_isa);
+        if (verbose || e)
+            printf("  %-9s: %s\n", what[c], e ? "FAIL (accepted)" : "refused");
+        errs += e;
+    }
+
+    if (errs) printf("  FAIL: %d entropy-coded block checks failed\n", errs);
+    if (!errs) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Entropy-Coded Blocks", !errs);
+
+    return errs ? 0 : 1;
+}
+
+// Test: Delta-of-delta time series of 'log32'/'pul16'/raw codes
+int test_ts(bool verbose) {
+    tests_run++;
+    int errs = 0;
+    enum { N = 50000 };
+    static u64 in[N], ref[N], out[N];
+    static u32 codes[N], got[N];
+    static u8 buf[INTFP_TS_BOUND(N) + 64 * INTFP_TS_HEADER_SIZE];
+    static struct intfp_ts_point pts[N / 100 + 8];
+    struct intfp_ts_writer w;
+
+    if (verbose) {
+        printf("\n=== Testing Time-Series Codec ===\n");
+    }
+
+    // A slowly varying series, written in uneven pieces and read back in ranges
+    for (size_t i = 0; i < N; i++)
+        in[i] = (u64)(1e9 * (2.0 + sin(i * 1e-3)) + i * 1000.0 + test_rand64() % 64);
+    static const u8 kinds[] = { INTFP_TS_LOG32, INTFP_TS_PUL16 };
+    for (size_t k = 0; k < 2; k++) {
+        int e = 0;
+        intfp_ts_writer_init(&w, buf, sizeof(buf), kinds[k], 1000);
+        for (size_t i = 0; i < N; ) {
+            size_t m = 1 + test_rand64() % 700;
+            if (m > N - i) m = N - i;
+            e += intfp_ts_append_u64(&w, in + i, m) != m;
+            i += m;
+            if (i % 7 == 0) intfp_ts_flush(&w);  /* Short blocks in between */
+        }
+        size_t size = intfp_ts_flush(&w);
+        if (kinds[k] == INTFP_TS_LOG32) {
+            u64_to_log32fpmax_corr_array((s32 *)codes, in, N);
+            log32fpmax_to_u64_corr_array(ref, (const s32 *)codes, N);
+        } else {
+            static u16 pul[N];
+            u64_to_pul16fpmax_array(pul, in, N);
+            pul16fpmax_to_u64_array(ref, pul, N);
+        }
+        size_t npts = intfp_ts_index(buf, size, pts, sizeof(pts) / sizeof(pts[0]));
+        e += npts < N / 1000 || npts > sizeof(pts) / sizeof(pts[0]) || pts[0].first != 0;
+        e += intfp_ts_scan_u64(out, buf, size, pts, npts, 0, N + 10, kinds[k]) != N;
+        e += memcmp(out, ref, sizeof(ref)) != 0;
+        for (int r = 0; r < 200; r++) {
+            u64 first = test_rand64() % N;
+            size_t n = 1 + test_rand64() % 3000, want = n < N - first ? n : N - first;
+            e += intfp_ts_scan_u64(out, buf, size, pts, npts, first, n, kinds[k]) != want;
+            e += memcmp(out, ref + first, want * sizeof(u64)) != 0;
+        }
+        // Blocks of the other kind are not converted
+        e += pts[0].kind != kinds[k];
+        e += intfp_ts_scan_u64(out, buf, size, pts, npts, 0, N, kinds[1 - k]) != 0;
+        buf[pts[1].offset + 17] = kinds[1 - k];
+        e += intfp_ts_scan_u64(out, buf, size, pts, npts, 0, N, kinds[k]) != pts[1].first;
+        buf[pts[1].offset + 17] = kinds[k];
+        if (verbose || e)
+            printf("  %s: %zu blocks, %.3f bytes per value, %d errors\n",
+                   kinds[k] == INTFP_TS_LOG32 ? "log32" : "pul16", npts, (double)size / N, e);
+        errs += e;
+        // A slow series needs far less than the 4 or 2 bytes of its codes
+        errs += size > N * (kinds[k] == INTFP_TS_LOG32 ? 3u : 1u);
+    }
+
+    // Raw codes of every width, with wrapping differences, are exact
+    {
+        int e = 0;
+        for (size_t i = 0; i < N; i++)
+            codes[i] = (u32)test_rand_bits(32) * (i % 3 == 0 ? 1 : (u32)-1);
+        intfp_ts_writer_init(&w, buf, sizeof(buf), INTFP_TS_RAW, 0);
+        e += intfp_ts_append(&w, codes, N) != N;
+        size_t size = intfp_ts_flush(&w);
+        size_t npts = intfp_ts_index(buf, size, pts, sizeof(pts) / sizeof(pts[0]));
+        e += npts != (N + INTFP_TS_BLOCK_LEN - 1) / INTFP_TS_BLOCK_LEN;
+        e += intfp_ts_scan(got, buf, size, pts, npts, 0, N) != N;
+        e += memcmp(got, codes, sizeof(codes)) != 0;
+        e += intfp_ts_scan_u64(out, buf, size, pts, npts, 0, N, INTFP_TS_RAW) != 0;
+        // Damage: a cut stream ends early, an unknown kind or a bad width is refused
+        e += intfp_ts_index(buf, size - 1, NULL, 0) != npts - 1;
+        buf[pts[2].offset + 17] = INTFP_TS_PUL16 + 1;
+        e += intfp_ts_index(buf, size, NULL, 0) != 2;
+        buf[pts[2].offset + 17] = INTFP_TS_RAW;
+        buf[pts[1].offset + INTFP_TS_HEADER_SIZE] = 33;
+        e += intfp_ts_block_decode(got, N, buf + pts[1].offset, size - pts[1].offset) !=
+             (size_t)-1;
+        e += intfp_ts_scan(got, buf, size, pts, npts, 0, N) != INTFP_TS_BLOCK_LEN;
+        // A block that claims more values than its groups hold, read from a buffer
+        // of exactly its size
+        intfp_ts_writer_init(&w, buf, sizeof(buf), INTFP_TS_RAW, 0);
+        intfp_ts_append(&w, codes, 40);
+        size_t size40 = intfp_ts_flush(&w);
+        buf[4] = 70;
+        u8 *exact = malloc(size40);
+        memcpy(exact, buf, size40);
+        struct intfp_ts_point pt70 = { 0, 0, 70, INTFP_TS_RAW };
+        e += intfp_ts_block_decode(got, N, exact, size40) != (size_t)-1;
+        e += intfp_ts_scan(got, exact, size40, &pt70, 1, 0, 70) != 0;
+        free(exact);
+        if (verbose || e)
+            printf("  raw: %zu blocks, %.3f bytes per value, %d errors\n",
+                   npts, (double)size / N, e);
+        errs += e;
+    }
+
+    // A full buffer stops the writer without losing what it accepted
+    {
+        int e = 0;
+        size_t cap = 3000, total = 0;
+        intfp_ts_writer_init(&w, buf, cap, INTFP_TS_RAW, 100);
+        total = intfp_ts_append(&w, codes, N);
+        size_t size = intfp_ts_flush(&w);
+        e += total == 0 || total == N || size > cap;
+        size_t npts = intfp_ts_index(buf, size, pts, sizeof(pts) / sizeof(pts[0]));
+        e += intfp_ts_scan(got, buf, size, pts, npts, 0, N) != total;
+        e += memcmp(got, codes, total * sizeof(u32)) != 0;
+        if (verbose || e)
+            printf("  full buffer: %zu of %d values in %zu bytes, %d errors\n",
+                   total, N, size, e);
+        errs += e;
+    }
+
+    if (errs) printf("  FAIL: %d time-series checks failed\n", errs);
+    if (!errs) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Time-Series Codec", !errs);
+
+    return errs ? 0 : 1;
+}
+
+// Test: Bit-packed arrays of 4- to 63-bit 'pul'/'log' codes
+int test_packed(bool verbose) {
+    tests_run++;
+    int errs = 0;
+    enum { N = 3001 };
+    static u64 words[INTFP_PACKED_WORDS(N, 63)], in[N], codes[N], out[N], ref[N];
+    static const u8 hbits[] = { 8, 16, 32, 64 };
+    struct intfp_packed a;
+    enum intfp_isa max_isa = intfp_isa_get();
+
+    if (verbose) {
+        printf("\n=== Testing Bit-Packed Arrays ===\n");
+    }
+
+    for (u8 w = INTFP_PACKED_MIN_WIDTH; w <= INTFP_PACKED_MAX_WIDTH; w++) {
+        int e = 0;
+        // Codes: bulk pack at an odd offset, then unpack, get and set
+        if (intfp_packed_init(&a, words, N, INTFP_PACKED_PUL, 8, w, INTFP_PACKED_FPMAX) != 0) {
+            printf("  FAIL: init of width %u\n", w);
+            errs++;
+            continue;
+        }
+        u64 mask = ((u64)1 << w) - 1;
+        memset(words, 0xa5, sizeof(words));
+        for (size_t i = 0; i < N; i++)
+            codes[i] = test_rand64();
+        for (int isa = INTFP_ISA_SCALAR; isa <= (int)max_isa; isa++) {
+            intfp_isa_set((enum intfp_isa)isa);
+            e += intfp_packed_pack(&a, 0, codes, N) != N;
+            e += intfp_packed_pack(&a, 37, codes + 37, 2000) != 2000;
+            for (size_t i = 0; i < N; i++)
+                e += intfp_packed_get_code(&a, i) != (codes[i] & mask);
+            for (u64 first = 0; first < 80; first += 13) {
+                memset(out, 0, sizeof(out));
+                e += intfp_packed_unpack(&a, out, first, N) != N - first;
+                for (size_t i = 0; i < N - first; i++)
+                    e += out[i] != (codes[first + i] & mask);
+            }
+        }
+        intfp_isa_set(max_isa);
+        intfp_packed_set_code(&a, 100, ~(u64)0);
+        e += intfp_packed_get_code(&a, 100) != mask;
+        e += intfp_packed_get_code(&a, 99) != (codes[99] & mask);
+        e += intfp_packed_get_code(&a, 101) != (codes[101] & mask);
+        e += intfp_packed_unpack(&a, out, N, 1) != 0;
+
+        // Values of every width, against the 64-bit formats
+        for (int kind = INTFP_PACKED_PUL; kind <= INTFP_PACKED_LOG; kind++) {
+            for (size_t h = 0; h < sizeof(hbits); h++) {
+                int fpmax = (kind == INTFP_PACKED_LOG ? w - 1 : w) - intfp_fls32(hbits[h] - 1);
+                int st = intfp_packed_init(&a, words, N, (u8)kind, hbits[h], w,
+                                           INTFP_PACKED_FPMAX);
+                if (fpmax < 1) {
+                    e += st != -1;
+                    continue;
+                }
+                int cap = kind == INTFP_PACKED_LOG ? 57 : 58;
+                e += st != 0 || a.fp != (fpmax < cap ? fpmax : cap);
+                for (size_t i = 0; i < N; i++) {
+                    in[i] = test_rand_bits(hbits[h]);
+                    if (kind == INTFP_PACKED_PUL)
+                        ref[i] = pul64fp_to_u64(u64_to_pul64fp(in[i], a.fp), a.fp);
+                    else
+                        ref[i] = log64fp_to_u64fp(u64fp_to_log64fp(in[i], 0, a.fp), a.fp, 0);
+                }
+                static u8 src[N * 8], dst[N * 8];
+                for (size_t i = 0; i < N; i++)
+                    memcpy(src + i * (hbits[h] / 8), &in[i], hbits[h] / 8);  /* Little-endian */
+                e += intfp_packed_encode(&a, 0, src, N) != N;
+                memset(dst, 0, sizeof(dst));
+                e += intfp_packed_decode(&a, dst, 0, N + 5) != N;
+                for (size_t i = 0; i < N; i++) {
+                    u64 v = 0;
+                    memcpy(&v, dst + i * (hbits[h] / 8), hbits[h] / 8);
+                    e += v != ref[i] || intfp_packed_get(&a, i) != ref[i];
+                }
+                intfp_packed_set(&a, 5, 0);
+                e += intfp_packed_get(&a, 5) != 0 || intfp_packed_get(&a, 6) != ref[6];
+            }
+        }
+        if (verbose || e)
+            printf("  width %2u: %d errors\n", w, e);
+        errs += e;
+    }
+
+    // A 12-bit 'pul' of u64 holds exactly the pul16 code with intfp_pul_fpmax(64, 12) bits
+    intfp_packed_init(&a, words, N, INTFP_PACKED_PUL, 64, 12, INTFP_PACKED_FPMAX);
+    errs += a.fp != intfp_pul_fpmax(64, 12);
+    for (size_t i = 0; i < N; i++)
+        in[i] = test_rand_bits(64);
+    intfp_packed_encode(&a, 0, in, N);
+    for (size_t i = 0; i < N; i++)
+        errs += intfp_packed_get_code(&a, i) != u64_to_pul16fp(in[i], a.fp);
+
+    // Formats that do not fit are refused
+    errs += intfp_packed_init(&a, words, N, INTFP_PACKED_PUL, 64, 64, INTFP_PACKED_FPMAX) != -1;
+    errs += intfp_packed_init(&a, words, N, INTFP_PACKED_PUL, 64, 12, 7) != -1;
+    errs += intfp_packed_init(&a, words, N, INTFP_PACKED_PUL, 64, 12, 0) != -1;
+    errs += intfp_packed_init(&a, words, N, INTFP_PACKED_LOG, 64, 12, 0) != -1;
+    errs += intfp_packed_init(&a, words, N, INTFP_PACKED_PUL, 24, 12, 4) != -1;
+    errs += intfp_packed_init(&a, words, N, 3, 64, 12, 4) != -1;
+
+    if (errs) printf("  FAIL: %d packed array checks failed\n", errs);
+    if (!errs) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Bit-Packed Arrays", !errs);
+
+    return errs ? 0 : 1;
+}
+
+// Checks u##h -> bfp##m -> u##h for one pair, every block size and ISA, against
+// the shift of each block's largest value; adds the failures to errs
+#define TEST_BFP_PAIR(h, m) do { \
+    static u##h in_[1000], out_[1000]; \
+    static u##m mans_[1000]; \
+    static u8 exps_[INTFP_BFP_EXPS(1000, 16)]; \
+    for (size_t i_ = 0; i_ < 1000; i_++) \
+        in_[i_] = i_ < 500 ? (u##h)test_rand_bits(h) : i_ % 97 == 0 ? 0 : \
+            (u##h)((u##h)(intfp_unsigned_max(h) / 3 + i_ * 17) >> (i_ / 100 % 4)); \
+    for (u8 block = INTFP_BFP_BLOCK_MIN; block <= INTFP_BFP_BLOCK_MAX; block *= 2) { \
+        for (int isa_ = INTFP_ISA_SCALAR; isa_ <= (int)max_isa; isa_++) { \
+            intfp_isa_set((enum intfp_isa)isa_); \
+            int e_ = 0; \
+            memset(mans_, 0, sizeof(mans_)); \
+            e_ += u##h##_to_bfp##m(exps_, mans_, in_, 1000, block) != 0; \
+            e_ += bfp##m##_to_u##h(out_, exps_, mans_, 1000, block) != 0; \
+            for (size_t b_ = 0; b_ < INTFP_BFP_EXPS(1000u, block); b_++) { \
+                u64 max_ = 0; \
+                for (size_t i_ = b_ * block; i_ < 1000 && i_ < (b_ + 1) * block; i_++) \
+                    max_ = in_[i_] > max_ ? in_[i_] : max_; \
+                unsigned bits_ = max_ ? 64 - __builtin_clzll(max_) : 0; \
+                u8 s_ = bits_ > m ? bits_ - m : 0; \
+                e_ += exps_[b_] != s_; \
+                for (size_t i_ = b_ * block; i_ < 1000 && i_ < (b_ + 1) * block; i_++) \
+                    e_ += mans_[i_] != in_[i_] >> s_ || out_[i_] != (u##h)(in_[i_] >> s_ << s_); \
+            } \
+            if (verbose || e_) \
+                printf("  u" #h " -> bfp" #m ", block %2u [%s]: %d errors\n", block, \
+                       isa_name(intfp_isa_get()), e_); \
+            errs += e_; \
+        } \
+        intfp_isa_set(max_isa); \
+    } \
+} while (0)
+
+// Test: Block floating point with a shared exponent per block
+int test_bfp(bool verbose) {
+    tests_run++;
+    int errs = 0;
+    enum { N = 4000 };
+    static u64 in[N], out[N];
+    static u16 in16[N], out16[N], pul[N], mans16[N];
+    static s32 lg[N];
+    static u8 mans[N], exps[INTFP_BFP_EXPS(N, 16)], exps2[INTFP_BFP_EXPS(N, 16)];
+    enum intfp_isa max_isa = intfp_isa_get();
+
+    if (verbose) {
+        printf("\n=== Testing Block Floating Point ===\n");
+    }
+
+    TEST_BFP_PAIR(16, 8);
+    TEST_BFP_PAIR(32, 8);
+    TEST_BFP_PAIR(64, 8);
+    TEST_BFP_PAIR(32, 16);
+    TEST_BFP_PAIR(64, 16);
+
+    // The values do not depend on the input width; too wide ones saturate
+    for (size_t i = 0; i < N; i++)
+        in16[i] = (u16)test_rand_bits(16);
+    u16_to_bfp8(exps, mans, in16, N, 32);
+    bfp8_to_u64(out, exps, mans, N, 32);
+    for (size_t i = 0; i < N; i++)
+        errs += out[i] != (u64)(u16)in16[i] >> exps[i / 32] << exps[i / 32];
+    in[0] = 1ull << 40;
+    in[1] = 255;
+    u64_to_bfp8(exps, mans, in, 2, 16);
+    bfp8_to_u16(out16, exps, mans, 2, 16);
+    errs += out16[0] != 0xffff || out16[1] != 0;
+
+    // A smooth series: errors against 'pul16', and the 'pul'/'log' conversions
+    double err8 = 0, err16 = 0, errp = 0;
+    for (size_t i = 0; i < N; i++)
+        in[i] = (u64)(1e9 * (2.0 + sin(i * 1e-3)) + test_rand64() % 64);
+    u64_to_bfp8(exps, mans, in, N, 32);
+    bfp8_to_u64(out, exps, mans, N, 32);
+    u64_to_pul16fpmax_array(pul, in, N);
+    for (size_t i = 0; i < N; i++) {
+        double e8 = (double)(in[i] - out[i]) / (double)in[i];
+        double ep = (double)(in[i] - pul16fpmax_to_u64(pul[i])) / (double)in[i];
+        err8 = e8 > err8 ? e8 : err8;
+        errp = ep > errp ? ep : errp;
+    }
+    u64_to_bfp16(exps, mans16, in, N, 32);
+    bfp16_to_u64(out, exps, mans16, N, 32);
+    for (size_t i = 0; i < N; i++) {
+        double e16 = (double)(in[i] - out[i]) / (double)in[i];
+        err16 = e16 > err16 ? e16 : err16;
+    }
+    if (verbose)
+        printf("  smooth series, max relative error: bfp8 %.6f, bfp16 %.8f, pul16 %.6f\n",
+               err8, err16, errp);
+    errs += err8 >= 1.0 / 64 || err16 >= 1.0 / 16384;
+
+    u64_to_bfp8(exps, mans, in, N, 32);
+    bfp8_to_u64(out, exps, mans, N, 32);
+    u64_to_pul16fp_array(pul, out, N, 10);
+    bfp8_to_pul16fp(out16, exps, mans, N, 32, 10);
+    errs += memcmp(out16, pul, sizeof(pul)) != 0;
+    pul16fp_to_u64_array(out, pul, N, 10);
+    u64_to_bfp8(exps, mans, out, N, 32);
+    static u8 mans2[N];
+    pul16fp_to_bfp8(exps2, mans2, pul, N, 32, 10);
+    errs += memcmp(exps, exps2, sizeof(exps)) != 0 || memcmp(mans, mans2, sizeof(mans)) != 0;
+
+    static s32 lg2[N];
+    bfp8_to_u64(out, exps, mans, N, 32);
+    u64fp_to_log32fp_array(lg2, out, N, 0, 26);
+    bfp8_to_log32fp(lg, exps, mans, N, 32, 26);
+    errs += memcmp(lg, lg2, sizeof(lg)) != 0;
+    log32fp_to_bfp16(exps2, mans16, lg, N, 32, 26);
+    log32fp_to_u64fp_array(out, lg, N, 26, 0);
+    static u16 mans16b[N];
+    u64_to_bfp16(exps, mans16b, out, N, 32);
+    errs += memcmp(exps, exps2, sizeof(exps)) != 0 || memcmp(mans16, mans16b, sizeof(mans16)) != 0;
+
+    // Other block sizes are refused before anything is written
+    static const u8 bad_blocks[] = { 0, 1, 8, 24, 48, 128 };
+    for (size_t b = 0; b < sizeof(bad_blocks); b++) {
+        u8 blk = bad_blocks[b];
+        memset(exps, 0xa5, sizeof(exps));
+        memset(mans, 0xa5, sizeof(mans));
+        memset(out, 0xa5, sizeof(out));
+        memset(out16, 0xa5, sizeof(out16));
+        memset(lg2, 0xa5, sizeof(lg2));
+        int e = u64_to_bfp8(exps, mans, in, N, blk) != -1;
+        e += bfp8_to_u64(out, exps, mans, N, blk) != -1;
+        e += bfp8_to_pul16fp(out16, exps, mans, N, blk, 10) != -1;
+        e += pul16fp_to_bfp8(exps, mans, pul, N, blk, 10) != -1;
+        e += bfp8_to_log32fp(lg2, exps, mans, N, blk, 26) != -1;
+        e += log32fp_to_bfp16(exps, mans16, lg, N, blk, 26) != -1;
+        e += exps[0] != 0xa5 || mans[0] != 0xa5 || out[0] != 0xa5a5a5a5a5a5a5a5ull ||
+             out16[0] != 0xa5a5 || lg2[0] != (s32)0xa5a5a5a5;
+        if (verbose || e)
+            printf("  block %3u: %d checks failed\n", blk, e);
+        errs += e;
+    }
+
+    if (errs) printf("  FAIL: %d block floating point checks failed\n", errs);
+    if (!errs) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Block Floating Point", !errs);
+
+    return errs ? 0 : 1;
+}
+
+// Checks exact round trips of u##h values through pul##l codes and residuals,
+// at fp 1 and fpmax; adds the failures to errs
+#define TEST_RES_PAIR(h, l) do { \
+    static u##h in_[1000], out_[1000], approx_[1000]; \
+    static u##l codes_[1000], ref_[1000]; \
+    static u8 res_[INTFP_RES_BOUND(h, 1000, 1)]; \
+    for (size_t i_ = 0; i_ < 1000; i_++) \
+        in_[i_] = i_ < 4 ? (u##h)(i_ == 3 ? intfp_unsigned_max(h) : i_) : (u##h)test_rand_bits(h); \
+    for (u8 fp_ = 1; fp_ <= INTFP_PUL_FPMAX(h, l); fp_ = fp_ == 1 && INTFP_PUL_FPMAX(h, l) > 1 ? \
+            INTFP_PUL_FPMAX(h, l) : INTFP_PUL_FPMAX(h, l) + 1) { \
+        int e_ = 0; \
+        size_t size_ = u##h##_to_pul##l##fp_res(codes_, res_, sizeof(res_), in_, 1000, fp_); \
+        u##h##_to_pul##l##fp_array(ref_, in_, 1000, fp_); \
+        e_ += memcmp(codes_, ref_, sizeof(ref_)) != 0; \
+        e_ += size_ != (pul##l##fp_res_bits(codes_, 1000, fp_) + 7) / 8; \
+        e_ += pul##l##fp_res_to_u##h(out_, codes_, 1000, res_, size_, 0, fp_) != 0; \
+        e_ += memcmp(out_, in_, sizeof(in_)) != 0; \
+        /* A range, from the residual offset of its first value */ \
+        memset(out_, 0, sizeof(out_)); \
+        e_ += pul##l##fp_res_to_u##h(out_, codes_ + 500, 300, res_, size_, \
+            pul##l##fp_res_bits(codes_, 500, fp_), fp_) != 0; \
+        e_ += memcmp(out_, in_ + 500, 300 * sizeof(u##h)) != 0; \
+        /* The approximation ignores the residuals */ \
+        pul##l##fp_to_u##h##_array(approx_, codes_, 1000, fp_); \
+        for (size_t i_ = 0; i_ < 1000; i_++) \
+            e_ += approx_[i_] != pul##l##fp_to_u##h(u##h##_to_pul##l##fp(in_[i_], fp_), fp_); \
+        /* Short streams and short buffers are refused */ \
+        if (size_) { \
+            e_ += pul##l##fp_res_to_u##h(out_, codes_, 1000, res_, size_ - 1, 0, fp_) != -1; \
+            e_ += u##h##_to_pul##l##fp_res(codes_, res_, size_ - 1, in_, 1000, fp_) != (size_t)-1; \
+        } \
+        if (verbose || e_) \
+            printf("  u" #h " <-> pul" #l " + residuals, fp %2u: %zu bytes, %d errors\n", \
+                   fp_, size_, e_); \
+        errs += e_; \
+    } \
+} while (0)
+
+// Test: Lossless 'pul' through a residual stream
+int test_res(bool verbose) {
+    tests_run++;
+    int errs = 0;
+
+    if (verbose) {
+        printf("\n=== Testing Lossless Residuals ===\n");
+    }
+
+    TEST_RES_PAIR(8, 8);
+    TEST_RES_PAIR(16, 8);
+    TEST_RES_PAIR(32, 8);
+    TEST_RES_PAIR(64, 8);
+    TEST_RES_PAIR(16, 16);
+    TEST_RES_PAIR(32, 16);
+    TEST_RES_PAIR(64, 16);
+    TEST_RES_PAIR(32, 32);
+    TEST_RES_PAIR(64, 32);
+    TEST_RES_PAIR(64, 64);
+
+    // Codes that no value encodes to are refused before their residual is read
+    u16 bad = (u16)(1 << 15);  /* Exponent 64 at fp 9: a 65-bit value */
+    u64 v;
+    u8 res[8] = { 0 };
+    errs += pul16fp_res_to_u64(&v, &bad, 1, res, sizeof(res), 0, 9) != -1;
+    bad = 0xffff;  /* Exponent 32767 at fp 1 */
+    errs += pul16fp_res_to_u64(&v, &bad, 1, res, sizeof(res), 0, 1) != -1;
+    bad = (u16)(2 << 10 | 1);  /* A 3-bit value with a mantissa bit below its lowest */
+    errs += pul16fp_res_to_u64(&v, &bad, 1, res, sizeof(res), 0, 10) != -1;
+    bad = intfp_pul_0(16);
+    errs += pul16fp_res_to_u64(&v, &bad, 1, res, sizeof(res), 0, 10) != 0 || v != 0;
+    errs += pul16fp_res_to_u64(&v, &bad, 1, res, sizeof(res), 0, 0) != -1;
+    errs += u64_to_pul16fp_res(&bad, res, sizeof(res), &v, 1, 0) != (size_t)-1;
+
+    if (errs) printf("  FAIL: %d residual checks failed\n", errs);
+    if (!errs) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Lossless Residuals", !errs);
+
+    return errs ? 0 : 1;
+}
+
+// Test: The header is usable from several translation units of one program
+int test_linkage(bool verbose) {
+    tests_run++;
+    int passed = true;
+    int errs = 0;
+
+    if (verbose) {
+        printf("\n=== Testing Multi-Unit Linkage ===\n");
+    }
+
+    // Both units compute the same results from the same (shared) tables
+    if (link_enc_corr_lut() != __intfp_enc_corr_lut) {
+        printf("  FAIL: correction table is not shared between units\n");
+        passed = false;
+    }
+    for (int i = 0; i < 1000; i++) {
+        u64 v = test_rand_bits(64);
+        s32 l = u64_to_log32fpmax_corr(v);
+        if (link_u64_to_log32fpmax_corr(v) != l ||
+            link_log32fpmax_to_u64_corr(l) != log32fpmax_to_u64_corr(l))
+            errs++;
+    }
+    if (errs) {
+        printf("  FAIL: %d results differ between units\n", errs);
+        passed = false;
+    }
+
+    // The batch instruction set level is program-wide
+    enum intfp_isa max_isa = intfp_isa_get();
+    intfp_isa_set(INTFP_ISA_SCALAR);
+    if (link_isa_get() != INTFP_ISA_SCALAR) {
+        printf("  FAIL: intfp_isa_set() did not apply to the other unit\n");
+        passed = false;
+    }
+    intfp_isa_set(max_isa);
+    if (link_isa_get() != max_isa) {
+        printf("  FAIL: other unit sees %s instead of %s\n",
+               isa_name(link_isa_get()), isa_name(max_isa));
+        passed = false;
+    }
+
+    if (verbose) {
+        printf("  Units agree on conversions, tables and ISA level (%s)\n",
+               isa_name(max_isa));
+    }
+
+    if (passed) tests_passed++;
+    else tests_failed++;
+
+    print_test_summary("Multi-Unit Linkage", passed);
+
+    return passed ? 1 : 0;
+}
+
 // Run all tests
 void run_all_tests(bool verbose) {
     printf("\n========================================");
@@ -512,6 +2460,26 @@ void run_all_tests(bool verbose) {
     test_log_arithmetic(verbose);
     test_precision(verbose);
     test_radix_conversion(verbose);
+    test_batch_conversion(verbose);
+    test_linkage(verbose);
+    test_fixed_format(verbose);
+    test_branch_free(verbose);
+    test_log_add(verbose);
+    test_slog(verbose);
+    test_log_saturation(verbose);
+    test_muldiv(verbose);
+    test_div(verbose);
+    test_root(verbose);
+    test_pow(verbose);
+    test_pow_lut(verbose);
+    test_lut8(verbose);
+    test_mt(verbose);
+    test_col(verbose);
+    test_rans(verbose);
+    test_ts(verbose);
+    test_packed(verbose);
+    test_bfp(verbose);
+    test_res(verbose);
 
     printf("\n========================================");
     printf("\nTest Summary:");
@@ -536,6 +2504,26 @@ int main(int argc, char *argv[]) {
 #define TEST_LOG        0x08
 #define TEST_PRECISION  0x10
 #define TEST_RADIX      0x20
+#define TEST_BATCH      0x40
+#define TEST_LINKAGE    0x80
+#define TEST_FIXED      0x100
+#define TEST_BRANCHFREE 0x200
+#define TEST_LOG_ADD    0x400
+#define TEST_SLOG       0x800
+#define TEST_LOG_SAT    0x1000
+#define TEST_MULDIV     0x2000
+#define TEST_DIV        0x4000
+#define TEST_ROOT       0x8000
+#define TEST_POW        0x10000
+#define TEST_POW_LUT    0x20000
+#define TEST_LUT8       0x40000
+#define TEST_MT         0x80000
+#define TEST_COL        0x100000
+#define TEST_RANS       0x200000
+#define TEST_TS         0x400000
+#define TEST_PACKED     0x800000
+#define TEST_BFP        0x1000000
+#define TEST_RES        0x2000000
 
     static struct option long_options[] = {
         {"verbose", no_argument, NULL, 'v'},
@@ -544,29 +2532,89 @@ int main(int argc, char *argv[]) {
     };
 
     int c;
-    while ((c = getopt_long(argc, argv, "bcehlprv", long_options, NULL)) != -1) {
+    while ((c = getopt_long(argc, argv, "BRabcdefghijklmnopqrstuwxyzv", long_options, NULL)) != -1) {
         switch (c) {
+            case 'a':
+                test_mask |= TEST_BATCH;
+                break;
             case 'b':
                 test_mask |= TEST_BASIC;
                 break;
             case 'c':
                 test_mask |= TEST_PUL;
                 break;
+            case 'd':
+                test_mask |= TEST_MULDIV;
+                break;
             case 'e':
                 test_mask |= TEST_EWMA;
                 break;
+            case 'f':
+                test_mask |= TEST_FIXED;
+                break;
+            case 'k':
+                test_mask |= TEST_LINKAGE;
+                break;
             case 'l':
                 test_mask |= TEST_LOG;
                 break;
+            case 'm':
+                test_mask |= TEST_LOG_SAT;
+                break;
+            case 'n':
+                test_mask |= TEST_BRANCHFREE;
+                break;
             case 'p':
                 test_mask |= TEST_PRECISION;
                 break;
             case 'r':
                 test_mask |= TEST_RADIX;
                 break;
+            case 's':
+                test_mask |= TEST_SLOG;
+                break;
+            case 'q':
+                test_mask |= TEST_DIV;
+                break;
+            case 't':
+                test_mask |= TEST_ROOT;
+                break;
+            case 'w':
+                test_mask |= TEST_POW;
+                break;
+            case 'i':
+                test_mask |= TEST_POW_LUT;
+                break;
+            case 'j':
+                test_mask |= TEST_LUT8;
+                break;
+            case 'x':
+                test_mask |= TEST_MT;
+                break;
+            case 'o':
+                test_mask |= TEST_COL;
+                break;
+            case 'u':
+                test_mask |= TEST_RANS;
+                break;
+            case 'y':
+                test_mask |= TEST_TS;
+                break;
+            case 'z':
+                test_mask |= TEST_PACKED;
+                break;
+            case 'B':
+                test_mask |= TEST_BFP;
+                break;
+            case 'R':
+                test_mask |= TEST_RES;
+                break;
             case 'v':
                 verbose = true;
                 break;
+            case 'g':
+                test_mask |= TEST_LOG_ADD;
+                break;
             case 'h':
                 print_usage(argv[0]);
                 return 0;
@@ -607,6 +2655,66 @@ int main(int argc, char *argv[]) {
         if (test_mask & TEST_RADIX) {
             test_radix_conversion(verbose);
         }
+        if (test_mask & TEST_BATCH) {
+            test_batch_conversion(verbose);
+        }
+        if (test_mask & TEST_LINKAGE) {
+            test_linkage(verbose);
+        }
+        if (test_mask & TEST_FIXED) {
+            test_fixed_format(verbose);
+        }
+        if (test_mask & TEST_BRANCHFREE) {
+            test_branch_free(verbose);
+        }
+        if (test_mask & TEST_LOG_ADD) {
+            test_log_add(verbose);
+        }
+        if (test_mask & TEST_SLOG) {
+            test_slog(verbose);
+        }
+        if (test_mask & TEST_LOG_SAT) {
+            test_log_saturation(verbose);
+        }
+        if (test_mask & TEST_MULDIV) {
+            test_muldiv(verbose);
+        }
+        if (test_mask & TEST_DIV) {
+            test_div(verbose);
+        }
+        if (test_mask & TEST_ROOT) {
+            test_root(verbose);
+        }
+        if (test_mask & TEST_POW) {
+            test_pow(verbose);
+        }
+        if (test_mask & TEST_POW_LUT) {
+            test_pow_lut(verbose);
+        }
+        if (test_mask & TEST_LUT8) {
+            test_lut8(verbose);
+        }
+        if (test_mask & TEST_MT) {
+            test_mt(verbose);
+        }
+        if (test_mask & TEST_COL) {
+            test_col(verbose);
+        }
+        if (test_mask & TEST_RANS) {
+            test_rans(verbose);
+        }
+        if (test_mask & TEST_TS) {
+            test_ts(verbose);
+        }
+        if (test_mask & TEST_PACKED) {
+            test_packed(verbose);
+        }
+        if (test_mask & TEST_BFP) {
+            test_bfp(verbose);
+        }
+        if (test_mask & TEST_RES) {
+            test_res(verbose);
+        }
         // Print summary for individual test runs
         print_final_summary();
     }
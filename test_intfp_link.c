@@ -0,0 +1,44 @@
+/**
+ * intfp Library Linkage Test Unit
+ *
+ * A second translation unit linked into test_intfp. Including intfp.h here as
+ * well checks that the header can be used from several units of one program.
+ * This unit also holds the shared lookup tables (INTFP_SHARED_TABLES) that
+ * test_intfp.c declares extern.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Type aliases used by intfp.h
+typedef uint8_t   u8;
+typedef uint16_t  u16;
+typedef uint32_t  u32;
+typedef uint64_t  u64;
+typedef int8_t    s8;
+typedef int16_t   s16;
+typedef int32_t   s32;
+typedef int64_t   s64;
+
+#define INTFP_SHARED_TABLES
+#define INTFP_IMPLEMENTATION
+#include "intfp.h"
+#include "intfp_rans.h"
+
+// Entry points called from test_intfp.c
+s32 link_u64_to_log32fpmax_corr(u64 v) {
+    return u64_to_log32fpmax_corr(v);
+}
+
+u64 link_log32fpmax_to_u64_corr(s32 v) {
+    return log32fpmax_to_u64_corr(v);
+}
+
+const u16 *link_enc_corr_lut(void) {
+    return __intfp_enc_corr_lut;
+}
+
+enum intfp_isa link_isa_get(void) {
+    return intfp_isa_get();
+}